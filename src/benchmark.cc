@@ -0,0 +1,477 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Microbenchmarks of the hot-path components of OpenMSC
+ *
+ * Every benchmark is run BENCHMARK_RUNS times with a fixed number of operations and the median is reported, so two runs
+ * on the same machine can be compared line by line when upgrading a component or a library. The benchmarks read
+ * openmsc.msc from the current directory and overwrite the dict-*.tsv files there, 'make bench' runs them in a temporary
+ * directory holding a copy of benchmark.msc, whose communication descriptions use every latency distribution MSC
+ * files support (constant, exponential and gaussian).
+ */
+#include <pthread.h>
+#include <algorithm>
+#include <log4cxx/basicconfigurator.h>
+#include <log4cxx/consoleappender.h>
+#include <log4cxx/simplelayout.h>
+#include "eventQueue.hh"
+#include "wireFormat.hh"
+
+#define BENCHMARK_RUNS 5			/** Runs per benchmark, the median is reported */
+#define BENCHMARK_PORT 52001		/** Loopback port used by the UDP/TCP send benchmarks */
+#define BENCHMARK_PRODUCERS 4		/** Threads adding to the eventQueue in the contention benchmark */
+
+using boost::asio::ip::udp;
+using boost::asio::ip::tcp;
+
+/**
+ * \typedef BENCHMARK_FUNCTION
+ * \brief A benchmark carrying out a number of operations and returning the time [s] it took
+ */
+typedef double (*BENCHMARK_FUNCTION)(unsigned long operations, void *context);
+
+log4cxx::LoggerPtr logger = log4cxx::Logger::getLogger("logger");
+int numOfUesPerBs = 100,
+	numOfBss = 10;
+ReadMsc readMsc;
+Dictionary dictionary;
+EventIdGenerator eventIdGenerator;
+base_generator_type generator(1);
+EventQueue *contendedQueue;	/** eventQueue shared by the producers of the contention benchmark */
+volatile unsigned long long sink;	/** Results of the benchmarks, keeps the compiler from removing the loops */
+
+/**
+ * Obtain a monotonic time stamp
+ * @return Seconds since an arbitrary point in time
+ */
+double now()
+{
+	timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Adding the information elements of doc/example/openmsc.cfg to a ReadMsc instance
+ * @param r The ReadMsc instance
+ */
+void addInformationElements(ReadMsc *r)
+{
+	INFORMATION_ELEMENT_DESCRIPTION_STRUCT sirError, errorCode;
+
+	sirError.ieValueDistDef.distribution = GAUSSIAN;
+	sirError.ieValueDistDef.gaussianMu = 80.0;
+	sirError.ieValueDistDef.gaussianSigma = 5.0;
+	r->AddInformationElementDescription(INFORMATION_ELEMENT_DESCRIPTION_PAIR ("SIRErrorValue", sirError));
+	errorCode.ieValueDistDef.distribution = CONSTANT;
+	errorCode.ieValueDistDef.constantLatency = TIME(1, "millisec");
+	r->AddInformationElementDescription(INFORMATION_ELEMENT_DESCRIPTION_PAIR ("ErrorCode", errorCode));
+}
+
+double benchReadMsc(unsigned long operations, void *context)
+{
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		ReadMsc r;
+		Dictionary d;
+
+		d.Init();
+		d.InitLog(logger);
+		r.InitLog(logger);
+		r.EstablishDictConnection(&d);
+		r.AddConfig(&numOfUesPerBs, &numOfBss);
+		addInformationElements(&r);
+		r.ReadMscConfigFile();
+	}
+
+	return now() - start;
+}
+
+double benchGetEventIdForComDescr(unsigned long operations, void *context)
+{
+	vector <pair <USE_CASE_ID, int> > *steps = (vector <pair <USE_CASE_ID, int> > *) context;
+	unsigned long length = 0;
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		pair <USE_CASE_ID, int> &step = steps->at(i % steps->size());
+		length += eventIdGenerator.GetEventIdForComDescr(step.first, step.second, i % numOfBss + 1,
+				i % numOfUesPerBs + 1).size();
+	}
+
+	sink = length;
+	return now() - start;
+}
+
+double benchCalculateLatency(unsigned long operations, void *context)
+{
+	vector <pair <USE_CASE_ID, int> > *steps = (vector <pair <USE_CASE_ID, int> > *) context;
+	unsigned long long sum = 0;
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		pair <USE_CASE_ID, int> &step = steps->at(i % steps->size());
+		sum += eventIdGenerator.CalculateLatency(step.first, step.second, &generator).nanosec();
+	}
+
+	sink = sum;
+	return now() - start;
+}
+
+double benchCalculateUeActivity(unsigned long operations, void *context)
+{
+	DISTRIBUTION_DEFINITION_STRUCT *distDef = (DISTRIBUTION_DEFINITION_STRUCT *) context;
+	unsigned long long sum = 0;
+	bool valid;
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+		sum += eventIdGenerator.CalculateUeActivity(distDef, &generator, &valid).nanosec();
+
+	sink = sum;
+	return now() - start;
+}
+
+double benchDetermineUseCaseId(unsigned long operations, void *context)
+{
+	unsigned long sum = 0;
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+		sum += eventIdGenerator.DetermineUseCaseId(&generator);
+
+	sink = sum;
+	return now() - start;
+}
+
+double benchTimeConversion(unsigned long operations, void *context)
+{
+	unsigned long long sum = 0;
+	double start = now();
+
+	// The conversions the generator and the sender carry out per EventID
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		TIME t = TIME(1700000000.0 + i * 1e-6, "sec");
+		TIME u = TIME(t.nanosec() + 1000, "nanosec");
+		sum += u.nanosec() + (unsigned long long) u.sec() + (unsigned long long) t.millisec();
+	}
+
+	sink = sum;
+	return now() - start;
+}
+
+double benchUePopulation(unsigned long operations, void *context)
+{
+	UePopulation population;
+	UE_INDEX ueIndex;
+	unsigned long long base = 1000000000000ULL;
+	double start;
+	bool arrival;
+
+	population.InitLog(logger);
+	population.Init(numOfBss, numOfUesPerBs, 1, TIME(1, "millisec"), 65536, TIME(base, "nanosec"));
+	start = now();
+	// Every UE is popped and its next activation is queued 10ms later, i.e. one operation = PopDue() + ScheduleArrival()
+	for (unsigned long i = 0; i < operations; )
+	{
+		unsigned long long horizon = base + (i / population.GetNumOfUes() + 1) * 10000000ULL;
+
+		if (i < population.GetNumOfUes())
+		{
+			population.GetUeState(i)->nextArrival = base + i * 10000ULL;
+			population.ScheduleArrival(i);
+			i++;
+			continue;
+		}
+		if (!population.PopDue(TIME(horizon, "nanosec"), &ueIndex, &arrival))
+			break;
+		population.GetUeState(ueIndex)->nextArrival += 10000000ULL;
+		population.ScheduleArrival(ueIndex);
+		i++;
+	}
+
+	return now() - start;
+}
+
+double benchEventQueue(unsigned long operations, void *context)
+{
+	EventQueue queue;
+	EVENT_STRUCT event;
+	TIME_EVENT_PAIR popped;
+	TIME due = TIME(1.0, "sec");
+	double start;
+
+	queue.InitLog(logger);
+	queue.Init(TIME(1000, "sec"), 0, LATE_SEND, TIME(1000, "sec"));
+	event.eventId = "0000100002010101080";
+	event.useCaseId = 1;
+	event.step = 0;
+	event.noiseSource = -1;
+	event.bsId = 1;
+	event.ueId = 1;
+	event.procedure = 1;
+	start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		queue.Add(TIME(1000000000ULL + i * 1000ULL, "nanosec"), event);
+		queue.PopDue(due, &popped);
+	}
+
+	return now() - start;
+}
+
+void *produceEvents(void *t)
+{
+	unsigned long operations = (unsigned long) t;
+	EVENT_STRUCT event;
+
+	event.eventId = "0000100002010101080";
+	event.useCaseId = 1;
+	event.step = 0;
+	event.noiseSource = -1;
+	event.bsId = 1;
+	event.ueId = 1;
+	event.procedure = 1;
+
+	for (unsigned long i = 0; i < operations; i++)
+		contendedQueue->Add(TIME(1000000000ULL + i * 1000ULL, "nanosec"), event);
+
+	pthread_exit(NULL);
+}
+
+double benchEventQueueContended(unsigned long operations, void *context)
+{
+	EventQueue queue;
+	TIME_EVENT_PAIR popped;
+	TIME due = TIME(2.0, "sec");
+	pthread_t threads[BENCHMARK_PRODUCERS];
+	unsigned long perProducer = operations / BENCHMARK_PRODUCERS, consumed = 0;
+	double start;
+
+	queue.InitLog(logger);
+	queue.Init(TIME(1000, "sec"), 100000, LATE_SEND, TIME(1000, "sec"));
+	contendedQueue = &queue;
+	start = now();
+
+	for (int p = 0; p < BENCHMARK_PRODUCERS; p++)
+		pthread_create(&threads[p], NULL, produceEvents, (void *) perProducer);
+	// The sender side: a single consumer popping everything which is due
+	while (consumed < perProducer * BENCHMARK_PRODUCERS)
+	{
+		if (queue.PopDue(due, &popped))
+			consumed++;
+		else
+			sched_yield();
+	}
+	for (int p = 0; p < BENCHMARK_PRODUCERS; p++)
+		pthread_join(threads[p], NULL);
+
+	return now() - start;
+}
+
+double benchEncodeWireHeader(unsigned long operations, void *context)
+{
+	char frame[WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH];
+	unsigned long sum = 0;
+	double start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+	{
+		EncodeWireHeader(frame, 19, i, 1000000000ULL + i, 1000000100ULL + i);
+		sum += frame[15];
+	}
+
+	sink = sum;
+	return now() - start;
+}
+
+double benchSendUdp(unsigned long operations, void *context)
+{
+	boost::asio::io_service io_service;
+	udp::socket receiver(io_service, udp::endpoint(boost::asio::ip::address_v4::loopback(), BENCHMARK_PORT));
+	udp::socket sender(io_service, udp::endpoint(udp::v4(), 0));
+	udp::endpoint destination(boost::asio::ip::address_v4::loopback(), BENCHMARK_PORT);
+	string payload = "0000100002010101080";
+	double start = now();
+
+	// Nobody reads the datagrams, the kernel drops them once the receive buffer is full
+	for (unsigned long i = 0; i < operations; i++)
+		sender.send_to(boost::asio::buffer(payload), destination);
+
+	return now() - start;
+}
+
+void *drainTcp(void *t)
+{
+	tcp::socket *socket = (tcp::socket *) t;
+	char buffer[65536];
+	boost::system::error_code error;
+
+	while (!error)
+		socket->read_some(boost::asio::buffer(buffer), error);
+
+	pthread_exit(NULL);
+}
+
+double benchSendTcp(unsigned long operations, void *context)
+{
+	boost::asio::io_service io_service;
+	tcp::acceptor acceptor(io_service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), BENCHMARK_PORT));
+	tcp::socket sender(io_service), receiver(io_service);
+	string payload = "0000100002010101080";
+	pthread_t thread;
+	double start, elapsed;
+
+	acceptor.set_option(tcp::acceptor::reuse_address(true));
+	sender.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), BENCHMARK_PORT));
+	acceptor.accept(receiver);
+	pthread_create(&thread, NULL, drainTcp, (void *) &receiver);
+	start = now();
+
+	for (unsigned long i = 0; i < operations; i++)
+		boost::asio::write(sender, boost::asio::buffer(payload));
+
+	elapsed = now() - start;
+	sender.close();
+	pthread_join(thread, NULL);
+	return elapsed;
+}
+
+/**
+ * Running a benchmark BENCHMARK_RUNS times and printing the median
+ * @param name The name printed in the first column
+ * @param function The benchmark
+ * @param operations Operations per run
+ * @param context Passed on to the benchmark
+ */
+void run(string name, BENCHMARK_FUNCTION function, unsigned long operations, void *context)
+{
+	vector <double> runs;
+
+	for (int r = 0; r < BENCHMARK_RUNS; r++)
+		runs.push_back(function(operations, context));
+
+	sort(runs.begin(), runs.end());
+	double median = runs[BENCHMARK_RUNS / 2];
+	cout << left << setw(52) << name << right << fixed
+			<< setw(12) << setprecision(1) << median / operations * 1e9 << " ns/op"
+			<< setw(14) << setprecision(0) << (median > 0 ? operations / median : 0) << " ops/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	map <DISTRIBUTION, vector <pair <USE_CASE_ID, int> > > stepsByDistribution;
+	vector <pair <USE_CASE_ID, int> > steps;
+	DISTRIBUTION_DEFINITION_STRUCT distDefs[7];
+	const char *distNames[7] = {"constant", "uniform_real", "uniform_int", "exponential", "gaussian", "gamma", "erlang"};
+
+	log4cxx::BasicConfigurator::configure(log4cxx::AppenderPtr(new log4cxx::ConsoleAppender(
+			log4cxx::LayoutPtr(new log4cxx::SimpleLayout()))));
+	log4cxx::Logger::getRootLogger()->setLevel(log4cxx::Level::getError());
+	hotLog.Init(HOT_LOG_RING_SIZE, logger);
+
+	dictionary.Init();
+	dictionary.InitLog(logger);
+	readMsc.InitLog(logger);
+	readMsc.EstablishDictConnection(&dictionary);
+	readMsc.AddConfig(&numOfUesPerBs, &numOfBss);
+	addInformationElements(&readMsc);
+
+	if (readMsc.ReadMscConfigFile() != 0)
+	{
+		cerr << "Run the benchmarks in a directory holding an openmsc.msc (make bench)" << endl;
+		return(EXIT_FAILURE);
+	}
+	eventIdGenerator.Init(&readMsc);
+	eventIdGenerator.InitLog(logger);
+
+	for (int ucId = 1; ucId <= readMsc.GetNumOfUseCases(); ucId++)
+	{
+		for (int step = 0; step < readMsc.GetMscLength(ucId); step++)
+		{
+			steps.push_back(pair <USE_CASE_ID, int> (ucId, step));
+			stepsByDistribution[readMsc.GetParticularCommunicationDescription(ucId, step).latencyDescription.distribution]
+					.push_back(pair <USE_CASE_ID, int> (ucId, step));
+		}
+	}
+
+	for (int d = 0; d < 7; d++)
+	{
+		distDefs[d].constantLatency = TIME(1, "sec");
+		distDefs[d].uniformMin = TIME(1, "sec");
+		distDefs[d].uniformMax = TIME(5, "sec");
+		distDefs[d].exponentialLambda = 0.05;
+		distDefs[d].gaussianMu = 1.0;
+		distDefs[d].gaussianSigma = 0.5;
+		distDefs[d].gammaAlpha = 0.75;
+		distDefs[d].gammaBeta = 2.0;
+		distDefs[d].erlangAlpha = 2;
+		distDefs[d].erlangBeta = 2;
+	}
+	distDefs[0].distribution = CONSTANT;
+	distDefs[1].distribution = UNIFORM_REAL;
+	distDefs[2].distribution = UNIFORM_INTEGER;
+	distDefs[3].distribution = EXPONENTIAL;
+	distDefs[4].distribution = GAUSSIAN;
+	distDefs[5].distribution = GAMMA;
+	distDefs[6].distribution = ERLANG;
+
+	cout << "OpenMSC microbenchmarks (median of " << BENCHMARK_RUNS << " runs, " << readMsc.GetNumOfUseCases()
+			<< " use-cases / " << steps.size() << " communication descriptors)" << endl;
+	run("ReadMsc::ReadMscConfigFile", benchReadMsc, 200, NULL);
+	run("EventIdGenerator::GetEventIdForComDescr", benchGetEventIdForComDescr, 200000, &steps);
+
+	for (int d = 0; d < 7; d++)
+	{
+		map <DISTRIBUTION, vector <pair <USE_CASE_ID, int> > >::iterator it = stepsByDistribution.find(distDefs[d].distribution);
+
+		if (it == stepsByDistribution.end())
+		{
+			cout << left << setw(52) << string("EventIdGenerator::CalculateLatency ") + distNames[d]
+					<< "not used in openmsc.msc, skipped" << endl;
+			continue;
+		}
+		run(string("EventIdGenerator::CalculateLatency ") + distNames[d], benchCalculateLatency, 1000000, &it->second);
+	}
+	for (int d = 0; d < 7; d++)
+		run(string("EventIdGenerator::CalculateUeActivity ") + distNames[d], benchCalculateUeActivity, 1000000, &distDefs[d]);
+
+	run("EventIdGenerator::DetermineUseCaseId", benchDetermineUseCaseId, 1000000, NULL);
+	run("TIME conversions", benchTimeConversion, 1000000, NULL);
+	run("UePopulation::PopDue + Schedule", benchUePopulation, 1000000, NULL);
+	run("EventQueue::Add + PopDue", benchEventQueue, 1000000, NULL);
+	run("EventQueue contended (4 producers, 1 consumer)", benchEventQueueContended, 1000000, NULL);
+	run("EncodeWireHeader", benchEncodeWireHeader, 10000000, NULL);
+	run("UDP send on loopback", benchSendUdp, 200000, NULL);
+	run("TCP send on loopback", benchSendTcp, 200000, NULL);
+
+	return 0;
+}
@@ -0,0 +1,320 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "controlSocket.hh"
+#include <cstdio>
+#include <sstream>
+
+bool ControlSocket::Init(string path, CONTROL_STATE_STRUCT state, unsigned int numOfNoiseSources, EventCounters *counters,
+		EventRouter *router)
+{
+	state_ = state;
+	targetRate_ = 0;
+	acceptor = NULL;
+	configuredBss = state.numOfBss;
+	configuredUesPerBs = state.numOfUesPerBs;
+	version_ = 0;
+	applied_ = 0;
+	numOfNoiseSources_ = numOfNoiseSources;
+	noiseEnabled = new boost::atomic<bool>[numOfNoiseSources];
+	counters_ = counters;
+	router_ = router;
+	path_ = path;
+
+	for (unsigned int n = 0; n < numOfNoiseSources; n++)
+		noiseEnabled[n] = true;
+
+	if (path.empty())
+		return true;
+
+	// A socket file left behind by a previous instance would make bind() fail
+	remove(path.c_str());
+
+	try
+	{
+		acceptor = new boost::asio::local::stream_protocol::acceptor(ioService,
+				boost::asio::local::stream_protocol::endpoint(path));
+	}
+	catch (boost::system::system_error &e)
+	{
+		LOG4CXX_ERROR(logger, "Control socket " << path << " could not be bound: " << e.what());
+		return false;
+	}
+
+	LOG4CXX_INFO(logger, "Accepting commands on control socket " << path);
+	return true;
+}
+
+void ControlSocket::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+void ControlSocket::EnableTargetRate(double targetRate)
+{
+	boost::mutex::scoped_lock lock(stateMutex);
+	targetRate_ = targetRate;
+}
+
+double ControlSocket::GetTargetRate()
+{
+	boost::mutex::scoped_lock lock(stateMutex);
+	return targetRate_;
+}
+
+void ControlSocket::SetActivityScale(double activityScale)
+{
+	boost::mutex::scoped_lock lock(stateMutex);
+	state_.activityScale = activityScale;
+	version_++;
+}
+
+void ControlSocket::Serve()
+{
+	if (acceptor == NULL)
+		return;
+
+	for (;;)
+	{
+		boost::asio::local::stream_protocol::socket client(ioService);
+		boost::system::error_code error;
+
+		acceptor->accept(client, error);
+
+		if (error)
+		{
+			LOG4CXX_ERROR(logger, "Accepting a client on control socket " << path_ << " failed: " << error.message());
+			return;
+		}
+
+		boost::asio::streambuf input;
+
+		// One command per line until the client closes the connection
+		while (boost::asio::read_until(client, input, '\n', error) > 0 && !error)
+		{
+			istream stream(&input);
+			string command, reply;
+
+			getline(stream, command);
+
+			if (!command.empty() && command[command.size() - 1] == '\r')
+				command.erase(command.size() - 1);
+
+			if (command.empty())
+				continue;
+
+			reply = Execute(command);
+			boost::asio::write(client, boost::asio::buffer(reply), error);
+
+			if (error)
+				break;
+		}
+	}
+}
+
+string ControlSocket::Execute(string command)
+{
+	istringstream arguments(command);
+	ostringstream reply;
+	string keyword;
+	CONTROL_STATE_STRUCT state;
+	double targetRate;
+
+	arguments >> keyword;
+	{
+		boost::mutex::scoped_lock lock(stateMutex);
+		state = state_;
+		targetRate = targetRate_;
+	}
+
+	if (keyword == "activity")
+	{
+		double factor;
+
+		if (targetRate > 0)
+			return "ERROR activity follows the target rate, use rate <EVENTIDS/S>\n";
+
+		if (!(arguments >> factor) || factor <= 0)
+			return "ERROR activity requires a factor larger than 0\n";
+
+		state.activityScale = factor;
+		SetState(state);
+		LOG4CXX_INFO(logger, "Control socket: UE activity set to " << factor << " x openmsc.cfg");
+	}
+	else if (keyword == "rate")
+	{
+		double rate;
+
+		if (targetRate == 0)
+			return "ERROR rate requires the target-rate mode (--target-rate)\n";
+
+		if (!(arguments >> rate) || rate <= 0)
+			return "ERROR rate requires an EventID rate larger than 0\n";
+
+		EnableTargetRate(rate);
+		LOG4CXX_INFO(logger, "Control socket: target rate set to " << rate << " EventIDs/s");
+	}
+	else if (keyword == "bss")
+	{
+		int n;
+
+		// The EventIDs of further BSs would be missing from the dictionary and patterns.csv
+		if (!(arguments >> n) || n <= 0 || n > configuredBss)
+		{
+			reply << "ERROR bss requires a number of BSs between 1 and " << configuredBss << " (numOfBss in openmsc.cfg)\n";
+			return reply.str();
+		}
+
+		state.numOfBss = n;
+		SetState(state);
+		LOG4CXX_INFO(logger, "Control socket: number of BSs set to " << n);
+	}
+	else if (keyword == "ues")
+	{
+		int n;
+
+		if (!(arguments >> n) || n <= 0 || n > configuredUesPerBs)
+		{
+			reply << "ERROR ues requires a number of UEs per BS between 1 and " << configuredUesPerBs
+					<< " (numOfUesPerBs in openmsc.cfg)\n";
+			return reply.str();
+		}
+
+		state.numOfUesPerBs = n;
+		SetState(state);
+		LOG4CXX_INFO(logger, "Control socket: number of UEs per BS set to " << n);
+	}
+	else if (keyword == "noise")
+	{
+		string source, onOff;
+		bool found = false;
+
+		if (!(arguments >> source >> onOff) || (onOff != "on" && onOff != "off"))
+			return "ERROR noise requires a source (uncorrelated, correlated<i> or all) and on or off\n";
+
+		for (unsigned int n = 0; n < numOfNoiseSources_; n++)
+		{
+			if (source == "all" || source == GetNoiseSourceName(n))
+			{
+				noiseEnabled[n] = (onOff == "on");
+				found = true;
+			}
+		}
+
+		if (!found)
+			return "ERROR unknown noise source " + source + "\n";
+
+		LOG4CXX_INFO(logger, "Control socket: noise source " << source << " switched " << onOff);
+	}
+	else if (keyword == "status")
+	{
+		reply << "activity=" << state.activityScale << "\n"
+				<< "bss=" << state.numOfBss << "\n"
+				<< "uesPerBs=" << state.numOfUesPerBs << "\n"
+				<< "applied=" << (applied_ == version_ ? "yes" : "no") << "\n";
+
+		if (targetRate > 0)
+			reply << "targetRate=" << targetRate << "\n";
+
+		for (unsigned int n = 0; n < numOfNoiseSources_; n++)
+			reply << "noise." << GetNoiseSourceName(n) << "=" << (noiseEnabled[n] ? "on" : "off") << "\n";
+	}
+	else if (keyword == "counters")
+	{
+		COUNTER_VECTOR counters;
+		EVENT_QUEUE_STATISTICS_STRUCT queueStatistics;
+		unsigned long long total = 0;
+
+		counters_->GetSnapshot(&counters);
+		router_->GetStatistics(&queueStatistics, false, STATISTICS_RATE_LOG);
+
+		for (size_t i = 0; i < counters.size(); i++)
+			total += counters[i];
+
+		reply << "eventIds=" << total << "\n";
+
+		// The EventIDs of communication descriptor 0 count the use-cases started
+		for (USE_CASE_ID useCaseId = 1; useCaseId <= counters_->GetNumOfUseCases(); useCaseId++)
+		{
+			unsigned int offset = counters_->GetUseCaseOffset(useCaseId);
+			reply << "useCase." << useCaseId << ".started="
+					<< (offset < counters_->GetUseCaseOffset(useCaseId + 1) ? counters[offset] : 0) << "\n";
+		}
+
+		for (unsigned int n = 0; n < counters_->GetNumOfNoiseSources(); n++)
+			reply << "noise." << GetNoiseSourceName(n) << "=" << counters[counters_->GetNoiseSourceOffset() + n] << "\n";
+
+		reply << "queued=" << queueStatistics.entries << "\n"
+				<< "lateEventIds=" << queueStatistics.lateEvents << "\n"
+				<< "droppedEventIds=" << queueStatistics.droppedEvents << "\n"
+				<< "latenessMeanMs=" << queueStatistics.meanLateness.millisec() << "\n"
+				<< "latenessMaxMs=" << queueStatistics.maxLateness.millisec() << "\n";
+	}
+	else if (keyword == "help")
+	{
+		reply << "activity <FACTOR>\nrate <EVENTIDS/S>\nbss <NUMBER>\nues <NUMBER>\nnoise <SOURCE|all> <on|off>\nstatus\ncounters\n";
+	}
+	else
+		return "ERROR unknown command " + keyword + " (try help)\n";
+
+	reply << "OK\n";
+	return reply.str();
+}
+
+bool ControlSocket::GetState(unsigned int *version, CONTROL_STATE_STRUCT *state)
+{
+	if (version_.load(boost::memory_order_acquire) == *version)
+		return false;
+
+	boost::mutex::scoped_lock lock(stateMutex);
+	*state = state_;
+	*version = version_;
+	return true;
+}
+
+void ControlSocket::SetApplied(unsigned int version)
+{
+	applied_.store(version, boost::memory_order_release);
+}
+
+bool ControlSocket::IsNoiseEnabled(unsigned int noiseSource)
+{
+	return noiseSource >= numOfNoiseSources_ || noiseEnabled[noiseSource].load(boost::memory_order_relaxed);
+}
+
+void ControlSocket::SetState(CONTROL_STATE_STRUCT state)
+{
+	boost::mutex::scoped_lock lock(stateMutex);
+	state_ = state;
+	version_++;
+}
+
+string ControlSocket::GetNoiseSourceName(unsigned int noiseSource)
+{
+	ostringstream name;
+
+	if (noiseSource == 0)
+		return "uncorrelated";
+
+	name << "correlated" << noiseSource - 1;
+	return name.str();
+}
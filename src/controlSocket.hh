@@ -0,0 +1,136 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include "metricsPublisher.hh"
+
+/**
+ * \class ControlSocket
+ * This class accepts commands on a local Unix domain stream socket to change the UE activity, the population and the
+ * noise sources of a running OpenMSC instance, and to query its counters.
+ *
+ * Every command is a single line, every reply ends with a line 'OK' or 'ERROR <REASON>', optionally preceded by
+ * 'key=value' lines. Population and activity changes are stored as a whole under a version number; the EventID generator
+ * takes them over between two rounds of UE activations, so the sender and the in-flight use-cases are not interrupted.
+ * The noise sources read their flag on every batch.
+ *
+ *	activity <FACTOR>				UE activity relative to openmsc.cfg
+ *	rate <EVENTIDS/S>				Target EventID rate (target-rate mode only, the activity follows the rate)
+ *	bss <NUMBER>					Number of BSs whose UEs start use-cases (at most numOfBss of openmsc.cfg)
+ *	ues <NUMBER>					Number of UEs per BS which start use-cases (at most numOfUesPerBs of openmsc.cfg)
+ *	noise <SOURCE|all> <on|off>		Enable or disable a noise source (uncorrelated, correlated0, correlated1, ...)
+ *	status							Current settings and whether the generator has taken them over
+ *	counters						EventIDs sent per use-case and noise source, eventQueue fill level and lateness
+ */
+class ControlSocket {
+public:
+	/**
+	 * Initialising the control socket and binding it to its path. An existing socket file is replaced.
+	 * @param path Path of the Unix domain socket, empty if the state is only changed from within OpenMSC
+	 * @param state The population and activity of openmsc.cfg
+	 * @param numOfNoiseSources Number of noise sources (uncorrelated + correlated)
+	 * @param counters Pointer to the EventID counters of the sender
+	 * @param router Pointer to the eventRouter holding the event queues of all destinations
+	 * @return false if the socket could not be bound
+	 */
+	bool Init(string path, CONTROL_STATE_STRUCT state, unsigned int numOfNoiseSources, EventCounters *counters,
+			EventRouter *router);
+	/**
+	 * Initialising logging in ControlSocket class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Handing the UE activity over to the target-rate controller
+	 * @param targetRate The initial target EventID rate [1/s]
+	 */
+	void EnableTargetRate(double targetRate);
+	/**
+	 * Obtain the target EventID rate
+	 * @return The target rate [1/s], 0 if the target-rate mode is disabled
+	 */
+	double GetTargetRate();
+	/**
+	 * Setting the UE activity, e.g. by the target-rate controller
+	 * @param activityScale UE activity relative to openmsc.cfg
+	 */
+	void SetActivityScale(double activityScale);
+	/**
+	 * Accepting clients and executing their commands, one client at a time. Returns only if accepting fails or no
+	 * socket has been bound.
+	 */
+	void Serve();
+	/**
+	 * Executing a single command
+	 * @param command The command line without line break
+	 * @return The reply including the final 'OK' or 'ERROR' line
+	 */
+	string Execute(string command);
+	/**
+	 * Obtain the requested population and activity if it has changed
+	 * @param version Pointer to the version the caller has taken over last, updated if a newer state is returned
+	 * @param state Pointer to which the requested state is written
+	 * @return true if the state has changed since the given version
+	 */
+	bool GetState(unsigned int *version, CONTROL_STATE_STRUCT *state);
+	/**
+	 * Confirming that the EventID generator has taken over a state
+	 * @param version The version obtained from GetState()
+	 */
+	void SetApplied(unsigned int version);
+	/**
+	 * Check whether a noise source is enabled
+	 * @param noiseSource The noise source (0 = uncorrelated, i + 1 = correlated source i)
+	 * @return true if the noise source should emit EventIDs
+	 */
+	bool IsNoiseEnabled(unsigned int noiseSource);
+private:
+	/**
+	 * Storing a new requested state under the next version
+	 * @param state The state
+	 */
+	void SetState(CONTROL_STATE_STRUCT state);
+	/**
+	 * Obtain the name of a noise source as used in the commands
+	 * @param noiseSource The noise source
+	 * @return uncorrelated or correlated<i>
+	 */
+	string GetNoiseSourceName(unsigned int noiseSource);
+	CONTROL_STATE_STRUCT state_;				/** The requested state */
+	double targetRate_;							/** Target EventID rate [1/s], 0 without target-rate mode */
+	int configuredBss;							/** numOfBss of openmsc.cfg, the BSs in the dictionary and patterns.csv */
+	int configuredUesPerBs;						/** numOfUesPerBs of openmsc.cfg, the stride of the UE identifiers */
+	boost::mutex stateMutex;					/** Protecting state_ and targetRate_ */
+	boost::atomic<unsigned int> version_;		/** Version of state_, incremented on every change */
+	boost::atomic<unsigned int> applied_;		/** Version taken over by the EventID generator */
+	boost::atomic<bool> *noiseEnabled;			/** Flag per noise source */
+	unsigned int numOfNoiseSources_;			/** Number of noise sources */
+	EventCounters *counters_;					/** EventID counters of the sender */
+	EventRouter *router_;						/** The event queues of all destinations */
+	string path_;								/** Path of the Unix domain socket */
+	boost::asio::io_service ioService;			/** io_service of the Unix domain socket */
+	boost::asio::local::stream_protocol::acceptor *acceptor;	/** Listening socket */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
@@ -7,3 +7,49 @@ enum latencyDistributionEnum {
 	ERLANG,
 	GAUSSIAN
 };
+enum noiseProcessEnum {
+	MMPP = 1,
+	HAWKES
+};
+enum lateEventPolicyEnum {
+	LATE_SEND = 1,
+	LATE_DROP,
+	LATE_DROP_COUNT
+};
+enum metricsFormatEnum {
+	METRICS_PROMETHEUS = 1,
+	METRICS_LINE
+};
+enum partitionEnum {
+	PARTITION_BS = 1,
+	PARTITION_UE,
+	PARTITION_USE_CASE,
+	PARTITION_ROUND_ROBIN
+};
+enum procedureOverflowEnum {
+	OVERFLOW_QUEUE = 1,
+	OVERFLOW_DROP
+};
+enum hotLogLevelEnum {
+	HOT_LOG_LEVEL_DEBUG = 1,
+	HOT_LOG_LEVEL_TRACE
+};
+enum hotLogArgEnum {
+	HOT_LOG_SIGNED = 1,
+	HOT_LOG_UNSIGNED,
+	HOT_LOG_DOUBLE,
+	HOT_LOG_STRING
+};
+enum rampModeEnum {
+	RAMP_STEP = 1,
+	RAMP_LINEAR
+};
+enum generationTimeEnum {
+	GENERATION_VIRTUAL_TIME = 1,
+	GENERATION_REAL_TIME
+};
+enum statisticsReaderEnum {
+	STATISTICS_RATE_LOG = 0,
+	STATISTICS_LOAD_RAMP,
+	STATISTICS_READERS
+};
@@ -0,0 +1,132 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "eventCounters.hh"
+#include <new>
+#include <stdlib.h>
+
+void EventCounters::Init(ReadMsc *readMsc, unsigned int numOfNoiseSources, unsigned int maxThreads)
+{
+	USE_CASE_ID numOfUseCases = readMsc->GetNumOfUseCases();
+	const unsigned int countersPerCacheLine = CACHE_LINE_SIZE / sizeof(boost::atomic<unsigned long long>);
+	void *memory;
+
+	// Use-case IDs start at 1, offset 0 is an empty dummy use-case
+	useCaseOffset.assign(numOfUseCases + 2, 0);
+
+	for (USE_CASE_ID useCaseId = 1; useCaseId <= numOfUseCases; useCaseId++)
+		useCaseOffset[useCaseId + 1] = useCaseOffset[useCaseId] + readMsc->GetMscLength(useCaseId);
+
+	numOfNoiseSources_ = numOfNoiseSources;
+	numOfCounters = useCaseOffset.back() + numOfNoiseSources;
+	// Each block starts on its own cache line
+	blockSize = ((numOfCounters + countersPerCacheLine - 1) / countersPerCacheLine) * countersPerCacheLine;
+	blockSize = blockSize > 0 ? blockSize : countersPerCacheLine;
+	maxThreads_ = maxThreads > 0 ? maxThreads : 1;
+
+	if (posix_memalign(&memory, CACHE_LINE_SIZE, (size_t)blockSize * maxThreads_ * sizeof(boost::atomic<unsigned long long>)) != 0)
+	{
+		LOG4CXX_ERROR(logger, "Memory for the EventID counters could not be allocated");
+		exit(EXIT_FAILURE);
+	}
+
+	counters = static_cast<boost::atomic<unsigned long long> *>(memory);
+
+	for (unsigned int i = 0; i < blockSize * maxThreads_; i++)
+		new (&counters[i]) boost::atomic<unsigned long long>(0);
+
+	registeredThreads.store(0);
+	LOG4CXX_DEBUG(logger, numOfCounters << " EventID counters allocated for " << numOfUseCases << " use-cases and "
+			<< numOfNoiseSources << " noise sources in " << maxThreads_ << " blocks of " << blockSize << " counters");
+}
+
+void EventCounters::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+unsigned int EventCounters::RegisterThread()
+{
+	unsigned int thread = registeredThreads.fetch_add(1);
+
+	if (thread >= maxThreads_)
+	{
+		LOG4CXX_ERROR(logger, "More than " << maxThreads_ << " threads registered for counting EventIDs. Sharing the last counter block");
+		thread = maxThreads_ - 1;
+	}
+
+	return thread;
+}
+
+void EventCounters::Count(unsigned int thread, const EVENT_STRUCT &event)
+{
+	unsigned int i;
+
+	if (event.noiseSource >= 0)
+		i = useCaseOffset.back() + event.noiseSource;
+	else if (event.useCaseId + 1u < useCaseOffset.size())
+		i = useCaseOffset[event.useCaseId] + event.step;
+	else
+		return;
+
+	if (i < numOfCounters)
+	{
+		boost::atomic<unsigned long long> &counter = counters[(size_t)thread * blockSize + i];
+		counter.store(counter.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+	}
+}
+
+void EventCounters::GetSnapshot(COUNTER_VECTOR *snapshot)
+{
+	unsigned int threads = registeredThreads.load();
+
+	if (threads > maxThreads_)
+		threads = maxThreads_;
+
+	snapshot->assign(numOfCounters, 0);
+
+	for (unsigned int thread = 0; thread < threads; thread++)
+	{
+		for (unsigned int i = 0; i < numOfCounters; i++)
+			snapshot->at(i) += counters[(size_t)thread * blockSize + i].load(boost::memory_order_relaxed);
+	}
+}
+
+unsigned int EventCounters::GetUseCaseOffset(USE_CASE_ID useCaseId)
+{
+	return useCaseOffset.at(useCaseId);
+}
+
+unsigned int EventCounters::GetNoiseSourceOffset()
+{
+	return useCaseOffset.back();
+}
+
+USE_CASE_ID EventCounters::GetNumOfUseCases()
+{
+	return useCaseOffset.size() - 2;
+}
+
+unsigned int EventCounters::GetNumOfNoiseSources()
+{
+	return numOfNoiseSources_;
+}
@@ -0,0 +1,96 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/atomic.hpp>
+#include "eventRouter.hh"
+
+/**
+ * \class EventCounters
+ * This class counts the EventIDs sent per communication descriptor of every use-case and per noise source.
+ *
+ * The counters are kept in a flat array: the communication descriptors of use-case 1, 2, ... followed by the noise
+ * sources (0 = uncorrelated, i + 1 = correlated source i). Every counting thread registers its own copy of the array,
+ * aligned and padded to whole cache lines, so threads never share a cache line and counting is a plain relaxed load and
+ * store without any lock or atomic read-modify-write. The copies are only summed up when a snapshot is requested.
+ */
+class EventCounters {
+public:
+	/**
+	 * Allocating the counters for all use-cases read from openmsc.msc and all noise sources
+	 * @param readMsc Pointer to the ReadMsc class holding the use-cases
+	 * @param numOfNoiseSources Number of noise sources (uncorrelated + correlated)
+	 * @param maxThreads Maximal number of threads which can register for counting
+	 */
+	void Init(ReadMsc *readMsc, unsigned int numOfNoiseSources, unsigned int maxThreads);
+	/**
+	 * Initialising logging in EventCounters class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Registering a counting thread
+	 * @return The number of the counter block of this thread, used for Count()
+	 */
+	unsigned int RegisterThread();
+	/**
+	 * Counting a sent EventID in the counter block of the calling thread
+	 * @param thread The counter block obtained from RegisterThread()
+	 * @param event The EventID which has been sent
+	 */
+	void Count(unsigned int thread, const EVENT_STRUCT &event);
+	/**
+	 * Reading all counters summed up over all threads
+	 * @param counters Pointer to the vector the counters are written to
+	 */
+	void GetSnapshot(COUNTER_VECTOR *counters);
+	/**
+	 * Obtain the position of the first communication descriptor of a use-case in the counter array
+	 * @param useCaseId The use-case
+	 * @return The index of the counter of communication descriptor 0
+	 */
+	unsigned int GetUseCaseOffset(USE_CASE_ID useCaseId);
+	/**
+	 * Obtain the position of the first noise source in the counter array
+	 * @return The index of the counter of noise source 0
+	 */
+	unsigned int GetNoiseSourceOffset();
+	/**
+	 * Obtain the number of use-cases
+	 * @return The number of use-cases read from openmsc.msc
+	 */
+	USE_CASE_ID GetNumOfUseCases();
+	/**
+	 * Obtain the number of noise sources
+	 * @return The number of noise sources
+	 */
+	unsigned int GetNumOfNoiseSources();
+private:
+	boost::atomic<unsigned long long> *counters;	/** The counter blocks of all threads */
+	unsigned int numOfCounters;						/** Number of counters in a block */
+	unsigned int blockSize;							/** Number of counters in a block including the cache line padding */
+	unsigned int maxThreads_;						/** Number of counter blocks */
+	boost::atomic<unsigned int> registeredThreads;	/** Number of counter blocks handed out */
+	vector <unsigned int> useCaseOffset;			/** Index of the first counter of each use-case (plus end marker) */
+	unsigned int numOfNoiseSources_;				/** Number of noise sources */
+	log4cxx::LoggerPtr logger;						/** Pointer to LoggerPtr class */
+};
@@ -123,14 +123,68 @@ TIME EventIdGenerator::CalculateLatency(USE_CASE_ID ucId, int step, base_generat
 	}
 
 	if (latency.sec() > 10000)
-		LOG4CXX_TRACE (logger, "Problem with boost::*_distribution<> Please file a bug report on https://code.google.com/p/openmsc/issues/list");
+		HOT_LOG_TRACE("Problem with boost::*_distribution<> Please file a bug report on https://code.google.com/p/openmsc/issues/list");
 
-	LOG4CXX_TRACE (logger, "Latency for use-case ID " << ucId
-			<< ", Step " << step
-			<< " = " << latency.millisec() <<
-			"ms\t(Distribution = " << comDescrStruct.latencyDescription.distribution << ")");
+	HOT_LOG_TRACE("Latency for use-case ID {}, Step {} = {}ms\t(Distribution = {})", ucId, step, latency.millisec(),
+			comDescrStruct.latencyDescription.distribution);
 	return TIME(latency.millisec(), "millisec");
 }
+TIME EventIdGenerator::CalculateUeActivity(DISTRIBUTION_DEFINITION_STRUCT *distDef, base_generator_type *gen, bool *valid)
+{
+	TIME sTime;
+	*valid = true;
+
+	if (distDef->distribution == CONSTANT)
+		sTime = distDef->constantLatency;
+	else if (distDef->distribution == UNIFORM_REAL)
+	{
+		boost::uniform_real<> uni_dist_real (distDef->uniformMin.sec(), distDef->uniformMax.sec());
+		boost::variate_generator<base_generator_type&, boost::uniform_real<> > uni_real (*gen, uni_dist_real);
+		sTime = TIME(uni_real(), "sec");
+	}
+	else if (distDef->distribution == UNIFORM_INTEGER)
+	{
+		boost::uniform_int<> uni_dist_int ((int)distDef->uniformMin.sec(), (int)distDef->uniformMax.sec());
+		boost::variate_generator<base_generator_type&, boost::uniform_int<> > uni_int (*gen, uni_dist_int);
+		sTime = TIME(uni_int(), "sec");
+	}
+	else if (distDef->distribution == EXPONENTIAL)
+	{
+		boost::exponential_distribution<> exp_dist (distDef->exponentialLambda);
+		boost::variate_generator<base_generator_type&, boost::exponential_distribution<> > exponential (*gen, exp_dist);
+		sTime = TIME(exponential(), "sec");
+	}
+	else if (distDef->distribution == GAUSSIAN)
+	{
+		float timeGaussian;
+		boost::normal_distribution<> gau_dist (distDef->gaussianMu, distDef->gaussianSigma);
+		boost::variate_generator<base_generator_type&, boost::normal_distribution<> > gaussian (*gen, gau_dist);
+		// make sure the time returned by Boost library is positive
+		while ((timeGaussian = gaussian()) < 0)
+			HOT_LOG_TRACE("Gaussian returned negative value ... request new value");
+		sTime = TIME(timeGaussian, "sec");
+	}
+	else if (distDef->distribution == GAMMA)
+	{
+		boost::gamma_distribution<> gamma_dist (distDef->gammaAlpha, distDef->gammaBeta);
+		boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > gamma (*gen, gamma_dist);
+		sTime = TIME(gamma(), "sec");
+	}
+	else if (distDef->distribution == ERLANG)
+	{
+		boost::gamma_distribution<> erlang_dist (distDef->erlangAlpha, distDef->erlangBeta);
+		boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > erlang (*gen, erlang_dist);
+		sTime = TIME(erlang(), "sec");
+	}
+	else
+	{
+		LOG4CXX_ERROR(logger, "Distribution " << distDef->distribution << " has not been implemented to calculate UE arrival times");
+		*valid = false;
+	}
+
+	HOT_LOG_TRACE("UE activity time = {}s (Distribution = {})", sTime.sec(), distDef->distribution);
+	return sTime;
+}
 void EventIdGenerator::WritePatterns2File()
 {
 	EVENT_ID_VECTOR eventIdV, eIdTmp;
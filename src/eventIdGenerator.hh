@@ -61,6 +61,14 @@ public:
 	 * @return The latency with which the message arrives at the destination in millisecond
 	 */
 	TIME CalculateLatency(USE_CASE_ID ucId, int step, base_generator_type *gen);
+	/**
+	 * Calculate the time until the next activation of a UE
+	 * @param distDef The UE activity distribution read from openmsc.cfg
+	 * @param gen boost number generator
+	 * @param valid Pointer to boolean which is set to false if the distribution has not been implemented
+	 * @return The (positive) time until the next activation
+	 */
+	TIME CalculateUeActivity(DISTRIBUTION_DEFINITION_STRUCT *distDef, base_generator_type *gen, bool *valid);
 	/**
 	 * Writing all patterns (excluding periodical generated numbers) to a file.
 	 */
@@ -0,0 +1,195 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "eventQueue.hh"
+
+void EventQueue::Init(TIME lookahead, unsigned int maxEntries, LATE_EVENT_POLICY policy, TIME lateTolerance)
+{
+	lookahead_ = lookahead.nanosec();
+	maxEntries_ = maxEntries;
+	policy_ = policy;
+	lateTolerance_ = lateTolerance.nanosec();
+	waitingAdds = 0;
+
+	for (int reader = 0; reader < STATISTICS_READERS; reader++)
+	{
+		latenessSum[reader] = 0;
+		latenessCount[reader] = 0;
+		maxLateness[reader] = 0;
+	}
+	statistics_.entries = 0;
+	statistics_.sentEvents = 0;
+	statistics_.lateEvents = 0;
+	statistics_.droppedEvents = 0;
+	statistics_.blockedAdds = 0;
+	statistics_.currentLateness = TIME();
+	statistics_.maxLateness = TIME();
+	statistics_.meanLateness = TIME();
+	statistics_.latenessSamples = 0;
+	LOG4CXX_DEBUG(logger, "Event queue initialised with lookahead = " << lookahead.sec() << "s, maxEntries = "
+			<< maxEntries << ", late policy = " << policy << " and late tolerance = " << lateTolerance.sec() << "s");
+}
+
+void EventQueue::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+TIME EventQueue::Add(TIME t, const EVENT_STRUCT &event)
+{
+	boost::unique_lock<boost::mutex> lock(mutex);
+
+	WaitForSpace(lock, t, 1);
+	// Finding spare time-slot in eventMap
+	while (!eventMap.insert(TIME_EVENT_PAIR (t, event)).second)
+		t = TIME(t.nanosec() + 1, "nanosec");
+	return t;
+}
+
+void EventQueue::AddBatch(TIME_EVENT_ID_PAIR_VECTOR *batch, short noiseSource)
+{
+	EVENT_STRUCT event;
+
+	if (batch->empty())
+		return;
+
+	boost::unique_lock<boost::mutex> lock(mutex);
+	event.useCaseId = 0;
+	event.step = 0;
+	event.noiseSource = noiseSource;
+	event.bsId = 0;
+	event.ueId = 0;
+	event.procedure = 0;
+
+	WaitForSpace(lock, batch->front().first, batch->size());
+	// Finding spare time-slots in eventMap
+	for (unsigned int i = 0; i < batch->size(); i++)
+	{
+		event.eventId = batch->at(i).second;
+
+		while (!eventMap.insert(TIME_EVENT_PAIR (batch->at(i).first, event)).second)
+			batch->at(i).first = TIME(batch->at(i).first.nanosec() + 1, "nanosec");
+	}
+}
+
+bool EventQueue::PopDue(TIME currentTime, TIME_EVENT_PAIR *event)
+{
+	boost::unique_lock<boost::mutex> lock(mutex);
+	EVENT_MAP_IT eventMapIt;
+
+	while (!eventMap.empty() && !(currentTime < eventMap.begin()->first))
+	{
+		eventMapIt = eventMap.begin();
+		unsigned long long lateness = currentTime.nanosec() - eventMapIt->first.nanosec();
+		*event = *eventMapIt;
+		eventMap.erase(eventMapIt);
+
+		if (waitingAdds > 0)
+			spaceAvailable.notify_all();
+
+		if (lateness > lateTolerance_)
+		{
+			if (policy_ == LATE_DROP)
+				continue;
+			else if (policy_ == LATE_DROP_COUNT)
+			{
+				statistics_.droppedEvents++;
+				HOT_LOG_TRACE("Dropping EventID {} which is {}ns late", event->second.eventId, lateness);
+				continue;
+			}
+			statistics_.lateEvents++;
+		}
+
+		statistics_.sentEvents++;
+		statistics_.currentLateness = TIME(lateness, "nanosec");
+
+		for (int reader = 0; reader < STATISTICS_READERS; reader++)
+		{
+			if (maxLateness[reader] < lateness)
+				maxLateness[reader] = lateness;
+			latenessSum[reader] += lateness;
+			latenessCount[reader]++;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+TIME EventQueue::GetLookahead()
+{
+	return TIME(lookahead_, "nanosec");
+}
+
+void EventQueue::GetStatistics(EVENT_QUEUE_STATISTICS_STRUCT *statistics, bool reset, STATISTICS_READER reader)
+{
+	boost::unique_lock<boost::mutex> lock(mutex);
+
+	statistics_.entries = eventMap.size();
+	statistics_.maxLateness = TIME(maxLateness[reader], "nanosec");
+	statistics_.meanLateness = TIME(latenessCount[reader] > 0 ? latenessSum[reader] / latenessCount[reader] : 0, "nanosec");
+	statistics_.latenessSamples = latenessCount[reader];
+	*statistics = statistics_;
+
+	if (reset)
+	{
+		maxLateness[reader] = 0;
+		latenessSum[reader] = 0;
+		latenessCount[reader] = 0;
+	}
+}
+
+void EventQueue::WaitForSpace(boost::unique_lock<boost::mutex> &lock, TIME t, size_t n)
+{
+	bool blocked = false;
+
+	for (;;)
+	{
+		timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		unsigned long long now = (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+		// An empty queue always accepts the EventIDs, otherwise a batch larger than maxEntries would block forever
+		bool full = maxEntries_ > 0 && !eventMap.empty() && eventMap.size() + n > maxEntries_;
+		bool tooEarly = lookahead_ > 0 && t.nanosec() > now + lookahead_;
+
+		if (!full && !tooEarly)
+			break;
+
+		if (!blocked)
+		{
+			blocked = true;
+			statistics_.blockedAdds++;
+		}
+
+		if (full)
+		{
+			waitingAdds++;
+			spaceAvailable.wait(lock);
+			waitingAdds--;
+		}
+		else
+		{
+			// Sleeping until t has come within the lookahead
+			spaceAvailable.timed_wait(lock, boost::posix_time::microseconds((t.nanosec() - now - lookahead_) / 1000 + 1));
+		}
+	}
+}
@@ -0,0 +1,106 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "patternGenerator.hh"
+
+/**
+ * \class EventQueue
+ * This class holds the EventIDs between the generator threads and the sender and bounds the memory it may use.
+ *
+ * The queue is limited in time (lookahead) and in size (maxEntries). A generator adding an EventID which is due later
+ * than the lookahead ahead of the current time, or adding to a full queue, is blocked until the sender has caught up,
+ * so a slow receiver slows the generators down instead of letting the queue grow without bound. EventIDs the sender
+ * takes out later than the late tolerance are handled according to the late event policy.
+ */
+class EventQueue {
+public:
+	/**
+	 * Initialising the event queue
+	 * @param lookahead Maximal time an EventID may be added ahead of the current time (0 = unbounded)
+	 * @param maxEntries Maximal number of queued EventIDs (0 = unbounded)
+	 * @param policy What to do with EventIDs which are taken out later than the late tolerance
+	 * @param lateTolerance Lateness up to which an EventID is not considered to be late
+	 */
+	void Init(TIME lookahead, unsigned int maxEntries, LATE_EVENT_POLICY policy, TIME lateTolerance);
+	/**
+	 * Initialising logging in EventQueue class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Adding a single EventID. Blocks while the queue is full or t lies beyond the lookahead.
+	 * @param t The time at which the EventID should be sent
+	 * @param event The EventID and its classification
+	 * @return The time at which the EventID has been queued (t is moved by 1ns until a spare time-slot is found)
+	 */
+	TIME Add(TIME t, const EVENT_STRUCT &event);
+	/**
+	 * Adding a batch of EventIDs sorted by time under a single lock. Blocks while the queue is full or the first EventID
+	 * lies beyond the lookahead.
+	 * @param batch Pointer to the batch. The times are updated to the time-slots the EventIDs have been queued at
+	 * @param noiseSource The noise source which generated the batch
+	 */
+	void AddBatch(TIME_EVENT_ID_PAIR_VECTOR *batch, short noiseSource);
+	/**
+	 * Taking out the next EventID which is due at the given time. Late EventIDs are handled according to the policy.
+	 * @param currentTime The current time
+	 * @param event Pointer into which the due EventID and its scheduled time are written
+	 * @return true if an EventID is due, false otherwise
+	 */
+	bool PopDue(TIME currentTime, TIME_EVENT_PAIR *event);
+	/**
+	 * Obtain the configured lookahead
+	 * @return The time window ahead of the current time in which EventIDs can be added
+	 */
+	TIME GetLookahead();
+	/**
+	 * Obtain the fill level and lateness statistics
+	 * @param statistics Pointer to the struct which is filled
+	 * @param reset Restart the lateness statistics of the reader after reading them
+	 * @param reader The reader whose mean and maximal lateness are returned
+	 */
+	void GetStatistics(EVENT_QUEUE_STATISTICS_STRUCT *statistics, bool reset, STATISTICS_READER reader);
+private:
+	/**
+	 * Waiting until n EventIDs, the first one due at t, can be added
+	 * @param lock The lock held on the queue mutex
+	 * @param t The time of the first EventID to be added
+	 * @param n The number of EventIDs to be added
+	 */
+	void WaitForSpace(boost::unique_lock<boost::mutex> &lock, TIME t, size_t n);
+	EVENT_MAP eventMap;							/** Queued EventIDs sorted by the time they are due */
+	boost::mutex mutex;							/** Mutex protecting the queue */
+	boost::condition_variable spaceAvailable;	/** Signalled when the sender has taken out EventIDs of a full queue */
+	unsigned long long lookahead_;				/** Lookahead [ns] */
+	unsigned long long lateTolerance_;			/** Late tolerance [ns] */
+	size_t maxEntries_;							/** Maximal number of queued EventIDs */
+	LATE_EVENT_POLICY policy_;					/** Late event policy */
+	unsigned int waitingAdds;					/** Number of generators blocked on a full queue */
+	EVENT_QUEUE_STATISTICS_STRUCT statistics_;	/** Counters and lateness of the EventID sent last */
+	unsigned long long latenessSum[STATISTICS_READERS];		/** Sum of lateness [ns] since the reset of each reader */
+	unsigned long long latenessCount[STATISTICS_READERS];	/** Number of lateness samples since the reset of each reader */
+	unsigned long long maxLateness[STATISTICS_READERS];		/** Maximal lateness [ns] since the reset of each reader */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
@@ -0,0 +1,145 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "eventRouter.hh"
+
+void EventRouter::Init(unsigned int numOfDestinations, PARTITION partition, TIME lookahead, unsigned int maxEntries,
+		LATE_EVENT_POLICY policy, TIME lateTolerance)
+{
+	numOfDestinations_ = numOfDestinations > 0 ? numOfDestinations : 1;
+	partition_ = partition;
+	roundRobin.store(0);
+	// The queues live as long as the sender threads, i.e. until OpenMSC terminates
+	queues = new EventQueue[numOfDestinations_];
+
+	for (unsigned int i = 0; i < numOfDestinations_; i++)
+	{
+		queues[i].InitLog(logger);
+		queues[i].Init(lookahead, maxEntries, policy, lateTolerance);
+	}
+
+	LOG4CXX_DEBUG(logger, "Event router initialised with " << numOfDestinations_ << " destinations and partition "
+			<< partition_);
+}
+
+void EventRouter::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+TIME EventRouter::Add(TIME t, const EVENT_STRUCT &event)
+{
+	return queues[Partition(event)].Add(t, event);
+}
+
+void EventRouter::AddBatch(TIME_EVENT_ID_PAIR_VECTOR *batch, short noiseSource)
+{
+	if (numOfDestinations_ == 1)
+	{
+		queues[0].AddBatch(batch, noiseSource);
+		return;
+	}
+
+	vector <TIME_EVENT_ID_PAIR_VECTOR> batches(numOfDestinations_);
+	vector <unsigned int> destinations(batch->size());
+	vector <unsigned int> positions(numOfDestinations_, 0);
+	unsigned int first = roundRobin.fetch_add(batch->size(), boost::memory_order_relaxed);
+
+	for (unsigned int i = 0; i < batch->size(); i++)
+	{
+		destinations[i] = (first + i) % numOfDestinations_;
+		batches[destinations[i]].push_back(batch->at(i));
+	}
+
+	for (unsigned int d = 0; d < numOfDestinations_; d++)
+		queues[d].AddBatch(&batches[d], noiseSource);
+	// Handing the time-slots the EventIDs have been queued at back to the caller
+	for (unsigned int i = 0; i < batch->size(); i++)
+		batch->at(i).first = batches[destinations[i]][positions[destinations[i]]++].first;
+}
+
+EventQueue * EventRouter::GetQueue(unsigned int destination)
+{
+	return &queues[destination];
+}
+
+unsigned int EventRouter::GetNumOfDestinations()
+{
+	return numOfDestinations_;
+}
+
+TIME EventRouter::GetLookahead()
+{
+	return queues[0].GetLookahead();
+}
+
+void EventRouter::GetStatistics(EVENT_QUEUE_STATISTICS_STRUCT *statistics, bool reset, STATISTICS_READER reader)
+{
+	EVENT_QUEUE_STATISTICS_STRUCT queueStatistics;
+	long double latenessSum = 0;
+
+	queues[0].GetStatistics(statistics, reset, reader);
+	latenessSum = (long double)statistics->meanLateness.nanosec() * statistics->latenessSamples;
+
+	for (unsigned int i = 1; i < numOfDestinations_; i++)
+	{
+		queues[i].GetStatistics(&queueStatistics, reset, reader);
+		statistics->entries += queueStatistics.entries;
+		statistics->sentEvents += queueStatistics.sentEvents;
+		statistics->lateEvents += queueStatistics.lateEvents;
+		statistics->droppedEvents += queueStatistics.droppedEvents;
+		statistics->blockedAdds += queueStatistics.blockedAdds;
+		statistics->latenessSamples += queueStatistics.latenessSamples;
+		latenessSum += (long double)queueStatistics.meanLateness.nanosec() * queueStatistics.latenessSamples;
+
+		if (statistics->currentLateness < queueStatistics.currentLateness)
+			statistics->currentLateness = queueStatistics.currentLateness;
+
+		if (statistics->maxLateness < queueStatistics.maxLateness)
+			statistics->maxLateness = queueStatistics.maxLateness;
+	}
+
+	if (statistics->latenessSamples > 0)
+		statistics->meanLateness = TIME((unsigned long)(latenessSum / statistics->latenessSamples), "nanosec");
+}
+
+unsigned int EventRouter::Partition(const EVENT_STRUCT &event)
+{
+	if (numOfDestinations_ == 1)
+		return 0;
+	// Noise EventIDs have neither a BS, a UE nor a use-case
+	if (partition_ == PARTITION_ROUND_ROBIN || event.noiseSource >= 0)
+		return roundRobin.fetch_add(1, boost::memory_order_relaxed) % numOfDestinations_;
+
+	switch (partition_)
+	{
+	case PARTITION_BS:
+		return event.bsId % numOfDestinations_;
+	case PARTITION_UE:
+		// Multiplicative hashing, so UEs with the same ID at different BSs do not end up at the same destination
+		return ((unsigned int)event.bsId * 2654435761u + (unsigned int)event.ueId) % numOfDestinations_;
+	case PARTITION_USE_CASE:
+		return event.useCaseId % numOfDestinations_;
+	default:
+		return 0;
+	}
+}
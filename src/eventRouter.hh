@@ -0,0 +1,101 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/atomic.hpp>
+#include "eventQueue.hh"
+
+/**
+ * \class EventRouter
+ * This class distributes the EventIDs over the destinations OpenMSC sends to.
+ *
+ * Every destination has its own EventQueue which is drained by its own sender thread, so each destination receives its
+ * EventIDs in time order and the fan-out scales with the number of cores. The partition function decides which
+ * destination an EventID goes to: the BS or UE which triggered it (all EventIDs of a BS/UE reach the same detector),
+ * its use-case or simply round-robin. Noise EventIDs are not triggered by a BS or UE and are always spread round-robin.
+ */
+class EventRouter {
+public:
+	/**
+	 * Initialising the router and the event queues of all destinations
+	 * @param numOfDestinations The number of destinations
+	 * @param partition The partition function
+	 * @param lookahead Maximal time an EventID may be added ahead of the current time (0 = unbounded)
+	 * @param maxEntries Maximal number of queued EventIDs per destination (0 = unbounded)
+	 * @param policy What to do with EventIDs which are taken out later than the late tolerance
+	 * @param lateTolerance Lateness up to which an EventID is not considered to be late
+	 */
+	void Init(unsigned int numOfDestinations, PARTITION partition, TIME lookahead, unsigned int maxEntries,
+			LATE_EVENT_POLICY policy, TIME lateTolerance);
+	/**
+	 * Initialising logging in EventRouter class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Adding a single EventID to the queue of its destination. Blocks while that queue is full.
+	 * @param t The time at which the EventID should be sent
+	 * @param event The EventID and its classification
+	 * @return The time at which the EventID has been queued
+	 */
+	TIME Add(TIME t, const EVENT_STRUCT &event);
+	/**
+	 * Adding a batch of noise EventIDs sorted by time, spread round-robin over the destinations
+	 * @param batch Pointer to the batch. The times are updated to the time-slots the EventIDs have been queued at
+	 * @param noiseSource The noise source which generated the batch
+	 */
+	void AddBatch(TIME_EVENT_ID_PAIR_VECTOR *batch, short noiseSource);
+	/**
+	 * Obtain the event queue of a destination
+	 * @param destination Index of the destination
+	 * @return Pointer to the event queue drained by the sender thread of this destination
+	 */
+	EventQueue * GetQueue(unsigned int destination);
+	/**
+	 * Obtain the number of destinations
+	 * @return The number of destinations
+	 */
+	unsigned int GetNumOfDestinations();
+	/**
+	 * Obtain the configured lookahead
+	 * @return The time window ahead of the current time in which EventIDs can be added
+	 */
+	TIME GetLookahead();
+	/**
+	 * Obtain the fill level and lateness statistics summed up over all destinations
+	 * @param statistics Pointer to the struct which is filled
+	 * @param reset Restart the lateness statistics of the reader after reading them
+	 * @param reader The reader whose mean and maximal lateness are returned
+	 */
+	void GetStatistics(EVENT_QUEUE_STATISTICS_STRUCT *statistics, bool reset, STATISTICS_READER reader);
+private:
+	/**
+	 * Applying the partition function
+	 * @param event The EventID
+	 * @return The index of the destination
+	 */
+	unsigned int Partition(const EVENT_STRUCT &event);
+	EventQueue *queues;							/** One event queue per destination */
+	unsigned int numOfDestinations_;			/** Number of destinations */
+	PARTITION partition_;						/** Partition function */
+	boost::atomic<unsigned int> roundRobin;		/** Destination counter for round-robin partitioning */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
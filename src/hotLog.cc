@@ -0,0 +1,206 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hotLog.hh"
+
+HotLog hotLog;
+
+void HotLog::Init(unsigned int capacity, log4cxx::LoggerPtr l)
+{
+	unsigned long n = 1;
+
+	logger = l;
+	level_ = 0;
+	ring = NULL;
+	head.store(0);
+	tail = 0;
+	dropped.store(0);
+	reportedDropped = 0;
+
+	if (logger->isTraceEnabled())
+		level_ = HOT_LOG_LEVEL_TRACE;
+	else if (logger->isDebugEnabled())
+		level_ = HOT_LOG_LEVEL_DEBUG;
+	else
+		return;
+
+	while (n < capacity)
+		n <<= 1;
+
+	ring = new HOT_LOG_RECORD_STRUCT[n];
+	mask = n - 1;
+	// A record is free for position p while its sequence equals p
+	for (unsigned long i = 0; i < n; i++)
+		ring[i].sequence.store(i, boost::memory_order_relaxed);
+	LOG4CXX_INFO(logger, "Hot-path logging through a ring of " << n << " messages");
+}
+
+HOT_LOG_RECORD_STRUCT * HotLog::Claim(HOT_LOG_LEVEL level, const char *format, unsigned long *position)
+{
+	unsigned long p = head.load(boost::memory_order_relaxed);
+	HOT_LOG_RECORD_STRUCT *record;
+
+	for (;;)
+	{
+		record = &ring[p & mask];
+		long diff = (long) (record->sequence.load(boost::memory_order_acquire) - p);
+
+		if (diff == 0)
+		{
+			if (head.compare_exchange_weak(p, p + 1, boost::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// The formatting thread has not caught up with this record yet
+			dropped.fetch_add(1, boost::memory_order_relaxed);
+			return NULL;
+		}
+		else
+			p = head.load(boost::memory_order_relaxed);
+	}
+
+	record->format = format;
+	record->level = level;
+	record->numOfArgs = 0;
+	record->length = 0;
+	*position = p;
+	return record;
+}
+
+void HotLog::PutRaw(HOT_LOG_RECORD_STRUCT *record, HOT_LOG_ARG type, const void *value, unsigned int size)
+{
+	if (record->numOfArgs == HOT_LOG_MAX_ARGS || record->length + size > HOT_LOG_PAYLOAD_SIZE)
+		return;
+
+	memcpy(record->payload + record->length, value, size);
+	record->length += size;
+	record->types[record->numOfArgs++] = type;
+}
+
+void HotLog::PutString(HOT_LOG_RECORD_STRUCT *record, const char *value, size_t length)
+{
+	if (record->numOfArgs == HOT_LOG_MAX_ARGS || record->length + 1 >= HOT_LOG_PAYLOAD_SIZE)
+		return;
+	// Strings are truncated to the remaining payload
+	if (length > HOT_LOG_PAYLOAD_SIZE - record->length - 1u)
+		length = HOT_LOG_PAYLOAD_SIZE - record->length - 1u;
+
+	record->payload[record->length] = (unsigned char) length;
+	memcpy(record->payload + record->length + 1, value, length);
+	record->length += 1 + length;
+	record->types[record->numOfArgs++] = HOT_LOG_STRING;
+}
+
+unsigned long HotLog::Drain()
+{
+	unsigned long formatted = 0;
+
+	if (ring == NULL)
+		return 0;
+
+	for (;;)
+	{
+		HOT_LOG_RECORD_STRUCT *record = &ring[tail & mask];
+		ostringstream message;
+		unsigned int offset = 0, arg = 0;
+
+		if (record->sequence.load(boost::memory_order_acquire) != tail + 1)
+			break;
+
+		for (const char *c = record->format; *c != '\0'; c++)
+		{
+			if (c[0] != '{' || c[1] != '}')
+			{
+				message << *c;
+				continue;
+			}
+			c++;
+
+			if (arg == record->numOfArgs)
+			{
+				message << "?";
+				continue;
+			}
+
+			switch (record->types[arg++])
+			{
+			case HOT_LOG_SIGNED:
+			{
+				long long value;
+				memcpy(&value, record->payload + offset, sizeof(value));
+				offset += sizeof(value);
+				message << value;
+				break;
+			}
+			case HOT_LOG_UNSIGNED:
+			{
+				unsigned long long value;
+				memcpy(&value, record->payload + offset, sizeof(value));
+				offset += sizeof(value);
+				message << value;
+				break;
+			}
+			case HOT_LOG_DOUBLE:
+			{
+				double value;
+				memcpy(&value, record->payload + offset, sizeof(value));
+				offset += sizeof(value);
+				message << value;
+				break;
+			}
+			case HOT_LOG_STRING:
+			{
+				unsigned int length = (unsigned char) record->payload[offset];
+				message.write(record->payload + offset + 1, length);
+				offset += 1 + length;
+				break;
+			}
+			}
+		}
+
+		if (record->level == HOT_LOG_LEVEL_TRACE)
+		{
+			LOG4CXX_TRACE(logger, message.str());
+		}
+		else
+			LOG4CXX_DEBUG(logger, message.str());
+		// Hand the record back to the producers for the next round of the ring
+		record->sequence.store(tail + mask + 1, boost::memory_order_release);
+		tail++;
+		formatted++;
+	}
+
+	unsigned long d = dropped.load(boost::memory_order_relaxed);
+	if (d != reportedDropped)
+	{
+		LOG4CXX_WARN(logger, d - reportedDropped << " hot-path log messages dropped (ring full)");
+		reportedDropped = d;
+	}
+
+	return formatted;
+}
+
+unsigned long HotLog::GetDropped()
+{
+	return dropped.load(boost::memory_order_relaxed);
+}
@@ -0,0 +1,223 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "visualiser.hh"
+
+/**
+ * Hot-path logging
+ *
+ * The per-EventID TRACE/DEBUG messages of the generators and the sender go through HOT_LOG_TRACE() and HOT_LOG_DEBUG()
+ * instead of LOG4CXX_TRACE() and LOG4CXX_DEBUG(). The messages are not formatted where they are logged: the format (a
+ * string literal with one {} per argument) and the raw arguments are copied into a lock-free ring and a background
+ * thread formats them and hands them to log4cxx. If the ring is full the message is dropped and counted.
+ *
+ * Compiling with -DOPENMSC_NO_HOT_LOG (make RELEASE=1) removes all hot-path log sites.
+ */
+#ifdef OPENMSC_NO_HOT_LOG
+#define HOT_LOG_TRACE(...) do {} while (0)
+#define HOT_LOG_DEBUG(...) do {} while (0)
+#else
+#define HOT_LOG_TRACE(...) do { if (hotLog.IsEnabled(HOT_LOG_LEVEL_TRACE)) hotLog.Write(HOT_LOG_LEVEL_TRACE, __VA_ARGS__); } while (0)
+#define HOT_LOG_DEBUG(...) do { if (hotLog.IsEnabled(HOT_LOG_LEVEL_DEBUG)) hotLog.Write(HOT_LOG_LEVEL_DEBUG, __VA_ARGS__); } while (0)
+#endif
+
+/**
+ * \typedef HOT_LOG_RECORD_STRUCT
+ * \brief A hot-path log message with its raw arguments (128 bytes)
+ */
+typedef struct hotLogRecord {
+	boost::atomic<unsigned long> sequence;		/** Ring position + 1 once the record has been written */
+	const char *format;							/** Format with one {} per argument */
+	unsigned char level;						/** HOT_LOG_LEVEL */
+	unsigned char numOfArgs;					/** Number of arguments in the payload */
+	unsigned char length;						/** Bytes of the payload in use */
+	unsigned char types[HOT_LOG_MAX_ARGS];		/** HOT_LOG_ARG of every argument */
+	char payload[HOT_LOG_PAYLOAD_SIZE];			/** The arguments, strings are stored as length + characters */
+} HOT_LOG_RECORD_STRUCT;
+
+/**
+ * \class HotLog
+ * Lock-free multi-producer/single-consumer ring of hot-path log messages
+ *
+ * Producers claim a record by advancing the head, write it and release it through its sequence number, so neither the
+ * producers nor the formatting thread ever take a lock.
+ */
+class HotLog {
+public:
+	/**
+	 * Allocating the ring if the logger has DEBUG or TRACE enabled
+	 * @param capacity The number of records (rounded up to a power of two)
+	 * @param l Pointer to LoggerPtr class the messages are handed to
+	 */
+	void Init(unsigned int capacity, log4cxx::LoggerPtr l);
+	/**
+	 * Check if messages of a level are logged
+	 * @param level HOT_LOG_LEVEL_TRACE or HOT_LOG_LEVEL_DEBUG
+	 * @return true if the message should be written
+	 */
+	bool IsEnabled(HOT_LOG_LEVEL level) { return level <= level_; }
+	/**
+	 * Writing a message (producer side)
+	 * @param level The level of the message
+	 * @param format String literal with one {} per argument
+	 */
+	void Write(HOT_LOG_LEVEL level, const char *format)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record != NULL)
+			Publish(record, position);
+	}
+	template <class A>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Publish(record, position);
+	}
+	template <class A, class B>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a, const B &b)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Put(record, b);
+		Publish(record, position);
+	}
+	template <class A, class B, class C>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a, const B &b, const C &c)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Put(record, b);
+		Put(record, c);
+		Publish(record, position);
+	}
+	template <class A, class B, class C, class D>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a, const B &b, const C &c, const D &d)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Put(record, b);
+		Put(record, c);
+		Put(record, d);
+		Publish(record, position);
+	}
+	template <class A, class B, class C, class D, class E>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a, const B &b, const C &c, const D &d, const E &e)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Put(record, b);
+		Put(record, c);
+		Put(record, d);
+		Put(record, e);
+		Publish(record, position);
+	}
+	template <class A, class B, class C, class D, class E, class F>
+	void Write(HOT_LOG_LEVEL level, const char *format, const A &a, const B &b, const C &c, const D &d, const E &e,
+			const F &f)
+	{
+		unsigned long position;
+		HOT_LOG_RECORD_STRUCT *record = Claim(level, format, &position);
+		if (record == NULL)
+			return;
+		Put(record, a);
+		Put(record, b);
+		Put(record, c);
+		Put(record, d);
+		Put(record, e);
+		Put(record, f);
+		Publish(record, position);
+	}
+	/**
+	 * Formatting all written messages and handing them to log4cxx (consumer side)
+	 * @return The number of messages formatted
+	 */
+	unsigned long Drain();
+	/**
+	 * Obtain the number of messages dropped because the ring was full
+	 * @return The number of dropped messages
+	 */
+	unsigned long GetDropped();
+private:
+	/**
+	 * Claiming the next free record of the ring
+	 * @param level The level of the message
+	 * @param format The format of the message
+	 * @param position Pointer into which the ring position of the record is written
+	 * @return Pointer to the record, NULL if the ring is full
+	 */
+	HOT_LOG_RECORD_STRUCT * Claim(HOT_LOG_LEVEL level, const char *format, unsigned long *position);
+	/**
+	 * Handing a written record to the consumer
+	 * @param record The record obtained from Claim()
+	 * @param position The ring position of the record
+	 */
+	void Publish(HOT_LOG_RECORD_STRUCT *record, unsigned long position)
+	{
+		record->sequence.store(position + 1, boost::memory_order_release);
+	}
+	/**
+	 * Appending an argument to the payload of a record, arguments which do not fit anymore are left out
+	 */
+	void Put(HOT_LOG_RECORD_STRUCT *record, long long value) { PutRaw(record, HOT_LOG_SIGNED, &value, sizeof(value)); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, int value) { Put(record, (long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, long value) { Put(record, (long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, short value) { Put(record, (long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, unsigned long long value) { PutRaw(record, HOT_LOG_UNSIGNED, &value, sizeof(value)); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, unsigned int value) { Put(record, (unsigned long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, unsigned long value) { Put(record, (unsigned long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, unsigned short value) { Put(record, (unsigned long long) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, double value) { PutRaw(record, HOT_LOG_DOUBLE, &value, sizeof(value)); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, float value) { Put(record, (double) value); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, const string &value) { PutString(record, value.data(), value.length()); }
+	void Put(HOT_LOG_RECORD_STRUCT *record, const char *value) { PutString(record, value, strlen(value)); }
+	void PutRaw(HOT_LOG_RECORD_STRUCT *record, HOT_LOG_ARG type, const void *value, unsigned int size);
+	void PutString(HOT_LOG_RECORD_STRUCT *record, const char *value, size_t length);
+
+	HOT_LOG_RECORD_STRUCT *ring;		/** The records of the ring */
+	unsigned long mask;					/** Number of records - 1 */
+	boost::atomic<unsigned long> head;	/** Next record claimed by a producer */
+	unsigned long tail;					/** Next record formatted by the consumer */
+	boost::atomic<unsigned long> dropped;	/** Messages dropped because the ring was full */
+	unsigned long reportedDropped;		/** Dropped messages reported by the consumer so far */
+	int level_;							/** Highest level which is logged (0 = hot-path logging off) */
+	log4cxx::LoggerPtr logger;			/** Pointer to LoggerPtr class */
+};
+
+extern HotLog hotLog;	/** The hot-path log shared by all threads */
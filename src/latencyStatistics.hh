@@ -0,0 +1,197 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <iomanip>
+
+/**
+ * Statistics of stamped EventIDs kept by the receivers (see wireFormat.hh)
+ *
+ * LATENCY_HISTOGRAM_STRUCT is a log-linear histogram: LATENCY_SUB_BUCKETS linear buckets per power of two, so any
+ * percentile is reported with a relative error below 1 / LATENCY_SUB_BUCKETS at constant memory and O(1) insertion.
+ * SEQUENCE_STATISTICS_STRUCT derives loss, reordering and duplicates from the sequence numbers of a single sender.
+ */
+#define LATENCY_SUB_BUCKETS 32
+#define LATENCY_BUCKETS (64 * LATENCY_SUB_BUCKETS)
+
+/**
+ * \typedef LATENCY_HISTOGRAM_STRUCT
+ * \brief Distribution of a time difference [ns]
+ */
+typedef struct latencyHistogram {
+	unsigned long long count;					/** Number of samples */
+	long double sum;							/** Sum of the samples [ns] */
+	unsigned long long min;						/** Minimal sample [ns] */
+	unsigned long long max;						/** Maximal sample [ns] */
+	unsigned long long negative;				/** Samples below 0 (clocks not synchronised), counted as 0 */
+	unsigned long long buckets[LATENCY_BUCKETS];	/** Number of samples per bucket */
+} LATENCY_HISTOGRAM_STRUCT;
+
+/**
+ * \typedef SEQUENCE_STATISTICS_STRUCT
+ * \brief Loss and reordering derived from the sequence numbers
+ */
+typedef struct sequenceStatistics {
+	unsigned long long nextSequence;	/** Sequence number expected next */
+	unsigned long long received;		/** Messages received */
+	unsigned long long lost;			/** Messages missing (a late message reduces it again) */
+	unsigned long long reordered;		/** Messages received after a message with a higher sequence number */
+	unsigned long long duplicates;		/** Messages received with the sequence number received last */
+} SEQUENCE_STATISTICS_STRUCT;
+
+/**
+ * Clearing a histogram
+ * @param histogram The histogram
+ */
+static inline void LatencyHistogramReset(LATENCY_HISTOGRAM_STRUCT *histogram)
+{
+	memset(histogram, 0, sizeof(LATENCY_HISTOGRAM_STRUCT));
+	histogram->min = ~0ULL;
+}
+
+/**
+ * Adding a sample
+ * @param histogram The histogram
+ * @param from Start of the interval [ns], e.g. the send time
+ * @param to End of the interval [ns], e.g. the receive time
+ */
+static inline void LatencyHistogramAdd(LATENCY_HISTOGRAM_STRUCT *histogram, uint64_t from, uint64_t to)
+{
+	unsigned long long value = 0;
+	unsigned int exponent = 0, bucket;
+
+	if (to >= from)
+		value = to - from;
+	else
+		histogram->negative++;
+
+	while ((value >> exponent) >= 2 * LATENCY_SUB_BUCKETS)
+		exponent++;
+
+	bucket = exponent * LATENCY_SUB_BUCKETS + (value >> exponent);
+	histogram->buckets[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+	histogram->count++;
+	histogram->sum += value;
+
+	if (value < histogram->min)
+		histogram->min = value;
+
+	if (value > histogram->max)
+		histogram->max = value;
+}
+
+/**
+ * Obtain a percentile
+ * @param histogram The histogram
+ * @param p The percentile as fraction, e.g. 0.99
+ * @return The lower bound of the bucket holding the percentile [ns]
+ */
+static inline unsigned long long LatencyHistogramPercentile(const LATENCY_HISTOGRAM_STRUCT *histogram, double p)
+{
+	unsigned long long rank = (unsigned long long)(p * histogram->count), count = 0, value;
+
+	for (unsigned int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+	{
+		count += histogram->buckets[bucket];
+
+		if (count > rank)
+		{
+			if (bucket < 2 * LATENCY_SUB_BUCKETS)
+				value = bucket;
+			else
+				value = (unsigned long long)(bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS)
+						<< (bucket / LATENCY_SUB_BUCKETS - 1);
+
+			return value > histogram->min ? value : histogram->min;
+		}
+	}
+
+	return histogram->max;
+}
+
+/**
+ * Printing min, mean, percentiles and max in microseconds on a single line
+ * @param out The stream to print to
+ * @param histogram The histogram
+ */
+static inline void LatencyHistogramPrint(std::ostream &out, const LATENCY_HISTOGRAM_STRUCT *histogram)
+{
+	if (histogram->count == 0)
+	{
+		out << "no samples\n";
+		return;
+	}
+
+	out << std::fixed << std::setprecision(1)
+			<< "min " << histogram->min / 1000.0
+			<< "\tmean " << (double)(histogram->sum / histogram->count) / 1000.0
+			<< "\tp50 " << LatencyHistogramPercentile(histogram, 0.5) / 1000.0
+			<< "\tp90 " << LatencyHistogramPercentile(histogram, 0.9) / 1000.0
+			<< "\tp99 " << LatencyHistogramPercentile(histogram, 0.99) / 1000.0
+			<< "\tp99.9 " << LatencyHistogramPercentile(histogram, 0.999) / 1000.0
+			<< "\tmax " << histogram->max / 1000.0;
+
+	if (histogram->negative > 0)
+		out << "\t(" << histogram->negative << " negative)";
+
+	out << "\n";
+}
+
+/**
+ * Accounting the sequence number of a received message
+ * @param statistics The statistics
+ * @param sequence The sequence number
+ */
+static inline void SequenceStatisticsAdd(SEQUENCE_STATISTICS_STRUCT *statistics, uint64_t sequence)
+{
+	statistics->received++;
+
+	if (sequence >= statistics->nextSequence)
+	{
+		statistics->lost += sequence - statistics->nextSequence;
+		statistics->nextSequence = sequence + 1;
+	}
+	else if (sequence + 1 == statistics->nextSequence)
+		statistics->duplicates++;
+	else
+	{
+		// A late message which had been counted as lost
+		statistics->reordered++;
+
+		if (statistics->lost > 0)
+			statistics->lost--;
+	}
+}
+
+/**
+ * Printing loss, reordering and duplicates on a single line
+ * @param out The stream to print to
+ * @param statistics The statistics
+ */
+static inline void SequenceStatisticsPrint(std::ostream &out, const SEQUENCE_STATISTICS_STRUCT *statistics)
+{
+	out << "lost " << statistics->lost << " (" << std::setprecision(4) << std::fixed
+			<< (statistics->nextSequence > 0 ? 100.0 * statistics->lost / statistics->nextSequence : 0)
+			<< "%)\treordered " << statistics->reordered << "\tduplicates " << statistics->duplicates << "\n";
+}
@@ -0,0 +1,283 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "libopenmsc.hh"
+#include <unistd.h>
+#include <errno.h>
+
+OpenMsc::OpenMsc()
+{
+	loaded = false;
+	ring_ = NULL;
+	producing.store(false);
+}
+
+bool OpenMsc::Load(string configFile, string mscFile)
+{
+	libconfig::Config cfg;
+	GENERATOR_DEFINITION_STRUCT definition;
+
+	try
+	{
+		cfg.readFile(configFile.c_str());
+	}
+	catch(const libconfig::FileIOException &fioex)
+	{
+		LOG4CXX_ERROR(logger,"I/O error while reading file. " << configFile);
+		return false;
+	}
+	catch(const libconfig::ParseException &pex)
+	{
+		LOG4CXX_ERROR(logger,"Parse error in file " << configFile);
+		return false;
+	}
+
+	try
+	{
+		const libconfig::Setting &openmscConfig = cfg.getRoot()["openmscConfig"];
+
+		// The information elements go straight into readMsc
+		if (!patternGenerator.ReadDefinition(openmscConfig, &definition, &readMsc))
+			return false;
+	}
+	catch(const libconfig::SettingNotFoundException &nfex)
+	{
+		LOG4CXX_ERROR(logger, "Setting not found in " << configFile);
+		return false;
+	}
+
+	return Load(definition, INFORMATION_ELEMENT_DESCRIPTION_MAP(), mscFile);
+}
+
+bool OpenMsc::Load(GENERATOR_DEFINITION_STRUCT definition, INFORMATION_ELEMENT_DESCRIPTION_MAP informationElements,
+		string mscFile)
+{
+	definition_ = definition;
+	dictionary.Init();
+	dictionary.InitLog(logger);
+	readMsc.InitLog(logger);
+	readMsc.EstablishDictConnection(&dictionary);
+
+	for (INFORMATION_ELEMENT_DESCRIPTION_MAP_IT it = informationElements.begin(); it != informationElements.end(); it++)
+		readMsc.AddInformationElementDescription(*it);
+
+	readMsc.AddConfig(&definition_.numOfUesPerBs, &definition_.numOfBss);
+
+	if (readMsc.ReadMscConfigFile(mscFile) != 0)
+		return false;
+
+	eventIdGenerator.Init(&readMsc);
+	eventIdGenerator.InitLog(logger);
+	loaded = true;
+	LOG4CXX_INFO(logger, "Model loaded: " << readMsc.GetNumOfUseCases() << " use-cases on " << definition_.numOfBss
+			<< " BSs x " << definition_.numOfUesPerBs << " UEs");
+	return true;
+}
+
+void OpenMsc::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+	patternGenerator.InitLog(l);
+}
+
+bool OpenMsc::Start(GENERATION_TIME mode)
+{
+	timespec ts;
+
+	if (!loaded)
+	{
+		LOG4CXX_ERROR(logger, "No model loaded");
+		return false;
+	}
+
+	mode_ = mode;
+	horizon = TIME();
+
+	if (mode == GENERATION_REAL_TIME)
+	{
+		clock_gettime(CLOCK_REALTIME, &ts);
+		horizon = TIME((unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec, "nanosec");
+	}
+
+	lastEvent = horizon;
+	buffer.clear();
+	return patternGenerator.Init(&eventIdGenerator, &readMsc, definition_, NULL, horizon);
+}
+
+bool OpenMsc::Next(TIME_EVENT_PAIR *event)
+{
+	if (!Fill())
+		return false;
+
+	if (mode_ == GENERATION_REAL_TIME)
+		WaitUntil(buffer.begin()->first);
+
+	*event = *buffer.begin();
+	buffer.erase(buffer.begin());
+	lastEvent = event->first;
+	return true;
+}
+
+unsigned int OpenMsc::Pull(TIME_EVENT_VECTOR *events, unsigned int maxEvents)
+{
+	TIME_EVENT_PAIR event;
+	timespec ts;
+	TIME currentTime;
+
+	events->clear();
+
+	if (maxEvents == 0 || !Next(&event))
+		return 0;
+
+	events->push_back(event);
+
+	if (mode_ == GENERATION_REAL_TIME)
+	{
+		clock_gettime(CLOCK_REALTIME, &ts);
+		currentTime = TIME((unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec, "nanosec");
+	}
+
+	// In real time only the EventIDs which are due already are added, the batch never waits
+	while (events->size() < maxEvents && Fill()
+			&& (mode_ == GENERATION_VIRTUAL_TIME || !(currentTime < buffer.begin()->first)))
+	{
+		events->push_back(*buffer.begin());
+		buffer.erase(buffer.begin());
+	}
+
+	lastEvent = events->back().first;
+	return events->size();
+}
+
+unsigned long OpenMsc::Run(TIME duration, EVENT_CALLBACK callback, void *context)
+{
+	TIME end = TIME(lastEvent.nanosec() + duration.nanosec(), "nanosec");
+	TIME_EVENT_PAIR event;
+	unsigned long count = 0;
+
+	while (Fill() && !(end < buffer.begin()->first) && Next(&event))
+	{
+		callback(event, context);
+		count++;
+	}
+
+	lastEvent = end;
+	return count;
+}
+
+bool OpenMsc::StartProducer(EventRing *ring)
+{
+	int rc;
+
+	ring_ = ring;
+	producing.store(true);
+	rc = pthread_create(&producer, NULL, Produce, (void *)this);
+
+	if (rc)
+	{
+		LOG4CXX_ERROR(logger, "Unable to create producer thread, " << rc);
+		producing.store(false);
+		return false;
+	}
+
+	return true;
+}
+
+void OpenMsc::StopProducer()
+{
+	if (ring_ == NULL)
+		return;
+
+	producing.store(false);
+	pthread_join(producer, NULL);
+	ring_ = NULL;
+}
+
+bool OpenMsc::IsProducing()
+{
+	return producing.load();
+}
+
+bool OpenMsc::SetControlState(CONTROL_STATE_STRUCT requested)
+{
+	// EventIDs up to the horizon have been generated already, the change applies from there on
+	return patternGenerator.ApplyControlState(requested, horizon);
+}
+
+bool OpenMsc::Fill()
+{
+	while (buffer.empty())
+	{
+		TIME nextActivation = patternGenerator.GetNextActivationTime();
+
+		if (patternGenerator.GetPopulation()->GetNumOfQueuedUes() == 0)
+			return false;
+		// Advance by at least one bucket of the calendar queue, jumping over idle periods
+		horizon = TIME(horizon.nanosec() + definition_.populationBucketWidth.nanosec(), "nanosec");
+
+		if (horizon < nextActivation)
+			horizon = nextActivation;
+
+		if (!patternGenerator.Generate(horizon, BufferEvent, this))
+			return false;
+	}
+
+	return true;
+}
+
+void OpenMsc::BufferEvent(const TIME_EVENT_PAIR &event, void *context)
+{
+	((OpenMsc *)context)->buffer.insert(event);
+}
+
+void *OpenMsc::Produce(void *openMsc)
+{
+	OpenMsc *o = (OpenMsc *)openMsc;
+	TIME_EVENT_PAIR event;
+
+	while (o->producing.load(boost::memory_order_relaxed) && o->Next(&event))
+	{
+		while (o->ring_->IsFull())
+		{
+			if (!o->producing.load(boost::memory_order_relaxed))
+				return NULL;
+
+			usleep(LIBOPENMSC_RING_WAIT);
+		}
+
+		o->ring_->Push(event);
+	}
+
+	o->producing.store(false);
+	return NULL;
+}
+
+void OpenMsc::WaitUntil(TIME t)
+{
+	timespec ts;
+
+	ts.tv_sec = t.nanosec() / 1000000000ULL;
+	ts.tv_nsec = t.nanosec() % 1000000000ULL;
+
+	while (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
@@ -0,0 +1,163 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include "patternGenerator.hh"
+
+/**
+ * \class OpenMsc
+ * This class embeds the pattern generator of OpenMSC into another program, e.g. a detector benchmark, and hands out the
+ * generated EventIDs in-process instead of sending them through a socket.
+ *
+ * A model is loaded from openmsc.cfg and the MSC (or given as GENERATOR_DEFINITION_STRUCT). In virtual time the
+ * EventIDs are generated as fast as they are pulled and carry a time starting at 0, in real time they carry the
+ * wall-clock time (CLOCK_REALTIME) and are handed out once they are due. The EventIDs are handed out sorted by time
+ * either one by one (Next), in batches (Pull), through a callback (Run) or by a producer thread through a lock-free
+ * EventRing (StartProducer). Noise sources, the eventQueue and the senders of openmsc are not part of the library.
+ *
+ *	OpenMsc openMsc;
+ *	TIME_EVENT_VECTOR batch;
+ *
+ *	openMsc.InitLog(logger);
+ *	if (!openMsc.Load("openmsc.cfg", "openmsc.msc") || !openMsc.Start(GENERATION_VIRTUAL_TIME))
+ *		return EXIT_FAILURE;
+ *	while (openMsc.Pull(&batch, 1024) > 0)
+ *		detector.Process(batch);
+ *
+ * The class is not thread-safe: while a producer thread is running only the EventRing may be used.
+ */
+class OpenMsc {
+public:
+	/**
+	 * Constructor
+	 */
+	OpenMsc();
+	/**
+	 * Loading a model from openmsc.cfg (UE population, UE activity and information elements) and an MSC file
+	 * @param configFile The libconfig file holding the openmscConfig group
+	 * @param mscFile The MSC file
+	 * @return false if one of the files could not be read
+	 */
+	bool Load(string configFile, string mscFile);
+	/**
+	 * Loading a model given by the caller and an MSC file
+	 * @param definition The UE population and its activity
+	 * @param informationElements The information elements used in the MSC besides UE_ID and BS_ID
+	 * @param mscFile The MSC file
+	 * @return false if the MSC file could not be read
+	 */
+	bool Load(GENERATOR_DEFINITION_STRUCT definition, INFORMATION_ELEMENT_DESCRIPTION_MAP informationElements,
+			string mscFile);
+	/**
+	 * Initialising logging in OpenMsc class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Starting the generation, i.e. drawing the first activation of every UE
+	 * @param mode Virtual time (starting at 0, as fast as pulled) or real time (wall-clock, handed out when due)
+	 * @return false if no model has been loaded or the distribution of the UE activity is invalid
+	 */
+	bool Start(GENERATION_TIME mode);
+	/**
+	 * Taking out the next EventID. Blocks in real time until it is due.
+	 * @param event Pointer into which the EventID and its time are written
+	 * @return false if no further EventID will be generated
+	 */
+	bool Next(TIME_EVENT_PAIR *event);
+	/**
+	 * Taking out a batch of EventIDs. In real time blocks until the first one is due and returns the ones due by then.
+	 * @param events Pointer to the vector the EventIDs are written to (cleared first)
+	 * @param maxEvents The maximal number of EventIDs
+	 * @return The number of EventIDs, 0 if no further EventID will be generated
+	 */
+	unsigned int Pull(TIME_EVENT_VECTOR *events, unsigned int maxEvents);
+	/**
+	 * Handing all EventIDs of the given period, counted from the last EventID taken out, to a callback
+	 * @param duration The period
+	 * @param callback The function every EventID is handed to
+	 * @param context Pointer handed to the callback
+	 * @return The number of EventIDs
+	 */
+	unsigned long Run(TIME duration, EVENT_CALLBACK callback, void *context);
+	/**
+	 * Starting a thread which generates into a lock-free ring buffer, so generation and consumption run on different
+	 * cores. The thread waits while the ring is full rather than dropping EventIDs.
+	 * @param ring The ring buffer, initialised by the caller and consumed with EventRing::Pop()
+	 * @return false if the thread could not be created
+	 */
+	bool StartProducer(EventRing *ring);
+	/**
+	 * Stopping the producer thread and waiting for it
+	 */
+	void StopProducer();
+	/**
+	 * Checking whether the producer thread is generating
+	 * @return false once the producer has been stopped or no further EventID will be generated
+	 */
+	bool IsProducing();
+	/**
+	 * Taking over a new population and UE activity
+	 * @param requested The requested state (activityScale 1 and the numbers of the model = as loaded)
+	 * @return false if the distribution of the UE activity is invalid
+	 */
+	bool SetControlState(CONTROL_STATE_STRUCT requested);
+private:
+	/**
+	 * Generating until at least one EventID is buffered. All EventIDs generated up to the horizon are final, so the
+	 * first buffered EventID is the next one in time.
+	 * @return false if no further EventID will be generated
+	 */
+	bool Fill();
+	/**
+	 * Callback of the PatternGenerator buffering an EventID
+	 * @param event The EventID and its time
+	 * @param context Pointer to the OpenMsc instance
+	 */
+	static void BufferEvent(const TIME_EVENT_PAIR &event, void *context);
+	/**
+	 * Producer thread
+	 * @param openMsc Pointer to the OpenMsc instance
+	 * @return void
+	 */
+	static void *Produce(void *openMsc);
+	/**
+	 * Waiting until the wall-clock time has reached t
+	 * @param t The time
+	 */
+	void WaitUntil(TIME t);
+	Dictionary dictionary;					/** Dictionary of the MSC */
+	ReadMsc readMsc;						/** The MSC */
+	EventIdGenerator eventIdGenerator;		/** EventIDs and latencies of the MSC */
+	PatternGenerator patternGenerator;		/** The generator loop */
+	GENERATOR_DEFINITION_STRUCT definition_;	/** The UE population and its activity (readMsc points into it) */
+	bool loaded;							/** A model has been loaded */
+	GENERATION_TIME mode_;					/** Virtual or real time */
+	TIME horizon;							/** Time up to which all EventIDs have been generated */
+	TIME lastEvent;							/** Time of the last EventID taken out */
+	EVENT_MULTIMAP buffer;					/** Generated EventIDs not taken out yet, sorted by time */
+	EventRing *ring_;						/** Ring buffer of the producer thread */
+	pthread_t producer;						/** Producer thread */
+	boost::atomic<bool> producing;			/** The producer thread is running */
+	log4cxx::LoggerPtr logger;				/** Pointer to LoggerPtr class */
+};
@@ -0,0 +1,143 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "loadRamp.hh"
+#include <sstream>
+
+bool LoadRamp::Init(RAMP_DEFINITION_STRUCT definition, TIME startTime)
+{
+	definition_ = definition;
+	startTime_ = startTime.sec();
+	step = 0;
+	kneeFound = false;
+	windowPassed = false;
+	curve.open(definition.outputFile.c_str());
+
+	if (!curve.is_open())
+	{
+		LOG4CXX_ERROR(logger, "Ramp curve " << definition.outputFile << " could not be opened");
+		return false;
+	}
+
+	curve << "#targetRate\tsentRate\tlateFraction\tmeanLatenessMs\tmaxLatenessMs\tdropped\tblockedAdds"
+			<< "\tlossFraction\tlatencyP99Ms\tsaturation\n";
+	curve.flush();
+	LOG4CXX_INFO(logger, "Load ramp (" << (definition.mode == RAMP_STEP ? "step" : "linear") << ") from "
+			<< definition.startRate << " EventIDs/s, +" << definition.rateIncrease
+			<< (definition.mode == RAMP_STEP ? " per step" : " per second") << " up to " << definition.maxRate
+			<< " EventIDs/s, curve written to " << definition.outputFile);
+	return true;
+}
+
+void LoadRamp::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+double LoadRamp::GetTargetRate(TIME t)
+{
+	if (definition_.mode == RAMP_LINEAR)
+		return definition_.startRate + definition_.rateIncrease * (t.sec() - startTime_);
+
+	return definition_.startRate + definition_.rateIncrease * step;
+}
+
+void LoadRamp::NextStep()
+{
+	step++;
+}
+
+RAMP_DEFINITION_STRUCT LoadRamp::GetDefinition()
+{
+	return definition_;
+}
+
+bool LoadRamp::ReadReceiverStatistics(RECEIVER_STATISTICS_STRUCT *statistics)
+{
+	if (definition_.receiverStatistics.empty())
+		return false;
+
+	ifstream file(definition_.receiverStatistics.c_str());
+
+	file >> statistics->messages >> statistics->lost >> statistics->latencyP99;
+	return !file.fail();
+}
+
+bool LoadRamp::AddWindow(RAMP_WINDOW_STRUCT window)
+{
+	ostringstream saturation;
+
+	// Every limit which is exceeded is listed, so the curve tells what gave in first
+	if (definition_.mode == RAMP_STEP && window.sentRate < (1 - definition_.maxDeviation) * window.targetRate)
+		saturation << "rate,";
+	if (window.lateFraction > definition_.maxLate)
+		saturation << "late,";
+	if (window.droppedEvents > 0)
+		saturation << "dropped,";
+	if (window.receiverValid && window.lossFraction > definition_.maxLoss)
+		saturation << "loss,";
+
+	curve << std::fixed << std::setprecision(1) << window.targetRate << "\t" << window.sentRate
+			<< "\t" << std::setprecision(6) << window.lateFraction
+			<< "\t" << std::setprecision(3) << window.meanLateness.millisec() << "\t" << window.maxLateness.millisec()
+			<< "\t" << window.droppedEvents << "\t" << window.blockedAdds;
+
+	if (window.receiverValid)
+		curve << "\t" << std::setprecision(6) << window.lossFraction << "\t" << std::setprecision(3)
+				<< window.latencyP99.millisec();
+	else
+		curve << "\t-\t-";
+
+	curve << "\t" << (saturation.str().empty() ? "-" : saturation.str().substr(0, saturation.str().size() - 1)) << "\n";
+	curve.flush();
+
+	if (!saturation.str().empty())
+	{
+		kneeFound = true;
+		LOG4CXX_INFO(logger, "Receiver saturated at " << window.targetRate << " EventIDs/s (sent " << window.sentRate
+				<< "/s): " << saturation.str().substr(0, saturation.str().size() - 1));
+		return false;
+	}
+
+	knee = window;
+	windowPassed = true;
+	LOG4CXX_INFO(logger, "Ramp window passed at " << window.targetRate << " EventIDs/s (sent " << window.sentRate
+			<< "/s, " << window.lateFraction * 100 << "% late)");
+	return true;
+}
+
+void LoadRamp::Finish()
+{
+	curve.close();
+
+	if (!windowPassed)
+	{
+		LOG4CXX_INFO(logger, "Receiver saturated already at the start rate of " << definition_.startRate << " EventIDs/s");
+	}
+	else if (kneeFound)
+	{
+		LOG4CXX_INFO(logger, "Knee at " << knee.sentRate << " EventIDs/s (target " << knee.targetRate
+				<< "/s, mean lateness " << knee.meanLateness.millisec() << "ms)");
+	}
+	else
+		LOG4CXX_INFO(logger, "No saturation up to " << knee.sentRate << " EventIDs/s (ramp-MaxRate reached)");
+}
@@ -0,0 +1,91 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include "rateController.hh"
+
+/**
+ * \class LoadRamp
+ * This class runs the schedule of a load ramp which searches the EventID rate at which a receiver saturates (the knee).
+ *
+ * The target rate of the target-rate controller is increased in steps, each measured after a settling time, or
+ * linearly with back-to-back windows. Every window becomes a point of the rate/latency curve. The ramp ends at the first
+ * window in which the sender falls short of the target (step mode only, the controller trails a linear ramp), sends too
+ * many EventIDs late (e.g. TCP backpressure), drops EventIDs, or the cooperating receiver reports too much loss. The
+ * last window before it is the knee.
+ */
+class LoadRamp {
+public:
+	/**
+	 * Initialising the ramp and writing the header of the curve
+	 * @param definition The schedule and the saturation limits
+	 * @param startTime The time the ramp starts
+	 * @return false if the output file could not be opened
+	 */
+	bool Init(RAMP_DEFINITION_STRUCT definition, TIME startTime);
+	/**
+	 * Initialising logging in LoadRamp class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Obtain the target rate at a given time
+	 * @param t The (absolute) time
+	 * @return The target rate [1/s] of the current step, or of the linear ramp at time t
+	 */
+	double GetTargetRate(TIME t);
+	/**
+	 * Moving on to the next step (step mode only)
+	 */
+	void NextStep();
+	/**
+	 * Obtain the definition of the ramp
+	 * @return The schedule and the saturation limits
+	 */
+	RAMP_DEFINITION_STRUCT GetDefinition();
+	/**
+	 * Reading the statistics file of the cooperating receiver
+	 * @param statistics Pointer to which the statistics are written
+	 * @return false if no statistics file is given or it could not be read
+	 */
+	bool ReadReceiverStatistics(RECEIVER_STATISTICS_STRUCT *statistics);
+	/**
+	 * Adding a measured window to the curve and checking it against the saturation limits
+	 * @param window The measurements of the window
+	 * @return false if the receiver is saturated, i.e. the knee has been passed
+	 */
+	bool AddWindow(RAMP_WINDOW_STRUCT window);
+	/**
+	 * Finishing the curve and reporting the knee
+	 */
+	void Finish();
+private:
+	RAMP_DEFINITION_STRUCT definition_;	/** Schedule and saturation limits */
+	double startTime_;					/** Absolute start time [s] of the ramp */
+	unsigned int step;					/** Current step (step mode) */
+	bool kneeFound;						/** A window has exceeded the saturation limits */
+	bool windowPassed;					/** At least one window was within the limits */
+	RAMP_WINDOW_STRUCT knee;			/** Last window within the limits */
+	ofstream curve;						/** The rate/latency curve */
+	log4cxx::LoggerPtr logger;			/** Pointer to LoggerPtr class */
+};
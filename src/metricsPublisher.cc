@@ -0,0 +1,240 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "metricsPublisher.hh"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool MetricsPublisher::Init(string target, METRICS_FORMAT format, EventCounters *counters, EventRouter *router,
+		ReadMsc *readMsc, TIME startTime)
+{
+	counters_ = counters;
+	router_ = router;
+	readMsc_ = readMsc;
+	format_ = format;
+	lastTime = startTime;
+	unixSocket = NULL;
+
+	if (target.find("file:") == 0)
+		socketTarget = false;
+	else if (target.find("unix:") == 0)
+		socketTarget = true;
+	else
+	{
+		LOG4CXX_ERROR(logger, "Metrics target " << target << " must start with file: or unix:");
+		return false;
+	}
+
+	path = target.substr(5);
+	counters_->GetSnapshot(&lastCounters);
+	LOG4CXX_DEBUG(logger, "Publishing metrics to " << (socketTarget ? "Unix domain socket " : "file ") << path);
+	return true;
+}
+
+void MetricsPublisher::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+bool MetricsPublisher::Publish(TIME t)
+{
+	ostringstream snapshot;
+	COUNTER_VECTOR current;
+	EVENT_QUEUE_STATISTICS_STRUCT queueStatistics;
+	METRIC_VECTOR useCaseTotal, useCaseRate, primitiveTotal, primitiveRate, noiseTotal, noiseRate, lateness,
+			destinationDepth;
+	map <PRIMITIVE_NAME, unsigned long long> primitiveCount, primitiveDelta;
+	map <PRIMITIVE_NAME, unsigned long long>::iterator it;
+	unsigned long long total = 0, totalDelta = 0;
+	double interval = t.sec() - lastTime.sec();
+
+	if (interval <= 0)
+		interval = 1;
+
+	counters_->GetSnapshot(&current);
+	router_->GetStatistics(&queueStatistics, false, STATISTICS_RATE_LOG);
+
+	for (USE_CASE_ID useCaseId = 1; useCaseId <= counters_->GetNumOfUseCases(); useCaseId++)
+	{
+		unsigned long long count = 0, delta = 0;
+		ostringstream label;
+		label << useCaseId;
+
+		for (unsigned int i = counters_->GetUseCaseOffset(useCaseId); i < counters_->GetUseCaseOffset(useCaseId + 1); i++)
+		{
+			PRIMITIVE_NAME primitive = readMsc_->GetParticularCommunicationDescription(useCaseId,
+					i - counters_->GetUseCaseOffset(useCaseId)).primitiveName;
+			count += current[i];
+			delta += current[i] - lastCounters[i];
+			primitiveCount[primitive] += current[i];
+			primitiveDelta[primitive] += current[i] - lastCounters[i];
+		}
+
+		total += count;
+		totalDelta += delta;
+		useCaseTotal.push_back(METRIC_PAIR (label.str(), count));
+		useCaseRate.push_back(METRIC_PAIR (label.str(), delta / interval));
+	}
+
+	for (it = primitiveCount.begin(); it != primitiveCount.end(); it++)
+	{
+		primitiveTotal.push_back(METRIC_PAIR (it->first, it->second));
+		primitiveRate.push_back(METRIC_PAIR (it->first, primitiveDelta[it->first] / interval));
+	}
+
+	for (unsigned int n = 0; n < counters_->GetNumOfNoiseSources(); n++)
+	{
+		unsigned int i = counters_->GetNoiseSourceOffset() + n;
+		ostringstream label;
+
+		if (n == 0)
+			label << "uncorrelated";
+		else
+			label << "correlated" << n - 1;
+
+		total += current[i];
+		totalDelta += current[i] - lastCounters[i];
+		noiseTotal.push_back(METRIC_PAIR (label.str(), current[i]));
+		noiseRate.push_back(METRIC_PAIR (label.str(), (current[i] - lastCounters[i]) / interval));
+	}
+
+	// Per destination queue depth, only with more than one destination
+	for (unsigned int d = 0; router_->GetNumOfDestinations() > 1 && d < router_->GetNumOfDestinations(); d++)
+	{
+		EVENT_QUEUE_STATISTICS_STRUCT destinationStatistics;
+		ostringstream label;
+
+		label << d;
+		router_->GetQueue(d)->GetStatistics(&destinationStatistics, false, STATISTICS_RATE_LOG);
+		destinationDepth.push_back(METRIC_PAIR (label.str(), destinationStatistics.entries));
+	}
+
+	lateness.push_back(METRIC_PAIR ("current", queueStatistics.currentLateness.sec()));
+	lateness.push_back(METRIC_PAIR ("mean", queueStatistics.meanLateness.sec()));
+	lateness.push_back(METRIC_PAIR ("max", queueStatistics.maxLateness.sec()));
+
+	if (format_ == METRICS_LINE)
+		snapshot << "time=" << std::setprecision(20) << t.sec();
+
+	snapshot << std::setprecision(PRECISION);
+	AddMetric(snapshot, "openmsc_events_sent_total", "counter", total);
+	AddMetric(snapshot, "openmsc_event_rate", "gauge", totalDelta / interval);
+	AddMetrics(snapshot, "openmsc_use_case_events_sent_total", "counter", "use_case", useCaseTotal);
+	AddMetrics(snapshot, "openmsc_use_case_event_rate", "gauge", "use_case", useCaseRate);
+	AddMetrics(snapshot, "openmsc_primitive_events_sent_total", "counter", "primitive", primitiveTotal);
+	AddMetrics(snapshot, "openmsc_primitive_event_rate", "gauge", "primitive", primitiveRate);
+	AddMetrics(snapshot, "openmsc_noise_events_sent_total", "counter", "source", noiseTotal);
+	AddMetrics(snapshot, "openmsc_noise_event_rate", "gauge", "source", noiseRate);
+	AddMetric(snapshot, "openmsc_queue_depth", "gauge", queueStatistics.entries);
+	AddMetrics(snapshot, "openmsc_destination_queue_depth", "gauge", "destination", destinationDepth);
+	AddMetrics(snapshot, "openmsc_lateness_seconds", "gauge", "stat", lateness);
+	AddMetric(snapshot, "openmsc_late_events_total", "counter", queueStatistics.lateEvents);
+	AddMetric(snapshot, "openmsc_dropped_events_total", "counter", queueStatistics.droppedEvents);
+	AddMetric(snapshot, "openmsc_blocked_adds_total", "counter", queueStatistics.blockedAdds);
+
+	if (format_ == METRICS_LINE)
+		snapshot << "\n";
+
+	lastCounters = current;
+	lastTime = t;
+	return Write(snapshot.str());
+}
+
+void MetricsPublisher::AddMetric(ostringstream &snapshot, string name, string type, double value)
+{
+	// openmsc_ prefix is dropped to keep the lines short
+	if (format_ == METRICS_LINE)
+		snapshot << " " << name.substr(8) << "=" << value;
+	else
+		snapshot << "# TYPE " << name << " " << type << "\n" << name << " " << value << "\n";
+}
+
+void MetricsPublisher::AddMetrics(ostringstream &snapshot, string name, string type, string labelName,
+		const METRIC_VECTOR &metrics)
+{
+	if (format_ == METRICS_PROMETHEUS && !metrics.empty())
+		snapshot << "# TYPE " << name << " " << type << "\n";
+
+	for (unsigned int i = 0; i < metrics.size(); i++)
+	{
+		if (format_ == METRICS_LINE)
+			snapshot << " " << name.substr(8) << "." << metrics.at(i).first << "=" << metrics.at(i).second;
+		else
+			snapshot << name << "{" << labelName << "=\"" << metrics.at(i).first << "\"} " << metrics.at(i).second << "\n";
+	}
+}
+
+bool MetricsPublisher::Write(const string &snapshot)
+{
+	if (!socketTarget)
+	{
+		// Writing to a temporary file first, so readers never see a partial snapshot
+		string tmpPath = path + ".tmp";
+		ofstream file(tmpPath.c_str(), ios::trunc);
+
+		if (!file.is_open())
+		{
+			LOG4CXX_ERROR(logger, "Metrics file " << tmpPath << " could not be opened");
+			return false;
+		}
+
+		file << snapshot;
+		file.close();
+
+		if (rename(tmpPath.c_str(), path.c_str()) != 0)
+		{
+			LOG4CXX_ERROR(logger, "Metrics file " << tmpPath << " could not be renamed to " << path);
+			return false;
+		}
+
+		return true;
+	}
+	// (Re-)connecting to the Unix domain socket - the receiving side might come and go
+	if (unixSocket == NULL)
+	{
+		boost::system::error_code ec;
+		unixSocket = new boost::asio::local::stream_protocol::socket(ioService);
+		unixSocket->connect(boost::asio::local::stream_protocol::endpoint(path), ec);
+
+		if (ec)
+		{
+			LOG4CXX_DEBUG(logger, "Metrics socket " << path << " not available: " << ec.message());
+			delete unixSocket;
+			unixSocket = NULL;
+			return false;
+		}
+	}
+
+	boost::system::error_code ec;
+	boost::asio::write(*unixSocket, boost::asio::buffer(snapshot), ec);
+
+	if (ec)
+	{
+		LOG4CXX_DEBUG(logger, "Metrics socket " << path << " closed: " << ec.message());
+		delete unixSocket;
+		unixSocket = NULL;
+		return false;
+	}
+
+	return true;
+}
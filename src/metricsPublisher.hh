@@ -0,0 +1,95 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include "eventCounters.hh"
+
+/**
+ * \class MetricsPublisher
+ * This class writes periodic snapshots of the EventID counters and the eventQueue statistics for headless operation.
+ *
+ * A snapshot holds the total, per use-case, per primitive and per noise source counters together with their rates since
+ * the previous snapshot, the queue depth (in total and per destination) and the send lateness. It is either written to a file (replaced atomically,
+ * so it can be picked up by the Prometheus node exporter textfile collector) or to a Unix domain stream socket.
+ */
+class MetricsPublisher {
+public:
+	/**
+	 * Initialising the publisher
+	 * @param target Either file:<PATH> or unix:<PATH>
+	 * @param format The format of the snapshots
+	 * @param counters Pointer to the EventID counters of the sender
+	 * @param router Pointer to the eventRouter holding the event queues of all destinations
+	 * @param readMsc Pointer to the ReadMsc class to label use-cases and primitives
+	 * @param startTime The time the counters have started
+	 * @return false if the target could not be parsed
+	 */
+	bool Init(string target, METRICS_FORMAT format, EventCounters *counters, EventRouter *router, ReadMsc *readMsc,
+			TIME startTime);
+	/**
+	 * Initialising logging in MetricsPublisher class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Taking a snapshot and writing it to the target
+	 * @param t The current time
+	 * @return false if the snapshot could not be written
+	 */
+	bool Publish(TIME t);
+private:
+	/**
+	 * Adding a metric without label to the snapshot
+	 * @param snapshot The snapshot
+	 * @param name The name of the metric
+	 * @param type The Prometheus type of the metric (counter or gauge)
+	 * @param value The value of the metric
+	 */
+	void AddMetric(ostringstream &snapshot, string name, string type, double value);
+	/**
+	 * Adding a metric family with one label to the snapshot
+	 * @param snapshot The snapshot
+	 * @param name The name of the metric
+	 * @param type The Prometheus type of the metric (counter or gauge)
+	 * @param labelName The name of the label
+	 * @param metrics The label values and the corresponding values of the metric
+	 */
+	void AddMetrics(ostringstream &snapshot, string name, string type, string labelName, const METRIC_VECTOR &metrics);
+	/**
+	 * Writing the snapshot to the target
+	 * @param snapshot The snapshot
+	 * @return false if writing failed
+	 */
+	bool Write(const string &snapshot);
+	EventCounters *counters_;					/** EventID counters of the sender */
+	EventRouter *router_;						/** The event queues of all destinations */
+	ReadMsc *readMsc_;							/** Use-case and primitive names */
+	METRICS_FORMAT format_;						/** Format of the snapshots */
+	string path;								/** Path of the file or the Unix domain socket */
+	bool socketTarget;							/** Writing to a Unix domain socket instead of a file */
+	COUNTER_VECTOR lastCounters;				/** Counters of the previous snapshot */
+	TIME lastTime;								/** Time of the previous snapshot */
+	boost::asio::io_service ioService;			/** io_service of the Unix domain socket */
+	boost::asio::local::stream_protocol::socket *unixSocket;	/** Connection to the Unix domain socket (NULL if not connected) */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
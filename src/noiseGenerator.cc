@@ -0,0 +1,169 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/random/linear_congruential.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <boost/random/exponential_distribution.hpp>
+#include <math.h>
+#include "noiseGenerator.hh"
+
+void NoiseGenerator::Init(CORRELATED_NOISE_DESCRIPTION_STRUCT noiseDescr, int seed, TIME startTime)
+{
+	noiseDescr_ = noiseDescr;
+	generator.seed(seed);
+	// A separate stream, otherwise the EventID drawn would follow from the neighbouring inter-arrival time
+	eventIdGen.seed(generator());
+	cursor = startTime.sec();
+	mmppState = 0;
+	mmppStateEnd = cursor;
+	hawkesExcitation = 0.0;
+	noiseEventIds.clear();
+
+	for (int i = noiseDescr_.eventIdRangeMin; i <= noiseDescr_.eventIdRangeMax; i++)
+	{
+		ostringstream convert;
+		convert << i;
+		noiseEventIds.push_back(convert.str());
+	}
+
+	if (noiseDescr_.process == MMPP)
+	{
+		boost::exponential_distribution<> exp_dist (1.0 / noiseDescr_.mmppSojournTimes.at(0));
+		boost::variate_generator<base_generator_type&, boost::exponential_distribution<> > sojourn (generator, exp_dist);
+		mmppStateEnd = cursor + sojourn();
+	}
+}
+
+void NoiseGenerator::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+TIME NoiseGenerator::GetBatchInterval()
+{
+	return noiseDescr_.batchInterval;
+}
+
+EVENT_ID NoiseGenerator::DrawEventId()
+{
+	boost::uniform_int<> uni_dist_int (0, noiseEventIds.size() - 1);
+	boost::variate_generator<base_generator_type&, boost::uniform_int<> > uni_int (eventIdGen, uni_dist_int);
+
+	return noiseEventIds.at(uni_int());
+}
+
+int NoiseGenerator::DrawNextMmppState()
+{
+	if (noiseDescr_.mmppTransitions.empty())
+		return (mmppState + 1) % noiseDescr_.mmppRates.size();
+
+	const vector <double> &row = noiseDescr_.mmppTransitions.at(mmppState);
+	boost::uniform_01<base_generator_type&> uniform (generator);
+	double u = uniform();
+	int state = 0;
+
+	// Rounding may leave u above the sum of the row, the last state with a probability > 0 is taken then
+	for (unsigned int j = 0; j < row.size(); j++)
+	{
+		if (row.at(j) > 0)
+			state = j;
+		if (u < row.at(j))
+			return j;
+		u -= row.at(j);
+	}
+	return state;
+}
+
+int NoiseGenerator::GenerateBatch(TIME end, TIME_EVENT_ID_PAIR_VECTOR *batch)
+{
+	// Unit-rate exponential and uniform variates which get scaled to the current intensity
+	boost::exponential_distribution<> exp_dist (1.0);
+	boost::variate_generator<base_generator_type&, boost::exponential_distribution<> > exponential (generator, exp_dist);
+	boost::uniform_01<base_generator_type&> uniform (generator);
+	double endSec = end.sec();
+	int count = 0;
+
+	if (noiseDescr_.process == MMPP)
+	{
+		// Within a state the arrivals are homogeneous Poisson. Candidates crossing the end of the state or the end of
+		// this batch are discarded, which is exact because the exponential distribution is memoryless.
+		while (cursor < endSec)
+		{
+			double boundary = (mmppStateEnd < endSec) ? mmppStateEnd : endSec;
+			double rate = noiseDescr_.mmppRates.at(mmppState);
+			double candidate = (rate > 0) ? cursor + exponential() / rate : boundary;
+
+			if (candidate < boundary)
+			{
+				cursor = candidate;
+				batch->push_back(TIME_EVENT_ID_PAIR (TIME(cursor, "sec"), DrawEventId()));
+				count++;
+			}
+			else
+			{
+				cursor = boundary;
+
+				if (boundary == mmppStateEnd)
+				{
+					mmppState = DrawNextMmppState();
+					mmppStateEnd = cursor + exponential() * noiseDescr_.mmppSojournTimes.at(mmppState);
+					LOG4CXX_DEBUG(logger, "MMPP noise source switched to state " << mmppState
+							<< " (rate = " << noiseDescr_.mmppRates.at(mmppState) << "/s) for "
+							<< mmppStateEnd - cursor << "s");
+				}
+			}
+		}
+	}
+	else if (noiseDescr_.process == HAWKES)
+	{
+		// Ogata's thinning: the intensity only decays between arrivals, so its value right after the cursor is an
+		// upper bound until the next accepted arrival
+		while (cursor < endSec)
+		{
+			double lambdaBar = noiseDescr_.hawkesBaseRate + hawkesExcitation;
+			double candidate = cursor + exponential() / lambdaBar;
+
+			if (candidate >= endSec)
+				candidate = endSec;
+
+			hawkesExcitation *= exp(-noiseDescr_.hawkesDecay * (candidate - cursor));
+			cursor = candidate;
+
+			if (candidate >= endSec)
+				break;
+
+			if (uniform() * lambdaBar <= noiseDescr_.hawkesBaseRate + hawkesExcitation)
+			{
+				batch->push_back(TIME_EVENT_ID_PAIR (TIME(cursor, "sec"), DrawEventId()));
+				hawkesExcitation += noiseDescr_.hawkesExcitation * noiseDescr_.hawkesDecay;
+				count++;
+			}
+		}
+	}
+	else
+		LOG4CXX_ERROR(logger, "Correlated noise process " << noiseDescr_.process << " has not been implemented");
+
+	LOG4CXX_TRACE(logger, count << " correlated noise EventIDs generated up to " << std::setprecision(20) << endSec);
+	return count;
+}
@@ -0,0 +1,83 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventIdGenerator.hh"
+
+/**
+ * \class NoiseGenerator
+ * This class generates correlated (bursty) noise EventIDs for a single noise source defined in openmsc.cfg.
+ *
+ * Two processes are available: a Markov-modulated Poisson process (MMPP) switching between states with different
+ * rates, either cyclically or according to a transition probability matrix, and a self-exciting Hawkes process with an exponential kernel. Arrival times are generated window by window
+ * so that the caller can insert a whole batch into the eventMap with a single lock.
+ */
+class NoiseGenerator {
+public:
+	/**
+	 * Initialising the noise source
+	 * @param noiseDescr The noise source description read from openmsc.cfg
+	 * @param seed Seed for the random number generator
+	 * @param startTime The time at which the process starts
+	 * @return void
+	 */
+	void Init(CORRELATED_NOISE_DESCRIPTION_STRUCT noiseDescr, int seed, TIME startTime);
+	/**
+	 * Initialising logging in NoiseGenerator class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Generate all noise EventIDs from the end of the previous batch up to the given time. The process state is kept, so
+	 * consecutive calls produce a single continuous realisation of the process.
+	 *
+	 * @param end The time up to which arrivals are generated
+	 * @param batch Pointer to the vector the (time-sorted) arrivals are appended to
+	 * @return The number of arrivals appended to batch
+	 */
+	int GenerateBatch(TIME end, TIME_EVENT_ID_PAIR_VECTOR *batch);
+	/**
+	 * Obtain the configured batch interval for this noise source
+	 * @return The length of the window which should be generated per call to GenerateBatch()
+	 */
+	TIME GetBatchInterval();
+private:
+	/**
+	 * Draw a noise EventID from the configured range
+	 * @return The noise EventID
+	 */
+	EVENT_ID DrawEventId();
+	/**
+	 * Draw the state the MMPP goes to when leaving the current one
+	 * @return The next MMPP state
+	 */
+	int DrawNextMmppState();
+	CORRELATED_NOISE_DESCRIPTION_STRUCT noiseDescr_;	/** Copy of the noise source description */
+	EVENT_ID_VECTOR noiseEventIds;	/** Pre-computed string representations of the noise EventID range */
+	base_generator_type generator;	/** Generator for arrival times */
+	base_generator_type eventIdGen;	/** Generator for picking the EventID */
+	double cursor;					/** Time [s] up to which the process has been generated */
+	int mmppState;					/** Current state of the MMPP */
+	double mmppStateEnd;			/** Time [s] at which the current MMPP state is left */
+	double hawkesExcitation;		/** Current excitation of the Hawkes intensity above the base rate [1/s] */
+	log4cxx::LoggerPtr logger;		/** Pointer to LoggerPtr class */
+};
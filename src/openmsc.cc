@@ -28,6 +28,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <pthread.h>
+#include <signal.h>
 #include <unistd.h>
 #include <map>
 #include <argp.h>
@@ -39,7 +40,11 @@
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/gamma_distribution.hpp>
 #include <boost/thread/shared_mutex.hpp>
-#include "eventIdGenerator.hh"
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include "uringSender.hh"
+#include "wireFormat.hh"
+#include "shmRing.hh"
 #include <boost/asio.hpp>
 #include <libconfig.h++>
 #include <fstream>
@@ -65,34 +70,72 @@ namespace std {
 
 boost::shared_mutex _access;
 boost::condition_variable cond;
-boost::mutex mut, visualiserMapMutex;
 using boost::asio::ip::udp;
 using boost::asio::ip::tcp;
 int seed = 1,
 		numOfUesPerBs,
 		numOfBss,
 		visualiserWindowSize,	/** The size of the window of the visualiser in seconds*/
-		visualiserUpdateInterval = 0; /** The update interval of the visualiser in milliseconds. Default 0 (continuous plotting)*/
+		visualiserUpdateInterval = 0, /** The update interval of the visualiser in milliseconds. Default 0 (continuous plotting)*/
+		visualiserTimeBins = 0,	/** Number of time bins of the level-of-detail visualiser (0 = plot every EventID) */
+		visualiserIdBins = 256;	/** Maximal number of ID bins of the level-of-detail visualiser */
 unsigned int stopRate;	/** Number indicating after how many EvenIDs OpenMSC should stop sending and automatically ends*/
 float eventLogRateInterval; /** Interval in seconds used to print EventID rate to stdout using debug level INFO */
-DISTRIBUTION_DEFINITION_STRUCT ueDistDef;
+double ueProfilePeriod = 0,	/** Period of the UE activity rate profile in seconds (0 = not periodic) */
+		ueProfileTimeScale = 1;	/** Profile seconds per real second, e.g. 1440 plays a 24h profile in one minute */
+bool ueProfileInterpolate = true;	/** Linear interpolation between the points of the UE activity rate profile */
+TIME eventQueueLookahead = TIME(10, "millisec"),	/** How far ahead of the current time EventIDs can be added to the eventQueue */
+		lateTolerance = TIME(1, "millisec");	/** Lateness up to which an EventID is sent without applying the late event policy */
+unsigned int eventQueueMaxEntries = 1000000;	/** Maximal number of EventIDs in the eventQueue (0 = unbounded) */
+LATE_EVENT_POLICY lateEventPolicy = LATE_SEND;	/** What the sender does with late EventIDs */
+GENERATOR_DEFINITION_STRUCT generatorDefinition;	/** UE population and activity read from openmsc.cfg */
+PatternGenerator patternGenerator;	/** Generator of the pattern EventIDs carried out by the UE population */
 NOISE_DESCRIPTION_STRUCT noiseDescrStruct;
-EVENT_MAP eventMap, visualiserMap;
-EVENT_TIMER_MAP eventTimerMap;
+CORRELATED_NOISE_DESCRIPTION_VECTOR correlatedNoiseDescrVector;	/** All correlated noise sources declared in openmsc.cfg */
+RateProfile rateProfile;	/** Time-varying UE activity profile (optional) */
+EventRing *visualiserRings;	/** EventIDs sent, handed from the sender threads to the visualiser (one ring per destination) */
+EventRouter eventRouter;	/** Bounded queues of EventIDs between the generators and the sender threads, one per destination */
+DESTINATION_VECTOR destinations;	/** Receiving modules the EventIDs are sent to */
+PARTITION destinationPartition = PARTITION_BS;	/** How the EventIDs are distributed over the destinations */
+boost::atomic<unsigned int> sentEventIds(0);	/** EventIDs sent by all sender threads */
+EventCounters eventCounters;	/** EventIDs sent per communication descriptor and noise source */
+string metricsTarget;	/** file:<PATH> or unix:<PATH> the metrics snapshots are written to */
+METRICS_FORMAT metricsFormat = METRICS_PROMETHEUS;	/** Format of the metrics snapshots */
+TIME metricsInterval = TIME(1, "sec");	/** Interval between two metrics snapshots */
+string controlSocketPath;	/** Path of the Unix domain socket accepting runtime commands */
+ControlSocket controlSocket;	/** Runtime changes of UE activity, population and noise sources */
+double targetRate = 0,	/** EventID rate [1/s] the UE activity is adjusted to (--target-rate) */
+		targetRateTolerance = 0.02,	/** Relative deviation from the target rate counting as on target */
+		targetRateKp = 0.3,	/** Proportional gain of the target-rate controller */
+		targetRateKi = 0.5,	/** Integral gain [1/s] of the target-rate controller */
+		targetRateMaxActivity = 1000;	/** Bounds of the UE activity scale, 1/x to x */
+TIME targetRateInterval = TIME(1, "sec");	/** Interval over which the EventID rate is measured */
+RAMP_DEFINITION_STRUCT rampDefinition;	/** Schedule and saturation limits of the load ramp (--ramp) */
 HASHED_NOISE_EVENT_ID_MAP hashedNoiseEventIdMap;
 ReadMsc readMsc;
 EventIdGenerator eventIdGenerator;
 Dictionary dictionary;
 IP_ADDRESS ipAddress;
 PORT port;
+string shmName;	/** Name of the shared memory segment in /dev/shm the EventIDs are published to (-S) */
 bool TCP = false,
 UDP = true,
+SHM = false,
+URING = false,
 streamToFileFlag = false,
+LABELS_TO_FILE = false,
 PRINT_EVENT_ID_RATE = false,
 AUTOMATICALLY_STOP_SENDING = false,
 VISUALISER=false,
+VISUALISER_HEATMAP = false,
+WIRE_STAMPED = false,
 ENABLE_NOISE,
-CD_OVERLAP;
+ENABLE_CORRELATED_NOISE,
+RATE_PROFILE = false,
+ENABLE_METRICS = false,
+ENABLE_CONTROL = false,
+TARGET_RATE = false,
+LOAD_RAMP = false;
 const int MAX_INT = std::numeric_limits<int>::max();
 // log4cxx
 log4cxx::FileAppender * fileAppender = new log4cxx::FileAppender(log4cxx::LayoutPtr(new log4cxx::SimpleLayout()), "openmsc.log", false);
@@ -139,10 +182,20 @@ static int parse_opt (
 		break;
 	}
 	case 'p':
+		if (*arg == '\0')
+		{
+			LOG4CXX_ERROR(logger, "No destination port provided");
+			return(EXIT_FAILURE);
+		}
 		port = arg;
 		LOG4CXX_INFO(logger,"Destination port is set to " << port);
 		break;
 	case 'i':
+		if (*arg == '\0')
+		{
+			LOG4CXX_ERROR(logger, "No destination IP provided");
+			return(EXIT_FAILURE);
+		}
 		ipAddress = arg;
 		LOG4CXX_INFO(logger,"Destination IP is set to " << ipAddress);
 		break;
@@ -155,11 +208,31 @@ static int parse_opt (
 		LOG4CXX_INFO(logger, "Writing Stream to file");
 		streamToFileFlag = true;
 		break;
+	case 'L':
+		LOG4CXX_INFO(logger, "Writing stream and its ground-truth labels to file");
+		streamToFileFlag = true;
+		LABELS_TO_FILE = true;
+		break;
 	case 'u':
 		LOG4CXX_INFO(logger, "Enabling UDP communication");
 		UDP = true;
 		TCP = false;
 		break;
+	case 'U':
+#ifdef HAVE_LIBURING
+		LOG4CXX_INFO(logger, "Sending through io_uring");
+		URING = true;
+#else
+		LOG4CXX_ERROR(logger, "OpenMSC has been compiled without io_uring support (make URING=1), using boost::asio");
+#endif
+		break;
+	case 'S':
+		LOG4CXX_INFO(logger, "Enabling shared memory output to /dev/shm/" << arg);
+		shmName = arg;
+		SHM = true;
+		UDP = false;
+		TCP = false;
+		break;
 	case 'r':
 		PRINT_EVENT_ID_RATE=true;
 		eventLogRateInterval = atof(arg);
@@ -179,15 +252,154 @@ static int parse_opt (
 		visualiserUpdateInterval = atoi(arg);
 		LOG4CXX_INFO(logger, "Update interval for visualiser set to = " << visualiserUpdateInterval);
 		break;
+	case 'b':
+	{
+		const char *idBins = strchr(arg, 'x');
+		visualiserTimeBins = atoi(arg);
+		if (idBins != NULL)
+			visualiserIdBins = atoi(idBins + 1);
+		if (visualiserTimeBins <= 0 || visualiserIdBins <= 0)
+		{
+			LOG4CXX_ERROR(logger, "Level-of-detail bins must be given as <TIME BINS>[x<ID BINS>]");
+			return(EXIT_FAILURE);
+		}
+		LOG4CXX_INFO(logger, "Level-of-detail visualiser with " << visualiserTimeBins << "x" << visualiserIdBins << " bins");
+		break;
+	}
+	case 'm':
+		VISUALISER_HEATMAP = true;
+		LOG4CXX_INFO(logger, "Level-of-detail visualiser plots a density heatmap");
+		break;
+	case 'D':
+	{
+		string list(arg), item;
+		istringstream listStream(list);
+
+		while (getline(listStream, item, ','))
+		{
+			DESTINATION_STRUCT destination;
+			size_t colon = item.rfind(':');
+
+			if (colon == string::npos || colon == 0 || colon + 1 == item.length())
+			{
+				LOG4CXX_ERROR(logger, "Destination '" << item << "' must be given as <IP>:<PORT>");
+				return(EXIT_FAILURE);
+			}
+			destination.ipAddress = item.substr(0, colon);
+			destination.port = item.substr(colon + 1);
+			destinations.push_back(destination);
+			LOG4CXX_INFO(logger, "Adding destination " << destination.ipAddress << ":" << destination.port);
+		}
+
+		if (destinations.empty() || destinations.size() > MAX_DESTINATIONS)
+		{
+			LOG4CXX_ERROR(logger, "Between 1 and " << MAX_DESTINATIONS << " destinations can be given");
+			return(EXIT_FAILURE);
+		}
+		break;
+	}
+	case 'P':
+		if (strcmp(arg, "bs") == 0)
+			destinationPartition = PARTITION_BS;
+		else if (strcmp(arg, "ue") == 0)
+			destinationPartition = PARTITION_UE;
+		else if (strcmp(arg, "usecase") == 0)
+			destinationPartition = PARTITION_USE_CASE;
+		else if (strcmp(arg, "rr") == 0)
+			destinationPartition = PARTITION_ROUND_ROBIN;
+		else
+		{
+			LOG4CXX_ERROR(logger, "Partition must be either 'bs', 'ue', 'usecase' or 'rr'");
+			return(EXIT_FAILURE);
+		}
+		LOG4CXX_INFO(logger, "Partitioning EventIDs by " << arg);
+		break;
+	case 'T':
+		targetRate = atof(arg);
+
+		if (targetRate <= 0)
+		{
+			LOG4CXX_ERROR(logger, "Target rate must be larger than 0 EventIDs/s");
+			return(EXIT_FAILURE);
+		}
+		TARGET_RATE = true;
+		LOG4CXX_INFO(logger, "Holding the EventID rate at " << targetRate << "/s");
+		break;
+	case 'R':
+		LOAD_RAMP = true;
+		LOG4CXX_INFO(logger, "Running the load ramp of openmsc.cfg until the receiver saturates");
+		break;
+	case 'x':
+		WIRE_STAMPED = true;
+		LOG4CXX_INFO(logger, "Stamping EventIDs with sequence number, scheduled and send time");
+		break;
 	}
 
 	return 0;
 }
 
+/**
+ * Adding an EventID to the eventQueue of its destination
+ *
+ * The EventID is stored at the next free time at or after t. Blocks while the eventQueue of the destination is full.
+ *
+ * @param t The time at which the EventID should be sent
+ * @param eventId The EventID
+ * @param useCaseId The use-case the EventID belongs to (0 for noise)
+ * @param step The communication descriptor the EventID belongs to
+ * @param noiseSource The noise source which generated the EventID, -1 for pattern EventIDs
+ * @param bs The base-station which triggered the EventID (0 for noise)
+ * @param ue The UE which triggered the EventID (0 for noise)
+ * @return The time at which the EventID has been stored
+ */
+TIME addEventId(TIME t, EVENT_ID eventId, USE_CASE_ID useCaseId, int step, short noiseSource, BS_ID bs, UE_ID ue)
+{
+	EVENT_STRUCT event;
+
+	event.eventId = eventId;
+	event.useCaseId = useCaseId;
+	event.step = step;
+	event.noiseSource = noiseSource;
+	event.bsId = bs;
+	event.ueId = ue;
+	event.procedure = 0;
+	return eventRouter.Add(t, event);
+}
+/**
+ * Routing a pattern EventID to the eventQueue of its destination
+ *
+ * @param event The EventID and the time at which it should be sent
+ * @param context Unused
+ */
+void routeEventId(const TIME_EVENT_PAIR &event, void *context)
+{
+	eventRouter.Add(event.first, event.second);
+}
+/**
+ * Writing the ground truth of an EventID to the label file (-L)
+ *
+ * Pattern EventIDs are labelled 'pattern <BS> <UE> <use-case instance> <use-case> <communication descriptor>', where
+ * BS, UE and instance identify the use-case instance. Noise EventIDs are labelled 'noise <noise source>', 0 being the
+ * uncorrelated noise and i + 1 the correlated noise source i. Like the stream line the label line is flushed right away,
+ * so both files end at the same EventID when another sender terminates OpenMSC.
+ *
+ * @param file The label file
+ * @param event The EventID which has just been written to the stream file
+ */
+void writeLabel(ofstream &file, const EVENT_STRUCT &event)
+{
+	if (event.noiseSource >= 0)
+		file << "noise\t" << event.noiseSource << endl;
+	else
+		file << "pattern\t" << event.bsId << "\t" << event.ueId << "\t" << event.procedure << "\t" << event.useCaseId
+				<< "\t" << event.step << endl;
+}
 /**
  * Generating EventIDs
  *
- * This function generates a pair if TIME and EVENT_ID and adds it to the eventMap
+ * This function drives the PatternGenerator in real time: every round it carries out all UEs which are due within the
+ * lookahead of the eventQueue, routing their EventIDs to the eventQueues of the destinations, and sleeps until the next
+ * UE is due. Changes requested through the control socket are taken over between two rounds.
  *
  * @param pointer to Thread Identifier
  * @return void
@@ -196,335 +408,61 @@ void *generateEventIds(void *t)
 {
 	boost::asio::io_service io_service;
 	boost::asio::deadline_timer timer(io_service);
-	base_generator_type generator(seed),
-			generatorComDescriptor(seed),
-			generatorUseCase(seed);
-	UE_ID ue;
-	BS_ID bs;
-	TIME remainingWaitingTime,
-		sTime,
-		currentTime,
+	TIME currentTime,
 		tvNsec,
 		tvSec;
-	EVENT_TIMER_MAP_IT eMapIt;
 	timespec ts;
+	unsigned int controlVersion = 0;
+	CONTROL_STATE_STRUCT requestedControlState;
 
 	eventIdGenerator.WritePatterns2File();
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tvNsec = TIME (ts.tv_nsec, "nanosec");
+	tvSec = TIME (ts.tv_sec, "sec");
+	currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
 
-	for (;;)
-	{
-		// Generate inital starting time for each UE using the distribution specified in the openmsc.cfg file
-		for (bs = 1; bs <= numOfBss; bs++)
-		{
-			for (ue = 1; ue <= numOfUesPerBs; ue++)
-			{
-				clock_gettime(CLOCK_REALTIME, &ts);
-				tvNsec = TIME (ts.tv_nsec, "nanosec");
-				tvSec = TIME (ts.tv_sec, "sec");
-				currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
-
-				if (ueDistDef.distribution == UNIFORM_REAL)
-				{
-					boost::uniform_real<> uni_dist_real (ueDistDef.uniformMin.sec(), ueDistDef.uniformMax.sec());
-					boost::variate_generator<base_generator_type&, boost::uniform_real<> > uni_real (generator, uni_dist_real);
-					sTime = TIME(uni_real(), "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is UNIFORM_REAL with min = "
-											<< ueDistDef.uniformMin.sec() << " and max = " << ueDistDef.uniformMax.sec()
-											<< "\tValue = " << sTime.sec());
-				}
-				else if (ueDistDef.distribution == UNIFORM_INTEGER)
-				{
-					boost::uniform_int<> uni_dist_int ((int)ueDistDef.uniformMin.sec(), (int)ueDistDef.uniformMax.sec());
-					boost::variate_generator<base_generator_type&, boost::uniform_int<> > uni_int (generator, uni_dist_int);
-					sTime = TIME(uni_int(), "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is UNIFORM_INT with Min = "
-											<< ueDistDef.uniformMin.sec() << " and Max = " << ueDistDef.uniformMax.sec()
-											<< "\tValue = " << sTime.sec());
-				}
-				else if (ueDistDef.distribution == EXPONENTIAL)
-				{
-					boost::exponential_distribution<> exp_dist (ueDistDef.exponentialLambda);
-					boost::variate_generator<base_generator_type&, boost::exponential_distribution<> > exponential (generator, exp_dist);
-					sTime = TIME(exponential(), "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is EXPONENTIAL with Lambda = "
-											<< ueDistDef.exponentialLambda
-											<< "\tValue = " << sTime.sec());
-				}
-				else if (ueDistDef.distribution == GAUSSIAN)
-				{
-					bool timePositive = false;	/** for the while loop to check if time returned by Boost library is positive */
-					float timeGaussian;
-					boost::normal_distribution<> gau_dist (ueDistDef.gaussianMu, ueDistDef.gaussianSigma);
-					boost::variate_generator<base_generator_type&, boost::normal_distribution<> > gaussian (generator, gau_dist);
-					while (timePositive)
-					{
-						timeGaussian = gaussian();
-						if (timeGaussian > 0)
-							timePositive = true;
-						else
-							LOG4CXX_INFO(logger, "Gaussian returned negative value ... request new value");
-					}
-					sTime = TIME(timeGaussian, "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is GAUSSIAN with Mu = " << ueDistDef.gaussianMu
-											<< " and Sigma = " << ueDistDef.gaussianSigma
-											<< "\tValue = " << sTime.sec());
-				}
-				else if (ueDistDef.distribution == GAMMA)
-				{
-					boost::gamma_distribution<> gamma_dist (ueDistDef.gammaAlpha, ueDistDef.gammaBeta);
-					boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > gamma (generator, gamma_dist);
-					sTime = TIME(gamma(), "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is GAMMA with Alpha = " << ueDistDef.gammaAlpha
-											<< " and Beta = " << ueDistDef.gammaBeta
-											<< "\tValue = " << sTime.sec());
-				}
-				else if (ueDistDef.distribution == ERLANG)
-				{
-					boost::gamma_distribution<> erlang_dist ((int)ueDistDef.erlangAlpha, (int)ueDistDef.erlangBeta);
-					boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > erlang (generator, erlang_dist);
-					sTime = TIME(erlang(), "sec");
-					LOG4CXX_TRACE(logger, "Starting time distribution is GAMMA with Alpha = " << (int)ueDistDef.gammaAlpha
-											<< " and Beta = " << (int)ueDistDef.gammaBeta
-											<< "\tValue = " << sTime.sec());
-				}
-				else
-				{
-					LOG4CXX_ERROR(logger, "This distribution has not been implemented to calculate UE arrival times");
-					pthread_exit(NULL);
-				}
-				bool newTimeFound = false;	// make sure the start time is unique - OpenMSC cannot handle UEs with the exact same starting time
+	if (RATE_PROFILE)
+		rateProfile.Init(currentTime, ueProfilePeriod, ueProfileTimeScale, ueProfileInterpolate);
 
-				while (newTimeFound == false)
-				{
-					if (eventTimerMap.find(TIME((currentTime.sec() + sTime.sec()), "sec")) == eventTimerMap.end())
-					{
-						LOG4CXX_DEBUG(logger, "Initial starting time for UE " << ue
-								<< " -> BS " << bs << " = " << std::setprecision(20) << (sTime.sec() + currentTime.sec())
-								<< " using distribution " << ueDistDef.distribution);
-						eventTimerMap.insert(pair <TIME,BS_UE_PAIR> (TIME(sTime.sec() + currentTime.sec(), "sec"), BS_UE_PAIR (bs,ue)));
-						newTimeFound = true;
-					}
-					else
-					{
-						TIME sTmp = TIME(1, "millisec");
-						sTime = TIME(sTime.sec() + sTmp.sec(), "sec");
-					}
-				}
-			}
-		}
+	if (!patternGenerator.Init(&eventIdGenerator, &readMsc, generatorDefinition, RATE_PROFILE ? &rateProfile : NULL,
+			currentTime))
+		pthread_exit(NULL);
 
-		eMapIt = eventTimerMap.begin();
+	for (;;)
+	{
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
 
-		while (eMapIt != eventTimerMap.end())
+		if (ENABLE_CONTROL && controlSocket.GetState(&controlVersion, &requestedControlState))
 		{
-			ostringstream convert;
-			USE_CASE_ID useCaseId;
-			eMapIt = eventTimerMap.begin();
-			ue = (*eMapIt).second.second;
-			bs = (*eMapIt).second.first;
-			clock_gettime(CLOCK_REALTIME, &ts);
-			tvNsec = TIME (ts.tv_nsec, "nanosec");
-			tvSec = TIME (ts.tv_sec, "sec");
-			currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+			if (!patternGenerator.ApplyControlState(requestedControlState, currentTime))
+				pthread_exit(NULL);
+			controlSocket.SetApplied(controlVersion);
+		}
 
-			if ((*eMapIt).first.sec() > currentTime.sec())
-			{
-				TIME tmpTime = TIME((*eMapIt).first.sec() - currentTime.sec(), "sec");
-				LOG4CXX_TRACE(logger, "Waiting " << std::setprecision(20) << tmpTime.sec()
-						<< "s before generating another communication description");
-				timer.expires_from_now(boost::posix_time::microseconds(tmpTime.microsec()));
-				timer.wait();
-			}
+		if (!patternGenerator.Generate(TIME(currentTime.nanosec() + eventRouter.GetLookahead().nanosec(), "nanosec"),
+				routeEventId, NULL))
+			pthread_exit(NULL);
+		// Sleep until the next UE is due
+		TIME nextActivation = patternGenerator.GetNextActivationTime();
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec() + eventRouter.GetLookahead().sec(), "sec");
 
-			clock_gettime(CLOCK_REALTIME, &ts);
-			tvNsec = TIME(ts.tv_nsec, "nanosec");
-			tvSec = TIME(ts.tv_sec, "sec");
-			TIME startingTimeForThisComDescr = TIME(tvSec.sec() + tvNsec.sec(), "sec");
-			TIME communicationDescriptorLength = TIME(0, "sec"); /** Sum up the total length for this communication descriptor.
-													Prevent new UE starting time to be before the end of the communication descriptor*/
-			EVENT_ID_VECTOR eventIdVectorPeriodic;
-			useCaseId = eventIdGenerator.DetermineUseCaseId(&generatorUseCase);
-			LOG4CXX_DEBUG(logger, "Use-Case ID for UE " << (*eMapIt).second.first << " - BS " << (*eMapIt).second.second << " = " << useCaseId);
-			for (int readMscIt = 0; readMscIt < readMsc.GetMscLength(useCaseId); readMscIt++)
-			{
-				EVENT_ID_VECTOR eventIdVector;
-				// use-case ID, step, base-station ID, UE ID
-				eventIdVector = eventIdGenerator.GetEventIdForComDescr(useCaseId, readMscIt,
-						(*eMapIt).second.first, (*eMapIt).second.second);
-				TIME latency;
-				TIME offset = TIME(0.0, "sec");
-				latency = eventIdGenerator.CalculateLatency(useCaseId, readMscIt, &generatorComDescriptor);
-				// iterate over vector (eventIdVector.size() > 1 if there was more than 1 IE in a particular primitive)
-				for (unsigned int i = 0; i < eventIdVector.size(); i++)
-				{
-					EVENT_ID eventId;
-					EVENT_MAP_IT it;
-					eventId = eventIdVector.at(i);
-					//Periodic communication descriptor - store it for next msc step, if this is NOT the last step
-					if (readMsc.GetPeriodicCommunicationDescriptorFlag(useCaseId,readMscIt))
-					{
-						eventIdVectorPeriodic = eventIdVector;
-					}
-					else
-					{
-						if (eventIdVectorPeriodic.size() > 0)
-						{
-							TIME latencyPeriodic,
-							periodicStartTime = TIME(startingTimeForThisComDescr.sec(), "sec");
-							// Generate as many periodic events as time is until the next '=>' communication descriptor
-							while ((periodicStartTime.sec() + offset.sec()) < (startingTimeForThisComDescr.sec() + latency.sec()))
-							{
-								latencyPeriodic = eventIdGenerator.CalculateLatency(useCaseId, readMscIt-1,
-										&generatorComDescriptor);
-								periodicStartTime = TIME(periodicStartTime.sec() + latencyPeriodic.sec(), "sec");
-								for (int eventIdVectorPeriodicIt = 0; eventIdVectorPeriodicIt < eventIdVectorPeriodic.size(); eventIdVectorPeriodicIt++)
-								{
-									mut.lock();
-									it = eventMap.begin();
-									// Finding spare time-slot in eventMap
-									while (it != eventMap.end())
-									{
-										it = eventMap.find(TIME(periodicStartTime.sec() + offset.sec(), "sec"));
-										if (it != eventMap.end())
-											offset = TIME(offset.millisec() + 1, "millisec");
-									}
-									// just make sure that the new time is still smaller than the starting time for the next comm descriptor
-									if ((periodicStartTime.sec() + offset.sec())
-											< (startingTimeForThisComDescr.sec() + latency.sec()))
-									{
-										eventMap.insert(TIME_EVENT_ID_PAIR (TIME(periodicStartTime.sec() + offset.sec(), "sec"),
-												eventIdVectorPeriodic.at(eventIdVectorPeriodicIt)));
-										LOG4CXX_TRACE (logger, "Adding periodic EventID "
-												<< eventIdVectorPeriodic.at(eventIdVectorPeriodicIt)
-												<< " at relative time " << setprecision(20) << periodicStartTime.sec() + offset.sec()
-												<< " to eventMap for use-case " << useCaseId << " and communication descriptor " << readMscIt-1);
-									}
-									mut.unlock();
-									if (VISUALISER)
-									{
-										visualiserMapMutex.lock();
-										visualiserMap.insert(TIME_EVENT_ID_PAIR (TIME(periodicStartTime.sec() + offset.sec(), "sec"),
-												eventIdVectorPeriodic.at(eventIdVectorPeriodicIt)));
-										visualiserMapMutex.unlock();
-									}
-								}
-								// get the same periodic EventID but with an updated IE value (in case it was not constant)
-								eventIdVectorPeriodic = eventIdGenerator.GetEventIdForComDescr(useCaseId, readMscIt-1,
-										(*eMapIt).second.first, (*eMapIt).second.second);
-							}
-							eventIdVectorPeriodic.clear();
-						}
-						startingTimeForThisComDescr = TIME(startingTimeForThisComDescr.sec() + latency.sec(), "sec");
-						mut.lock();
-						it = eventMap.begin();
-						// Finding spare time-slot in eventMap
-						while (it != eventMap.end())
-						{
-							it = eventMap.find(TIME(startingTimeForThisComDescr.sec() + offset.sec(), "sec"));
-							if (it != eventMap.end())
-								offset = TIME(offset.millisec() + 1, "millisec");
-						}
-						eventMap.insert(TIME_EVENT_ID_PAIR (TIME(startingTimeForThisComDescr.sec() + offset.sec(), "sec"), eventId));
-						mut.unlock();
-						if (!CD_OVERLAP)
-							communicationDescriptorLength = TIME(communicationDescriptorLength.sec() + latency.sec() + offset.sec(), "sec");
-						if (VISUALISER)
-						{
-							visualiserMapMutex.lock();
-							visualiserMap.insert(TIME_EVENT_ID_PAIR (TIME(startingTimeForThisComDescr.sec() + offset.sec(), "sec"), eventId));
-							visualiserMapMutex.unlock();
-						}
-						LOG4CXX_TRACE (logger, "Adding EventID " << eventId
-								<< " at relative time " << setprecision(20) << startingTimeForThisComDescr.sec()
-								<< " to eventMap for use-case " << useCaseId << " and communication descriptor " << readMscIt);
-					}
-				}
-			}
-			eventTimerMap.erase(eMapIt);
-			// Adding new starting time for the same UE
+		// Without any UE queued (all removed through the control socket) only the control socket is polled
+		if (ENABLE_CONTROL && (patternGenerator.GetPopulation()->GetNumOfQueuedUes() == 0
+				|| nextActivation.sec() - currentTime.sec() > CONTROL_POLL_INTERVAL / 1000.0))
+			nextActivation = TIME(currentTime.sec() + CONTROL_POLL_INTERVAL / 1000.0, "sec");
 
-			if (ueDistDef.distribution == UNIFORM_REAL)
-			{
-				boost::uniform_real<> uni_dist_real (ueDistDef.uniformMin.sec(), ueDistDef.uniformMax.sec());
-				boost::variate_generator<base_generator_type&, boost::uniform_real<> > uni_real (generator, uni_dist_real);
-				sTime = TIME(uni_real(), "sec");
-				LOG4CXX_TRACE(logger, "Starting time distribution is UNIFORM_REAL with min = "
-						<< ueDistDef.uniformMin.sec() << " and max = " << ueDistDef.uniformMax.sec()
-						<< "\tValue = " << sTime.sec());
-			}
-			else if (ueDistDef.distribution == UNIFORM_INTEGER)
-			{
-				boost::uniform_int<> uni_dist_int ((int)ueDistDef.uniformMin.sec(), (int)ueDistDef.uniformMax.sec());
-				boost::variate_generator<base_generator_type&, boost::uniform_int<> > uni_int (generator, uni_dist_int);
-				sTime = TIME(uni_int(), "sec");
-				LOG4CXX_TRACE(logger, "Starting time distribution is UNIFORM_INT with min = "
-											<< ueDistDef.uniformMin.sec() << " and max = " << ueDistDef.uniformMax.sec()
-											<< "\tValue = " << sTime.sec());
-			}
-			else if (ueDistDef.distribution == EXPONENTIAL)
-			{
-				boost::exponential_distribution<> exp_dist (ueDistDef.exponentialLambda);
-				boost::variate_generator<base_generator_type&, boost::exponential_distribution<> > exponential (generator, exp_dist);
-				sTime = TIME(exponential(), "sec");
-			}
-			else if (ueDistDef.distribution == GAUSSIAN)
-			{
-				bool timePositive = false;
-				float timeGaussian;
-				boost::normal_distribution<> gau_dist (ueDistDef.gaussianMu,ueDistDef.gaussianSigma);
-				boost::variate_generator<base_generator_type&, boost::normal_distribution<> > gaussian (generator, gau_dist);
-				while (timePositive)
-				{
-					timeGaussian = gaussian();
-					if (timeGaussian > 0)
-						timePositive = true;
-					else
-						LOG4CXX_INFO(logger, "Gaussian returned negative value ... request new value");
-				}
-				sTime = TIME(gaussian(), "sec");
-			}
-			else if (ueDistDef.distribution == GAMMA)
-			{
-				boost::gamma_distribution<> gamma_dist (ueDistDef.gammaAlpha, ueDistDef.gammaBeta);
-				boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > gamma (generator, gamma_dist);
-				sTime = TIME(gamma(), "sec");
-			}
-			else if (ueDistDef.distribution == ERLANG)
-			{
-				boost::gamma_distribution<> erlang_dist (ueDistDef.erlangAlpha, ueDistDef.erlangBeta);
-				boost::variate_generator<base_generator_type&, boost::gamma_distribution<> > erlang (generator, erlang_dist);
-				sTime = TIME(erlang(), "sec");
-			}
-			else
-			{
-				LOG4CXX_ERROR(logger, "This distribution has not been implemented to calculate UE arrival times");
-				pthread_exit(NULL);
-			}
-			// Add CD length to ensure that the new CD is sent AFTER this CD has been finished
-			if (!CD_OVERLAP)
-				sTime = TIME(sTime.sec() + communicationDescriptorLength.sec(), "sec");
-			clock_gettime(CLOCK_REALTIME, &ts);
-			tvNsec = TIME(ts.tv_nsec, "nanosec");
-			tvSec = TIME(ts.tv_sec, "sec");
-			currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
-			bool newTimeFound = false;
-			while (newTimeFound == false)
-			{
-				if (eventTimerMap.find(TIME(currentTime.sec() + sTime.sec(), "sec")) == eventTimerMap.end())
-				{
-					TIME tmpTime;
-					tmpTime = TIME(currentTime.sec() + sTime.sec(), "sec");
-					LOG4CXX_DEBUG(logger, "Next starting time for UE " << ue
-							<< " -> BS " << bs << " in " << std::setprecision(20) << tmpTime.sec() - currentTime.sec() << "s");
-					eventTimerMap.insert(pair <TIME,BS_UE_PAIR> (tmpTime, BS_UE_PAIR (bs,ue)));
-					newTimeFound = true;
-				}
-				else {
-					TIME sTmp = TIME(1, "millisec");
-					sTime = TIME(sTime.sec() + sTmp.sec(), "sec");
-				}
-			}
-			communicationDescriptorLength = TIME(0.0, "sec");
+		if (currentTime < nextActivation)
+		{
+			TIME tmpTime = TIME(nextActivation.sec() - currentTime.sec(), "sec");
+			HOT_LOG_TRACE("Waiting {}s before generating another communication description", tmpTime.sec());
+			timer.expires_from_now(boost::posix_time::microseconds((long)tmpTime.microsec()));
+			timer.wait();
 		}
 	}
 	LOG4CXX_ERROR (logger, "generateEventIds() thread ended");
@@ -575,7 +513,7 @@ void *generateNoiseIds(void *t)
 		}
 		timePositive = false; // reset this boolean
 		sTime = TIME(tmp, "sec");
-		LOG4CXX_DEBUG(logger, "Calculated distribution time for NoiseID = " << sTime.sec());
+		HOT_LOG_DEBUG("Calculated distribution time for NoiseID = {}", sTime.sec());
 		//Get Noise EventID
 		boost::uniform_int<> uni_dist_int (0, hashedNoiseEventIdMap.size() - 1);
 		boost::variate_generator<base_generator_type&, boost::uniform_int<> > uni_int (eventIdGenerator, uni_dist_int);
@@ -584,59 +522,270 @@ void *generateNoiseIds(void *t)
 		tvNsec = TIME(ts.tv_nsec, "nanosec");
 		tvSec = TIME(ts.tv_sec, "sec");
 		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
-		TIME offset = TIME(1, "millisec");
-		//if (!mut.try_lock())
-		//	LOG4CXX_INFO (logger, "Could not get lock to add new NoiseID");
-		mut.lock();
-		//Adding NoiseID to shared eventMap - make sure to find unique time
-		while (eventMap.find(TIME(currentTime.sec() + sTime.sec(), "sec")) != eventMap.end())
-			sTime = TIME(sTime.sec() + offset.sec(),"sec");
-		eventMap.insert(TIME_EVENT_ID_PAIR (TIME(currentTime.sec() + sTime.sec(), "sec"), (*hashedNoiseEventIdMapIt).second));
-		mut.unlock();
-		if (VISUALISER)
+		TIME noiseTime = TIME(currentTime.sec() + sTime.sec(), "sec");
+		// Disabled through the control socket: keep drawing, so the source resumes at its rate when it is enabled again
+		if (!ENABLE_CONTROL || controlSocket.IsNoiseEnabled(0))
 		{
-			visualiserMapMutex.lock();
-			visualiserMap.insert(TIME_EVENT_ID_PAIR (TIME(currentTime.sec() + sTime.sec(), "sec"), (*hashedNoiseEventIdMapIt).second));
-			visualiserMapMutex.unlock();
+			noiseTime = addEventId(noiseTime, (*hashedNoiseEventIdMapIt).second, 0, 0, 0, 0, 0);
+			HOT_LOG_TRACE("Uncorrelated noise EventID added to eventQueue at time {}ns", noiseTime.nanosec());
 		}
-		LOG4CXX_TRACE(logger, "Uncorrelated noise EventID added to eventMap at time " << std::setprecision(20) << currentTime.sec() + sTime.sec() << "s");
-		LOG4CXX_DEBUG(logger, "Waiting " << sTime.sec() << " seconds before generating next uncorrelated noise EventID");
-		timer.expires_from_now(boost::posix_time::microseconds(sTime.microsec()));
+		// Adding might have been blocked by the eventQueue - only wait for the remaining time
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+
+		if (!(noiseTime < currentTime))
+			sTime = TIME(noiseTime.nanosec() - currentTime.nanosec(), "nanosec");
+		else
+			sTime = TIME();
+		HOT_LOG_DEBUG("Waiting {} seconds before generating next uncorrelated noise EventID", sTime.sec());
+		timer.expires_from_now(boost::posix_time::microseconds((long)sTime.microsec()));
 		timer.wait();
 	}
 	LOG4CXX_ERROR (logger, "generateNoiseIds() thread ended");
 	pthread_exit(NULL);
 }
+/**
+ * Generating correlated noise EventIDs
+ *
+ * This function generates the noise EventIDs of a single correlated noise source (MMPP or Hawkes process). The arrivals
+ * are generated one batch interval ahead of the current time and each batch is added to the eventQueue under a single
+ * lock, so the cost per noise EventID does not involve a timer or a lock.
+ *
+ * @param t Index of the noise source in correlatedNoiseDescrVector
+ * @return void
+ */
+void *generateCorrelatedNoiseIds(void *t)
+{
+	long noiseSourceId = (long)t;
+	NoiseGenerator noiseGenerator;
+	boost::asio::io_service io_service;
+	boost::asio::deadline_timer timer(io_service);
+	TIME_EVENT_ID_PAIR_VECTOR batch;
+	TIME batchInterval,
+		batchStart,
+		batchEnd,
+		currentTime,
+		tvSec,
+		tvNsec;
+	timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tvNsec = TIME(ts.tv_nsec, "nanosec");
+	tvSec = TIME(ts.tv_sec, "sec");
+	currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+	noiseGenerator.InitLog(logger);
+	noiseGenerator.Init(correlatedNoiseDescrVector.at(noiseSourceId), seed + noiseSourceId, currentTime);
+	batchInterval = noiseGenerator.GetBatchInterval();
+	batchEnd = currentTime;
+
+	for (;;)
+	{
+		batchStart = batchEnd;
+		batchEnd = TIME(batchStart.sec() + batchInterval.sec(), "sec");
+		batch.clear();
+		noiseGenerator.GenerateBatch(batchEnd, &batch);
+		// Disabled through the control socket: the process goes on, its EventIDs are discarded
+		if (ENABLE_CONTROL && !controlSocket.IsNoiseEnabled(noiseSourceId + 1))
+			batch.clear();
+		//Adding the whole batch to shared eventQueue - blocks while the queue is full
+		eventRouter.AddBatch(&batch, noiseSourceId + 1);
+		HOT_LOG_DEBUG("{} correlated noise EventIDs of source {} added to eventQueue for the window ending at {}ns",
+				batch.size(), noiseSourceId, batchEnd.nanosec());
+		// Stay one batch ahead: wait until the window which has just been generated starts
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+
+		if (currentTime < batchStart)
+		{
+			TIME waitingTime = TIME(batchStart.sec() - currentTime.sec(), "sec");
+			timer.expires_from_now(boost::posix_time::microseconds((long)waitingTime.microsec()));
+			timer.wait();
+		}
+	}
+	LOG4CXX_ERROR (logger, "generateCorrelatedNoiseIds() thread ended");
+	pthread_exit(NULL);
+}
+/**
+ * Terminating OpenMSC while the generator, noise, sender and metrics threads are still running
+ *
+ * exit() would run the destructors of the global objects these threads are using (readMsc, patternGenerator,
+ * eventCounters, ...). The standard streams are flushed and the process ends without running them instead.
+ *
+ * @param status The exit status
+ */
+void terminateOpenMsc(int status)
+{
+	cout.flush();
+	cerr.flush();
+	fflush(NULL);
+	_exit(status);
+}
+/**
+ * Printing the EventIDs sent per use-case, primitive and noise source using INFO logging level
+ *
+ * The number of started use-cases (EventIDs of communication descriptor 0) is compared with the probabilities given in
+ * openmsc.msc, so the emitted mix can be checked without post-processing eventStream.tsv.
+ */
+void logEventCounters()
+{
+	COUNTER_VECTOR counters;
+	map <PRIMITIVE_NAME, unsigned long long> primitiveCounters;
+	map <PRIMITIVE_NAME, unsigned long long>::iterator it;
+	unsigned long long useCasesStarted = 0;
+	ostringstream useCases, primitives, noise;
+
+	eventCounters.GetSnapshot(&counters);
+
+	for (USE_CASE_ID useCaseId = 1; useCaseId <= eventCounters.GetNumOfUseCases(); useCaseId++)
+	{
+		if (eventCounters.GetUseCaseOffset(useCaseId) < eventCounters.GetUseCaseOffset(useCaseId + 1))
+			useCasesStarted += counters[eventCounters.GetUseCaseOffset(useCaseId)];
+	}
+
+	useCases << std::setprecision(3);
+	for (USE_CASE_ID useCaseId = 1; useCaseId <= eventCounters.GetNumOfUseCases(); useCaseId++)
+	{
+		unsigned int offset = eventCounters.GetUseCaseOffset(useCaseId);
+		unsigned long long started = offset < eventCounters.GetUseCaseOffset(useCaseId + 1) ? counters[offset] : 0;
+
+		useCases << "\t" << useCaseId << ": " << started << " ("
+				<< (useCasesStarted > 0 ? 100.0 * started / useCasesStarted : 0) << "% / p = "
+				<< 100.0 * readMsc.GetUseCaseProbability(useCaseId) << "%)";
+
+		for (unsigned int i = offset; i < eventCounters.GetUseCaseOffset(useCaseId + 1); i++)
+			primitiveCounters[readMsc.GetParticularCommunicationDescription(useCaseId, i - offset).primitiveName] += counters[i];
+	}
+
+	for (it = primitiveCounters.begin(); it != primitiveCounters.end(); it++)
+		primitives << "\t" << it->first << ": " << it->second;
+
+	for (unsigned int n = 0; n < eventCounters.GetNumOfNoiseSources(); n++)
+	{
+		if (n == 0)
+			noise << "\tuncorrelated: ";
+		else
+			noise << "\tcorrelated" << n - 1 << ": ";
+		noise << counters[eventCounters.GetNoiseSourceOffset() + n];
+	}
+
+	LOG4CXX_INFO(logger, "Use-cases started (share / probability):" << useCases.str());
+	LOG4CXX_INFO(logger, "EventIDs per primitive:" << primitives.str());
+	LOG4CXX_INFO(logger, "Noise EventIDs per source:" << noise.str());
+}
+/**
+ * Printing the EventID rate together with the fill level and lateness of the eventQueue using INFO logging level
+ *
+ * @param countEventIds EventIDs sent since the last print
+ * @param countEventIdsTotal EventIDs sent in total
+ * @param currentTime The current time
+ * @param emulationStartTime The time the sender has started
+ */
+void logEventIdRate(unsigned int countEventIds, unsigned int countEventIdsTotal, TIME currentTime, TIME emulationStartTime)
+{
+	EVENT_QUEUE_STATISTICS_STRUCT queueStatistics;
+
+	eventRouter.GetStatistics(&queueStatistics, true, STATISTICS_RATE_LOG);
+	LOG4CXX_INFO(logger, "EventIDs sent: " << countEventIds
+			<< " \tTotal EventID #: " << countEventIdsTotal
+			<< "\tAverage EventID rate: " << floor(countEventIdsTotal / (currentTime.sec() - emulationStartTime.sec()))
+			<< "\tQueued: " << queueStatistics.entries
+			<< "\tLateness [ms] (current/mean/max): " << queueStatistics.currentLateness.millisec()
+			<< "/" << queueStatistics.meanLateness.millisec() << "/" << queueStatistics.maxLateness.millisec()
+			<< "\tLate: " << queueStatistics.lateEvents
+			<< "\tDropped: " << queueStatistics.droppedEvents
+			<< "\tBlocked: " << queueStatistics.blockedAdds);
+	logEventCounters();
+}
 /**
  * Sending EventIDs
  *
- * This function sends the integer numbers.
+ * This function sends the integer numbers. There is one sender thread per destination, each with its own socket,
+ * draining the eventQueue of its destination. The thread of the first destination prints the EventID rate.
  *
- * @param pointer to Thread Identifier
+ * @param pointer to the index of the destination
  * @return void
  */
 void *sendStream(void *t)
 {
-	EVENT_MAP eventMapCopy;
-	EVENT_MAP_IT eventMapIt, eventMapCopyIt;
+	unsigned int destination = (unsigned int)(long)t;
+	EventQueue *eventQueue = eventRouter.GetQueue(destination);
+	TIME_EVENT_PAIR event;
+	unsigned int counterThread = eventCounters.RegisterThread();
 	timespec ts;
-	ofstream file;
+	ofstream file, labelFile;
+	ostringstream fileName, labelFileName;
 	boost::asio::io_service io_serviceUdp, io_serviceTcp;
 	udp::socket udpSocket(io_serviceUdp, udp::endpoint(udp::v4(), 0));
 	udp::resolver resolverUdp(io_serviceUdp);
-	udp::resolver::query queryUdp(udp::v4(), ipAddress.c_str(), port.c_str());
-	udp::resolver::iterator iteratorUdp = resolverUdp.resolve(queryUdp);
+	udp::resolver::query queryUdp(udp::v4(), destinations.at(destination).ipAddress.c_str(),
+			destinations.at(destination).port.c_str());
+	udp::resolver::iterator iteratorUdp;
 	tcp::resolver resolverTcp(io_serviceTcp);
-	tcp::resolver::query queryTcp(tcp::v4(), ipAddress.c_str(), port.c_str());
-	tcp::resolver::iterator iteratorTcp = resolverTcp.resolve(queryTcp);
+	tcp::resolver::query queryTcp(tcp::v4(), destinations.at(destination).ipAddress.c_str(),
+			destinations.at(destination).port.c_str());
+	tcp::resolver::iterator iteratorTcp;
 	tcp::socket tcpSocket(io_serviceTcp);
 	TIME printingRateTime;
-	unsigned int countEventIds = 0, countEventIdsTotal = 0;
+	unsigned int countEventIds = 0, countEventIdsTotal = 0, countEventIdsPrinted = 0;
+	uint64_t sequence = 0;	// Sequence number of the next stamped EventID
+	char stampedFrame[WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH];
+	char replyTcp[WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH];
+	SHM_RING_STRUCT *shmRing = NULL;
+	// The shared memory ring does not need a network destination
+	if (!SHM)
+	{
+		try
+		{
+			iteratorUdp = resolverUdp.resolve(queryUdp);
+			iteratorTcp = resolverTcp.resolve(queryTcp);
+		}
+		catch (std::exception& e)
+		{
+			LOG4CXX_ERROR(logger, "Unable to resolve destination " << destinations.at(destination).ipAddress << ":"
+					<< destinations.at(destination).port << ": " << e.what());
+			terminateOpenMsc(EXIT_FAILURE);
+		}
+	}
+	// Every sender thread is the single producer of its own ring
+	if (SHM)
+	{
+		ostringstream segmentName;
+		segmentName << shmName;
+		if (eventRouter.GetNumOfDestinations() > 1)
+			segmentName << "-" << destination;
+		shmRing = ShmRingCreate(segmentName.str().c_str(), SHM_RING_DEFAULT_CAPACITY);
+		if (shmRing == NULL)
+		{
+			LOG4CXX_ERROR(logger, "Unable to create shared memory ring /dev/shm/" << segmentName.str());
+			terminateOpenMsc(EXIT_FAILURE);
+		}
+		LOG4CXX_INFO(logger, "Publishing EventIDs to shared memory ring /dev/shm/" << segmentName.str() << " with "
+				<< shmRing->capacity << " records");
+	}
 	// Opening stream file if option was selected
 	if (streamToFileFlag)
 	{
-		LOG4CXX_DEBUG(logger, "Opening eventStream.tsv file for writing stream to disk");
-		file.open("eventStream.tsv", ios::trunc);
+		// One file per destination, as the sender threads run independently
+		if (eventRouter.GetNumOfDestinations() == 1)
+			fileName << "eventStream.tsv";
+		else
+			fileName << "eventStream-" << destination << ".tsv";
+		LOG4CXX_DEBUG(logger, "Opening " << fileName.str() << " file for writing stream to disk");
+		file.open(fileName.str().c_str(), ios::trunc);
+	}
+	// Line n of the label file describes line n of the stream file
+	if (LABELS_TO_FILE)
+	{
+		if (eventRouter.GetNumOfDestinations() == 1)
+			labelFileName << "eventLabels.tsv";
+		else
+			labelFileName << "eventLabels-" << destination << ".tsv";
+		LOG4CXX_DEBUG(logger, "Opening " << labelFileName.str() << " file for writing the labels of the stream to disk");
+		labelFile.open(labelFileName.str().c_str(), ios::trunc);
 	}
 	// Establishing TCP connection
 	try
@@ -648,7 +797,24 @@ void *sendStream(void *t)
 		if (TCP)
 			LOG4CXX_ERROR(logger, "TCP Exception: " << e.what());
 	}
-	LOG4CXX_DEBUG(logger, "Starting to send EventIDs");
+#ifdef HAVE_LIBURING
+	UringSender uringSender;
+	bool uringActive = false;
+
+	if (URING && !SHM)
+	{
+		// io_uring sends on the connected socket, without destination address
+		if (UDP)
+			udpSocket.connect(*iteratorUdp);
+		uringSender.InitLog(logger);
+		uringActive = uringSender.Init(UDP ? udpSocket.native_handle() : tcpSocket.native_handle(), TCP);
+
+		if (!uringActive)
+			LOG4CXX_ERROR(logger, "io_uring is not available, falling back to boost::asio");
+	}
+#endif
+	LOG4CXX_DEBUG(logger, "Starting to send EventIDs to " << destinations.at(destination).ipAddress << ":"
+			<< destinations.at(destination).port);
 	clock_gettime(CLOCK_REALTIME, &ts); // getting cycle starting time for absolut reference
 	TIME tvNsec(ts.tv_nsec, "nanosec");
 	TIME tvSec(ts.tv_sec, "sec");
@@ -658,81 +824,382 @@ void *sendStream(void *t)
 	for(;;)
 	{
 		clock_gettime(CLOCK_REALTIME, &ts);
-		TIME tvNsec(ts.tv_nsec, "nanosec");
-		TIME tvSec(ts.tv_sec, "sec");
-		double s = tvSec.sec() + tvNsec.sec();
-		TIME currentTime(s, "sec");
-		eventMapIt = eventMap.begin();
+		TIME tvNsec(ts.tv_nsec, "nanosec");
+		TIME tvSec(ts.tv_sec, "sec");
+		double s = tvSec.sec() + tvNsec.sec();
+		TIME currentTime(s, "sec");
+		while (eventQueue->PopDue(currentTime, &event))
+		{
+			string payload;
+			payload = event.second.eventId;
+			if (streamToFileFlag)
+				file << std::setprecision(PRECISION) << (double)(currentTime.sec() - emulationStartTime.sec()) << "\t" << payload << endl;
+			if (LABELS_TO_FILE)
+				writeLabel(labelFile, event.second);
+			if (VISUALISER == true)
+			{
+				HOT_LOG_TRACE("Sending EventID {} to OpenMSC visualiser", payload);
+				visualiserRings[destination].Push(event);
+			}
+			HOT_LOG_TRACE("Sending EventID {} scheduled for {}ns", payload, event.first.nanosec());
+			size_t payloadLength = payload.length();
+			const char *frame = payload.data();
+
+			if (WIRE_STAMPED && !SHM)
+			{
+				if (payloadLength > WIRE_MAX_EVENT_ID_LENGTH)
+					payloadLength = WIRE_MAX_EVENT_ID_LENGTH;
+				clock_gettime(CLOCK_REALTIME, &ts);
+				EncodeWireHeader(stampedFrame, payloadLength, sequence++, event.first.nanosec(),
+						(uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+				memcpy(stampedFrame + WIRE_HEADER_SIZE, payload.data(), payloadLength);
+				frame = stampedFrame;
+				payloadLength += WIRE_HEADER_SIZE;
+			}
+
+#ifdef HAVE_LIBURING
+			// The echo of a TCP receiver is not waited for, io_uring discards it on Flush()
+			if (uringActive)
+				uringSender.Send(frame, payloadLength);
+			else
+#endif
+			if (SHM)
+			{
+				clock_gettime(CLOCK_REALTIME, &ts);
+				ShmRingPublish(shmRing, payload.data(), payload.length(), event.first.nanosec(),
+						(uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec, event.second.useCaseId, event.second.step,
+						event.second.noiseSource);
+			}
+			else if (UDP)
+				udpSocket.send_to(boost::asio::buffer(frame, payloadLength), *iteratorUdp);
+			else if (TCP)
+			{
+				boost::asio::write(tcpSocket, boost::asio::buffer(frame, payloadLength));
+				size_t reply_length = boost::asio::read(tcpSocket,
+					boost::asio::buffer(replyTcp, payloadLength));
+				//std::cout << "Reply is: ";
+				//std::cout.write(reply, reply_length);
+				//std::cout << "\n";
+			}
+			else
+				LOG4CXX_ERROR(logger, "Neither UDP nor TCP was selected");
+
+			eventCounters.Count(counterThread, event.second);
+			countEventIdsTotal = sentEventIds.fetch_add(1, boost::memory_order_relaxed) + 1;
+			// Printing EventID rate to stdout
+			if (PRINT_EVENT_ID_RATE && destination == 0 && printingRateTime.sec() < currentTime.sec())
+			{
+				printingRateTime = TIME(currentTime.sec() + eventLogRateInterval, "sec");
+				countEventIds = countEventIdsTotal - countEventIdsPrinted;
+				countEventIdsPrinted = countEventIdsTotal;
+				logEventIdRate(countEventIds, countEventIdsTotal, currentTime, emulationStartTime);
+			}
+			// Check if stream has already reached it requested size - only one sender thread sees the exact number
+			if (AUTOMATICALLY_STOP_SENDING && stopRate == countEventIdsTotal)
+			{
+				if (streamToFileFlag)
+					file.close();
+				if (LABELS_TO_FILE)
+					labelFile.close();
+#ifdef HAVE_LIBURING
+				if (uringActive)
+					uringSender.Flush();
+#endif
+
+				LOG4CXX_INFO (logger, stopRate << " EventIDs have been sent. OpenMSC will be terminated");
+				logEventCounters();
+				terminateOpenMsc(EXIT_SUCCESS);
+			}
+		}
+#ifdef HAVE_LIBURING
+		// Handing all EventIDs due in this round to the kernel with a single submission
+		if (uringActive)
+			uringSender.Flush();
+#endif
+
+		if (PRINT_EVENT_ID_RATE && destination == 0 && printingRateTime.sec() < currentTime.sec())
+		{
+			printingRateTime = TIME(currentTime.sec() + eventLogRateInterval, "sec");
+			countEventIdsTotal = sentEventIds.load(boost::memory_order_relaxed);
+			countEventIds = countEventIdsTotal - countEventIdsPrinted;
+			countEventIdsPrinted = countEventIdsTotal;
+			logEventIdRate(countEventIds, countEventIdsTotal, currentTime, emulationStartTime);
+		}
+	}
+	if (streamToFileFlag)
+		file.close();
+	if (LABELS_TO_FILE)
+		labelFile.close();
+
+	LOG4CXX_ERROR (logger, "sendEventIds() thread ended");
+	pthread_exit(NULL);
+}
+
+/**
+ * Formatting hot-path log messages
+ *
+ * This function takes the messages written with HOT_LOG_TRACE() and HOT_LOG_DEBUG() out of the hot-path log ring, formats
+ * them and hands them to log4cxx, so the generators and the sender never format or write a log message themselves.
+ *
+ * @param pointer to Thread Identifier
+ * @return void
+ */
+void *formatHotLog(void *t)
+{
+	timespec pause;
+
+	pause.tv_sec = 0;
+	pause.tv_nsec = 1000000;
+
+	for (;;)
+	{
+		// Sleep only if the ring has been empty
+		if (hotLog.Drain() == 0)
+			nanosleep(&pause, NULL);
+	}
+
+	LOG4CXX_ERROR (logger, "formatHotLog() thread ended");
+	pthread_exit(NULL);
+}
+
+/**
+ * Publishing metrics
+ *
+ * This function writes a snapshot of the EventID counters and the eventQueue statistics to the configured metrics target
+ * every metricsInterval. It only reads the counters, so it does not slow down the sender.
+ *
+ * @param pointer to Thread Identifier
+ * @return void
+ */
+void *publishMetrics(void *t)
+{
+	boost::asio::io_service io_service;
+	boost::asio::deadline_timer timer(io_service);
+	MetricsPublisher metricsPublisher;
+	TIME currentTime,
+		tvSec,
+		tvNsec;
+	timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tvNsec = TIME(ts.tv_nsec, "nanosec");
+	tvSec = TIME(ts.tv_sec, "sec");
+	currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+	metricsPublisher.InitLog(logger);
+
+	if (!metricsPublisher.Init(metricsTarget, metricsFormat, &eventCounters, &eventRouter, &readMsc, currentTime))
+		pthread_exit(NULL);
+
+	for (;;)
+	{
+		timer.expires_from_now(boost::posix_time::microseconds((long)metricsInterval.microsec()));
+		timer.wait();
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+		metricsPublisher.Publish(currentTime);
+	}
+
+	LOG4CXX_ERROR (logger, "publishMetrics() thread ended");
+	pthread_exit(NULL);
+}
+/**
+ * Serving the control socket
+ *
+ * This function executes the commands of the control socket clients. Changes of the population and the UE activity are
+ * only stored here and taken over by the generateEventIds thread, so no lock is shared with the generators or the sender.
+ *
+ * @param pointer to Thread Identifier
+ * @return void
+ */
+void *serveControlSocket(void *t)
+{
+	controlSocket.Serve();
+	LOG4CXX_ERROR (logger, "serveControlSocket() thread ended");
+	pthread_exit(NULL);
+}
+/**
+ * Holding the EventID rate at the target
+ *
+ * This function measures the rate of the sender threads every targetRateInterval and hands the UE activity computed
+ * by the RateController to the generateEventIds thread, the same way a change through the control socket is handed
+ * over. The target can be changed through the control socket (rate <EVENTIDS/S>).
+ *
+ * @param pointer to Thread Identifier
+ * @return void
+ */
+void *controlTargetRate(void *t)
+{
+	boost::asio::io_service io_service;
+	boost::asio::deadline_timer timer(io_service);
+	RateController rateController;
+	unsigned int lastSent = sentEventIds.load(boost::memory_order_relaxed),
+		sent;
+	double activityScale = 1,
+		newActivityScale;
+	TIME lastTime,
+		currentTime,
+		tvSec,
+		tvNsec;
+	timespec ts;
+
+	rateController.InitLog(logger);
+	rateController.Init(targetRate, targetRateTolerance, targetRateKp, targetRateKi, 1 / targetRateMaxActivity,
+			targetRateMaxActivity);
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tvNsec = TIME(ts.tv_nsec, "nanosec");
+	tvSec = TIME(ts.tv_sec, "sec");
+	lastTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+
+	for (;;)
+	{
+		timer.expires_from_now(boost::posix_time::microseconds((long)targetRateInterval.microsec()));
+		timer.wait();
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+		// Unsigned difference, so the wrap-around of the counter does not matter
+		sent = sentEventIds.load(boost::memory_order_relaxed);
+		rateController.SetTargetRate(controlSocket.GetTargetRate());
+		newActivityScale = rateController.Update((sent - lastSent) / (currentTime.sec() - lastTime.sec()),
+				currentTime.sec() - lastTime.sec());
+		lastSent = sent;
+		lastTime = currentTime;
+		// A change only alters the speed of the activity time the pending UE activations are queued in, see
+		// UePopulation::SetActivityScale(). Changes below 0.1% are measurement noise and left out, so the control state
+		// does not get a new version every interval.
+		if (fabs(log(newActivityScale / activityScale)) > 0.001)
+		{
+			activityScale = newActivityScale;
+			controlSocket.SetActivityScale(activityScale);
+		}
+	}
+
+	LOG4CXX_ERROR (logger, "controlTargetRate() thread ended");
+	pthread_exit(NULL);
+}
+/**
+ * Running the load ramp
+ *
+ * This function raises the target of the target-rate controller according to the LoadRamp and measures every window:
+ * the EventID rate and lateness of the sender threads, dropped EventIDs, the times the generators were blocked by a full
+ * queue and, if given, the loss and latency of a cooperating receiver. OpenMSC stops once the receiver is saturated or
+ * ramp-MaxRate has been reached, like it does for -s.
+ *
+ * @param pointer to Thread Identifier
+ * @return void
+ */
+void *runLoadRamp(void *t)
+{
+	boost::asio::io_service io_service;
+	boost::asio::deadline_timer timer(io_service);
+	LoadRamp loadRamp;
+	EVENT_QUEUE_STATISTICS_STRUCT startStatistics,
+		endStatistics;
+	RECEIVER_STATISTICS_STRUCT startReceiver,
+		endReceiver;
+	RAMP_WINDOW_STRUCT window;
+	unsigned int startSent,
+		endSent;
+	bool startReceiverValid;
+	TIME currentTime,
+		windowStart,
+		windowEnd,
+		tvSec,
+		tvNsec;
+	timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tvNsec = TIME(ts.tv_nsec, "nanosec");
+	tvSec = TIME(ts.tv_sec, "sec");
+	currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+	loadRamp.InitLog(logger);
+
+	if (!loadRamp.Init(rampDefinition, currentTime))
+		terminateOpenMsc(EXIT_FAILURE);
+
+	for (;;)
+	{
+		// A step is given time to settle, a linear ramp is measured back-to-back
+		if (rampDefinition.mode == RAMP_STEP)
+		{
+			controlSocket.EnableTargetRate(loadRamp.GetTargetRate(currentTime));
+			timer.expires_from_now(boost::posix_time::microseconds((long)rampDefinition.settleTime.microsec()));
+			timer.wait();
+		}
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		tvNsec = TIME(ts.tv_nsec, "nanosec");
+		tvSec = TIME(ts.tv_sec, "sec");
+		windowStart = TIME(tvSec.sec() + tvNsec.sec(), "sec");
+		windowEnd = TIME(windowStart.sec() + rampDefinition.window.sec(), "sec");
+		startSent = sentEventIds.load(boost::memory_order_relaxed);
+		// The ramp restarts its own lateness statistics, so the windows are not cut short by the rate printed with -r
+		eventRouter.GetStatistics(&startStatistics, true, STATISTICS_LOAD_RAMP);
+		startReceiverValid = loadRamp.ReadReceiverStatistics(&startReceiver);
+		currentTime = windowStart;
 
-		while (eventMapIt != eventMap.end() && eventMapIt->first.sec() < currentTime.sec())
+		// The linear ramp moves the target on every controller interval
+		while (currentTime < windowEnd)
 		{
-			string payload;
-			mut.lock();
-			payload = (*eventMapIt).second;
-			if (streamToFileFlag)
-				file << std::setprecision(PRECISION) << (double)(currentTime.sec() - emulationStartTime.sec()) << "\t" << payload << endl;
-			if (VISUALISER == true)
-				LOG4CXX_TRACE(logger, "Sending EventID " << payload << " to OpenMSC visualiser");
-			LOG4CXX_TRACE(logger, "Sending EventID " << payload << " / EventID(s) in map: " << eventMap.size()-1);
-			eventMap.erase(eventMapIt);
-			mut.unlock();
-			size_t payloadLength = payload.length();
+			TIME waitingTime = TIME(windowEnd.sec() - currentTime.sec(), "sec");
 
-			if (UDP)
-				udpSocket.send_to(boost::asio::buffer(payload, payloadLength), *iteratorUdp);
-			else if (TCP)
+			if (rampDefinition.mode == RAMP_LINEAR)
 			{
-				boost::asio::write(tcpSocket, boost::asio::buffer(payload, payloadLength));
-				char replyTcp[100];
-				size_t reply_length = boost::asio::read(tcpSocket,
-					boost::asio::buffer(replyTcp, payloadLength));
-				//std::cout << "Reply is: ";
-				//std::cout.write(reply, reply_length);
-				//std::cout << "\n";
-			}
-			else
-				LOG4CXX_ERROR(logger, "Neither UDP nor TCP was selected");
+				controlSocket.EnableTargetRate(loadRamp.GetTargetRate(currentTime));
 
-			eventMapIt = eventMap.begin();
-			countEventIdsTotal++;
-			// Printing EventID rate to stdout
-			if (PRINT_EVENT_ID_RATE && printingRateTime.sec() < currentTime.sec())
-			{
-				printingRateTime = TIME(currentTime.sec() + eventLogRateInterval, "sec");
-				LOG4CXX_INFO(logger, "EventIDs sent: " << countEventIds
-							<< " \tTotal EventID #: " << countEventIdsTotal
-							<< "\tAverage EventID rate: " << floor(countEventIdsTotal / (currentTime.sec() - emulationStartTime.sec())));
-				countEventIds = 0;
+				if (targetRateInterval < waitingTime)
+					waitingTime = targetRateInterval;
 			}
-			else if (PRINT_EVENT_ID_RATE)
-				countEventIds++;
-			// Check if stream has already reached it requested size
-			if (AUTOMATICALLY_STOP_SENDING && stopRate <= countEventIdsTotal)
-			{
-				if (streamToFileFlag)
-					file.close();
 
-				LOG4CXX_INFO (logger, stopRate << " EventIDs have been sent. OpenMSC will be terminated");
-				exit(0);
-			}
+			timer.expires_from_now(boost::posix_time::microseconds((long)waitingTime.microsec()));
+			timer.wait();
+			clock_gettime(CLOCK_REALTIME, &ts);
+			tvNsec = TIME(ts.tv_nsec, "nanosec");
+			tvSec = TIME(ts.tv_sec, "sec");
+			currentTime = TIME(tvSec.sec() + tvNsec.sec(), "sec");
 		}
 
-		if (PRINT_EVENT_ID_RATE && printingRateTime.sec() < currentTime.sec())
+		endSent = sentEventIds.load(boost::memory_order_relaxed);
+		eventRouter.GetStatistics(&endStatistics, true, STATISTICS_LOAD_RAMP);
+		window.targetRate = (rampDefinition.mode == RAMP_STEP) ? loadRamp.GetTargetRate(windowStart)
+				: loadRamp.GetTargetRate(TIME((windowStart.sec() + currentTime.sec()) / 2, "sec"));
+		window.sentRate = (endSent - startSent) / (currentTime.sec() - windowStart.sec());
+		window.lateFraction = (endStatistics.sentEvents > startStatistics.sentEvents)
+				? (double)(endStatistics.lateEvents - startStatistics.lateEvents)
+						/ (endStatistics.sentEvents - startStatistics.sentEvents) : 0;
+		window.meanLateness = endStatistics.meanLateness;
+		window.maxLateness = endStatistics.maxLateness;
+		window.droppedEvents = endStatistics.droppedEvents - startStatistics.droppedEvents;
+		window.blockedAdds = endStatistics.blockedAdds - startStatistics.blockedAdds;
+		window.receiverValid = startReceiverValid && loadRamp.ReadReceiverStatistics(&endReceiver)
+				&& endReceiver.messages + endReceiver.lost > startReceiver.messages + startReceiver.lost;
+		window.lossFraction = 0;
+		window.latencyP99 = TIME();
+
+		if (window.receiverValid)
 		{
-			printingRateTime = TIME(currentTime.sec() + eventLogRateInterval, "sec");
-			LOG4CXX_INFO(logger, "EventIDs sent: " << countEventIds
-					<< " \tTotal EventID #: " << countEventIdsTotal
-					<< "\tAverage EventID rate: " << floor(countEventIdsTotal / (currentTime.sec() - emulationStartTime.sec())));
-			countEventIds = 0;
+			// lost may shrink again when late messages arrive
+			double lost = (double)endReceiver.lost - (double)startReceiver.lost;
+			window.lossFraction = (lost > 0 ? lost : 0) / ((endReceiver.messages - startReceiver.messages) + (lost > 0 ? lost : 0));
+			window.latencyP99 = TIME(endReceiver.latencyP99, "nanosec");
 		}
+
+		if (!loadRamp.AddWindow(window))
+			break;
+
+		loadRamp.NextStep();
+
+		if (loadRamp.GetTargetRate(currentTime) > rampDefinition.maxRate)
+			break;
 	}
-	if (streamToFileFlag)
-		file.close();
 
-	LOG4CXX_ERROR (logger, "sendEventIds() thread ended");
-	pthread_exit(NULL);
+	loadRamp.Finish();
+	logEventCounters();
+	terminateOpenMsc(EXIT_SUCCESS);
 }
-
 /**
  * Visualiser
  *
@@ -747,6 +1214,11 @@ void *visualiser(void *t)
 	boost::asio::deadline_timer timer(io_service);
 	Visualiser visualiser;
 	visualiser.Initialise(logger, visualiserWindowSize);
+
+	if (visualiserTimeBins > 0)
+		visualiser.EnableLevelOfDetail(visualiserTimeBins, visualiserIdBins, VISUALISER_HEATMAP);
+	else if (VISUALISER_HEATMAP)
+		visualiser.EnableLevelOfDetail(visualiserWindowSize * 10, visualiserIdBins, true);
 	timespec ts;
 	for (;;)
 	{
@@ -755,10 +1227,9 @@ void *visualiser(void *t)
 		TIME tvSec(ts.tv_sec, "sec");
 		double s = tvSec.sec() + tvNsec.sec();
 		TIME currentTime(s, "sec");
-		visualiserMapMutex.lock();
-		// Clean Visualiser map with IDs older than visualiser window size
-		visualiser.UpdateEventIdMap(&visualiserMap, currentTime);
-		visualiserMapMutex.unlock();
+		// Take over the EventIDs sent meanwhile and drop the ones older than visualiser window size
+		for (unsigned int d = 0; d < eventRouter.GetNumOfDestinations(); d++)
+			visualiser.UpdateEventIdWindow(&visualiserRings[d], currentTime);
 		visualiser.UpdatePlot(currentTime);
 		timer.expires_from_now(boost::posix_time::millisec (visualiserUpdateInterval));
 		timer.wait();
@@ -808,144 +1279,176 @@ bool readConfiguration(char *configFileName_,
 	try
 	{
 		float cT;
-		const char *dist;
 		LOG4CXX_INFO(logger,"Reading libconfig configuration file " << configFileName_);
 		const Setting &openmscConfig = root["openmscConfig"];
-		if (!(openmscConfig.lookupValue("numOfUesPerBs", *numOfUesPerBs_)
-				&& openmscConfig.lookupValue("numOfBss", *numOfBss_)
-				&& openmscConfig.lookupValue("ueActivity-Dist", dist)))
-		{
-			LOG4CXX_ERROR (logger, "Parameters numOfUesPerBs, numOfBss and/or ueActivity-Dist could not be read");
+		// UE population, UE activity and information elements
+		patternGenerator.InitLog(logger);
+
+		if (!patternGenerator.ReadDefinition(openmscConfig, &generatorDefinition, &readMsc))
 			return false;
-		}
 
-		if (!(openmscConfig.lookupValue("cdOverlap", CD_OVERLAP)))
-		{
-			LOG4CXX_INFO(logger, "Communication Descriptor overlap (cdOverlap) has not been specified in openmsc.cfg. Set to false");
-			CD_OVERLAP = false;
-		}
-		else
+		*numOfUesPerBs_ = generatorDefinition.numOfUesPerBs;
+		*numOfBss_ = generatorDefinition.numOfBss;
+		seed = generatorDefinition.seed;
+		// Optional bounds of the eventQueue between the generators and the sender
+		string queueLookahead, queueLatePolicy, queueLateTolerance;
+		if (openmscConfig.lookupValue("eventQueue-Lookahead", queueLookahead))
+			eventQueueLookahead = TIME(atof(queueLookahead.c_str()), "sec");
+		openmscConfig.lookupValue("eventQueue-MaxEntries", eventQueueMaxEntries);
+		if (openmscConfig.lookupValue("eventQueue-LateTolerance", queueLateTolerance))
+			lateTolerance = TIME(atof(queueLateTolerance.c_str()), "sec");
+		if (openmscConfig.lookupValue("eventQueue-LatePolicy", queueLatePolicy))
 		{
-			if (CD_OVERLAP)
+			if (queueLatePolicy == "send")
+				lateEventPolicy = LATE_SEND;
+			else if (queueLatePolicy == "drop")
+				lateEventPolicy = LATE_DROP;
+			else if (queueLatePolicy == "dropCount")
+				lateEventPolicy = LATE_DROP_COUNT;
+			else
 			{
-				LOG4CXX_DEBUG(logger, "Communication Descriptor overlap set to true");
+				LOG4CXX_ERROR(logger, "eventQueue-LatePolicy must be either 'send', 'drop' or 'dropCount'");
+				return false;
 			}
-			else
-				LOG4CXX_DEBUG(logger, "Communication Descriptor overlap set to false");
 		}
 
-		if (strcmp(dist,"constant") == 0)
-		{
-			float t;
-			ueDistDef.distribution = CONSTANT;
-			openmscConfig.lookupValue("ueActivity-Dist-Value", t);
-			ueDistDef.constantLatency = TIME(t, "ms");
-		}
-		else if (strcmp(dist,"exponential") == 0)
-		{
-			ueDistDef.distribution = EXPONENTIAL;
-			openmscConfig.lookupValue("ueActivity-Dist-Lambda", ueDistDef.exponentialLambda);
-		}
-		else if (strcmp(dist,"uniform_real") == 0)
+		if (eventQueueLookahead.nanosec() == 0)
 		{
-			float min, max;
-			ueDistDef.distribution = UNIFORM_REAL;
-			openmscConfig.lookupValue("ueActivity-Dist-Min", min);
-			ueDistDef.uniformMin = TIME(min,"sec");
-			openmscConfig.lookupValue("ueActivity-Dist-Max", max);
-			ueDistDef.uniformMax = TIME(max,"sec");
-			LOG4CXX_DEBUG(logger, "Distribution: uniform_real\tMin = " << ueDistDef.uniformMin.sec() << "\tMax = " << ueDistDef.uniformMax.sec());
-		}
-		else if (strcmp(dist,"uniform_int") == 0)
-		{
-			int min, max;
-			ueDistDef.distribution = UNIFORM_INTEGER;
-			openmscConfig.lookupValue("ueActivity-Dist-Min", min);
-			ueDistDef.uniformMin = TIME(min,"sec");
-			openmscConfig.lookupValue("ueActivity-Dist-Max", max);
-			ueDistDef.uniformMax = TIME(max,"sec");
-			LOG4CXX_DEBUG(logger, "Distribution: uniform_int\tMin = " << ueDistDef.uniformMin.sec() << "\tMax = " << ueDistDef.uniformMax.sec());
-		}
-		else if (strcmp(dist,"gamma") == 0)
-		{
-			ueDistDef.distribution = GAMMA;
-			openmscConfig.lookupValue("ueActivity-Dist-Alpha", ueDistDef.gammaAlpha);
-			openmscConfig.lookupValue("ueActivity-Dist-Beta", ueDistDef.gammaBeta);
+			LOG4CXX_ERROR(logger, "eventQueue-Lookahead must be larger than 0");
+			return false;
 		}
-		else if (strcmp(dist,"erlang") == 0)
+		LOG4CXX_DEBUG(logger, "Event queue lookahead = " << eventQueueLookahead.sec() << "s, maxEntries = "
+				<< eventQueueMaxEntries << ", late policy = " << queueLatePolicy);
+		// Optional headless metrics export
+		string target, format, interval;
+		if (openmscConfig.lookupValue("metrics-Target", target))
 		{
-			ueDistDef.distribution = ERLANG;
-			openmscConfig.lookupValue("ueActivity-Dist-Alpha", ueDistDef.erlangAlpha);
-			openmscConfig.lookupValue("ueActivity-Dist-Beta", ueDistDef.erlangBeta);
+			metricsTarget = target;
+			if (openmscConfig.lookupValue("metrics-Format", format))
+			{
+				if (format == "prometheus")
+					metricsFormat = METRICS_PROMETHEUS;
+				else if (format == "line")
+					metricsFormat = METRICS_LINE;
+				else
+				{
+					LOG4CXX_ERROR(logger, "metrics-Format must be either 'prometheus' or 'line'");
+					return false;
+				}
+			}
+			if (openmscConfig.lookupValue("metrics-Interval", interval))
+				metricsInterval = TIME(atof(interval.c_str()), "sec");
+			if (metricsInterval.nanosec() == 0)
+			{
+				LOG4CXX_ERROR(logger, "metrics-Interval must be larger than 0");
+				return false;
+			}
+			ENABLE_METRICS = true;
+			LOG4CXX_INFO(logger, "Publishing metrics to " << metricsTarget << " every " << metricsInterval.sec() << "s");
 		}
-		else if (strcmp(dist,"gaussian") == 0)
+		// Optional runtime control of UE activity, population and noise sources
+		if (openmscConfig.lookupValue("control-Socket", controlSocketPath))
+			ENABLE_CONTROL = true;
+		// Optional tuning of the target-rate controller (--target-rate)
+		string rateInterval, rateTolerance, rateKp, rateKi, rateMaxActivity;
+		if (openmscConfig.lookupValue("targetRate-Interval", rateInterval))
+			targetRateInterval = TIME(atof(rateInterval.c_str()), "sec");
+		if (openmscConfig.lookupValue("targetRate-Tolerance", rateTolerance))
+			targetRateTolerance = atof(rateTolerance.c_str());
+		if (openmscConfig.lookupValue("targetRate-Kp", rateKp))
+			targetRateKp = atof(rateKp.c_str());
+		if (openmscConfig.lookupValue("targetRate-Ki", rateKi))
+			targetRateKi = atof(rateKi.c_str());
+		if (openmscConfig.lookupValue("targetRate-MaxActivity", rateMaxActivity))
+			targetRateMaxActivity = atof(rateMaxActivity.c_str());
+
+		if (targetRateInterval.nanosec() == 0 || targetRateMaxActivity < 1)
 		{
-			ueDistDef.distribution = GAUSSIAN;
-			openmscConfig.lookupValue("ueActivity-Dist-Mu", ueDistDef.gaussianMu);
-			openmscConfig.lookupValue("ueActivity-Dist-Sigma", ueDistDef.gaussianSigma);
+			LOG4CXX_ERROR(logger, "targetRate-Interval must be larger than 0 and targetRate-MaxActivity at least 1");
+			return false;
 		}
-		else
+		// Optional schedule of the load ramp (--ramp)
+		string rampMode, rampValue;
+		rampDefinition.mode = RAMP_STEP;
+		rampDefinition.startRate = 1000;
+		rampDefinition.rateIncrease = 1000;
+		rampDefinition.maxRate = 10000000;
+		rampDefinition.settleTime = TIME(3, "sec");
+		rampDefinition.window = TIME(5, "sec");
+		rampDefinition.maxDeviation = 0.05;
+		rampDefinition.maxLate = 0.01;
+		rampDefinition.maxLoss = 0.001;
+		rampDefinition.outputFile = "rampCurve.tsv";
+		if (openmscConfig.lookupValue("ramp-Mode", rampMode))
 		{
-			LOG4CXX_ERROR(logger,"ueActivity-Dist comprises unknown value!");
-			return false;
+			if (rampMode == "step")
+				rampDefinition.mode = RAMP_STEP;
+			else if (rampMode == "linear")
+				rampDefinition.mode = RAMP_LINEAR;
+			else
+			{
+				LOG4CXX_ERROR(logger, "ramp-Mode must be either 'step' or 'linear'");
+				return false;
+			}
 		}
-		//Checking seed value
-		if(!openmscConfig.lookupValue("seed", seed))
+		if (openmscConfig.lookupValue("ramp-StartRate", rampValue))
+			rampDefinition.startRate = atof(rampValue.c_str());
+		if (openmscConfig.lookupValue("ramp-Increase", rampValue))
+			rampDefinition.rateIncrease = atof(rampValue.c_str());
+		if (openmscConfig.lookupValue("ramp-MaxRate", rampValue))
+			rampDefinition.maxRate = atof(rampValue.c_str());
+		if (openmscConfig.lookupValue("ramp-SettleTime", rampValue))
+			rampDefinition.settleTime = TIME(atof(rampValue.c_str()), "sec");
+		if (openmscConfig.lookupValue("ramp-Window", rampValue))
+			rampDefinition.window = TIME(atof(rampValue.c_str()), "sec");
+		if (openmscConfig.lookupValue("ramp-MaxDeviation", rampValue))
+			rampDefinition.maxDeviation = atof(rampValue.c_str());
+		if (openmscConfig.lookupValue("ramp-MaxLate", rampValue))
+			rampDefinition.maxLate = atof(rampValue.c_str());
+		if (openmscConfig.lookupValue("ramp-MaxLoss", rampValue))
+			rampDefinition.maxLoss = atof(rampValue.c_str());
+		openmscConfig.lookupValue("ramp-Output", rampDefinition.outputFile);
+		openmscConfig.lookupValue("ramp-ReceiverStatistics", rampDefinition.receiverStatistics);
+
+		if (rampDefinition.startRate <= 0 || rampDefinition.rateIncrease <= 0 || rampDefinition.window.nanosec() == 0)
 		{
-			LOG4CXX_ERROR(logger,"Seed value not given in openmsc.cfg");
+			LOG4CXX_ERROR(logger, "ramp-StartRate, ramp-Increase and ramp-Window must be larger than 0");
 			return false;
 		}
-		// Read information elements
-		try
+		// Optional time-varying UE activity profile
+		const char *profile;
+		if (openmscConfig.lookupValue("ueActivity-Profile", profile))
 		{
-			const Setting &informationElements = root["openmscConfig"]["informationElements"];
-			int count = informationElements.getLength();
-			LOG4CXX_DEBUG(logger, count << " information element(s) found in openmsc.cfg");
-			for(int i = 0; i < count; ++i)
+			string period, timeScale, interpolation;
+			rateProfile.InitLog(logger);
+
+			if (!rateProfile.ReadProfile(profile))
+				return false;
+
+			if (openmscConfig.lookupValue("ueActivity-ProfilePeriod", period))
+				ueProfilePeriod = atof(period.c_str());
+			if (openmscConfig.lookupValue("ueActivity-ProfileTimeScale", timeScale))
+				ueProfileTimeScale = atof(timeScale.c_str());
+			if (openmscConfig.lookupValue("ueActivity-ProfileInterpolation", interpolation))
 			{
-				const Setting &ie = informationElements[i];
-				string ieName, ieDist;
-				if(!(ie.lookupValue("ieName", ieName) && ie.lookupValue("ieDist", ieDist)))
+				if (interpolation == "step")
+					ueProfileInterpolate = false;
+				else if (interpolation != "linear")
 				{
-					LOG4CXX_ERROR (logger, "Could not read ieName (" << ieName << ") and/or ieDist (" << ieDist << ") in openmsc.cfg");
+					LOG4CXX_ERROR(logger, "ueActivity-ProfileInterpolation must be either 'linear' or 'step'");
 					return false;
 				}
-				INFORMATION_ELEMENT_DESCRIPTION_STRUCT ieDescrStruct;
-				if (ieDist.find("gaussian") != string::npos)
-				{
-					string ieDistMu, ieDistSigma;
-					ieDescrStruct.ieValueDistDef.distribution = GAUSSIAN;
-					if (!(ie.lookupValue("ieDistMu", ieDistMu) && ie.lookupValue("ieDistSigma", ieDistSigma)))
-					{
-						LOG4CXX_ERROR(logger, "ieDistMu and/or ieDistSigma could not be read from openmsc.cfg");
-						return false;
-					}
-					ieDescrStruct.ieValueDistDef.gaussianMu = atof(ieDistMu.c_str());
-					ieDescrStruct.ieValueDistDef.gaussianSigma = atof(ieDistSigma.c_str());
-				}
-				else if (ieDist.find("constant") != string::npos)
-				{
-					string ieDistValue;
-					ieDescrStruct.ieValueDistDef.distribution = CONSTANT;
-					if (!(ie.lookupValue("ieDistValue", ieDistValue)))
-					{
-						LOG4CXX_ERROR(logger, "ieDistValue could not be read from openmsc.cfg");
-						return false;
-					}
-					ieDescrStruct.ieValueDistDef.constantLatency = TIME(atof(ieDistValue.c_str()), "millisec");
-				}
-				else
-				{
-					LOG4CXX_ERROR (logger, "Unknown 'ieDist' distribution value specified in openmsc.cfg");
-						return false;
-				}
-				readMsc.AddInformationElementDescription(INFORMATION_ELEMENT_DESCRIPTION_PAIR (ieName, ieDescrStruct));
 			}
-		}
-		catch(const SettingNotFoundException &nfex)
-		{
-			LOG4CXX_ERROR(logger, "Reading informationElements definitions from openmsc.cfg failed");
-			return false;
+
+			if (ueProfilePeriod < 0 || ueProfileTimeScale <= 0)
+			{
+				LOG4CXX_ERROR(logger, "ueActivity-ProfilePeriod must be >= 0 and ueActivity-ProfileTimeScale > 0");
+				return false;
+			}
+
+			RATE_PROFILE = true;
+			LOG4CXX_INFO(logger, "UE activity follows rate profile " << profile << " (period = " << ueProfilePeriod
+					<< "s, time scale = " << ueProfileTimeScale << ")");
 		}
 		// Read noise config (if it exists)
 		try
@@ -1031,14 +1534,171 @@ bool readConfiguration(char *configFileName_,
 			LOG4CXX_INFO (logger, "Noise declaration in openmsc.cfg either not given or could not be read");
 			ENABLE_NOISE = false;
 		}
+		// Read correlated noise config (if it exists)
+		try
+		{
+			ENABLE_CORRELATED_NOISE = true;
+			const Setting &noiseCorrelated = root["openmscConfig"]["noise"]["correlated"];
+			int count = noiseCorrelated.getLength();
+
+			LOG4CXX_DEBUG(logger, "Correlated noise definition found (noise sources provided in openmsc.cfg = " << count);
+
+			for (int i = 0; i < count; ++i)
+			{
+				const Setting &noise = noiseCorrelated[i];
+				CORRELATED_NOISE_DESCRIPTION_STRUCT noiseDescr;
+				string process, eventIdRangeMin, eventIdRangeMax, batchInterval;
+
+				if (!(noise.lookupValue("process", process)
+						&& noise.lookupValue("eventIdRangeMin", eventIdRangeMin)
+						&& noise.lookupValue("eventIdRangeMax", eventIdRangeMax)))
+				{
+					LOG4CXX_ERROR (logger, "Could not read process, eventIdRangeMin and/or eventIdRangeMax of correlated noise source " << i);
+					return false;
+				}
+
+				if (atoll(eventIdRangeMax.c_str()) > MAX_INT || atoi(eventIdRangeMin.c_str()) > atoi(eventIdRangeMax.c_str()))
+				{
+					LOG4CXX_ERROR(logger, "Noise EventID range " << eventIdRangeMin << " - " << eventIdRangeMax
+							<< " of correlated noise source " << i << " cannot be handled by OpenMSC");
+					return false;
+				}
+
+				noiseDescr.eventIdRangeMin = atoi(eventIdRangeMin.c_str());
+				noiseDescr.eventIdRangeMax = atoi(eventIdRangeMax.c_str());
+
+				if (noise.lookupValue("batchInterval", batchInterval))
+					noiseDescr.batchInterval = TIME(atof(batchInterval.c_str()), "sec");
+				else
+					noiseDescr.batchInterval = TIME(10, "millisec");
+
+				if (noiseDescr.batchInterval.nanosec() == 0)
+				{
+					LOG4CXX_ERROR(logger, "batchInterval of correlated noise source " << i << " must be larger than 0");
+					return false;
+				}
+
+				if (process == "mmpp")
+				{
+					string rates, sojournTimes, transitions;
+					MSC_LINE_VECTOR ratesVector, sojournTimesVector, transitionRows;
+
+					if (!(noise.lookupValue("mmppRates", rates) && noise.lookupValue("mmppSojournTimes", sojournTimes)))
+					{
+						LOG4CXX_ERROR (logger, "Cannot read mmppRates and/or mmppSojournTimes of correlated noise source " << i);
+						return false;
+					}
+
+					boost::split (ratesVector, rates, boost::is_any_of(","));
+					boost::split (sojournTimesVector, sojournTimes, boost::is_any_of(","));
+
+					if (ratesVector.size() != sojournTimesVector.size())
+					{
+						LOG4CXX_ERROR (logger, "mmppRates and mmppSojournTimes of correlated noise source " << i
+								<< " must have the same number of states");
+						return false;
+					}
+
+					noiseDescr.process = MMPP;
+
+					for (unsigned int state = 0; state < ratesVector.size(); state++)
+					{
+						noiseDescr.mmppRates.push_back(atof(ratesVector.at(state).c_str()));
+						noiseDescr.mmppSojournTimes.push_back(atof(sojournTimesVector.at(state).c_str()));
+
+						if (noiseDescr.mmppRates.back() < 0 || noiseDescr.mmppSojournTimes.back() <= 0)
+						{
+							LOG4CXX_ERROR (logger, "MMPP state " << state << " of correlated noise source " << i
+									<< " requires a rate >= 0 and a sojourn time > 0");
+							return false;
+						}
+					}
+
+					if (noise.lookupValue("mmppTransitions", transitions))
+					{
+						boost::split (transitionRows, transitions, boost::is_any_of(";"));
+
+						if (transitionRows.size() != ratesVector.size())
+						{
+							LOG4CXX_ERROR (logger, "mmppTransitions of correlated noise source " << i << " must have one row per state");
+							return false;
+						}
+
+						for (unsigned int state = 0; state < transitionRows.size(); state++)
+						{
+							MSC_LINE_VECTOR probabilities;
+							double sum = 0;
+							bool negative = false;
+
+							boost::split (probabilities, transitionRows.at(state), boost::is_any_of(","));
+							noiseDescr.mmppTransitions.push_back(vector <double> ());
+
+							for (unsigned int j = 0; j < probabilities.size(); j++)
+							{
+								noiseDescr.mmppTransitions.back().push_back(atof(probabilities.at(j).c_str()));
+								sum += noiseDescr.mmppTransitions.back().back();
+
+								if (noiseDescr.mmppTransitions.back().back() < 0)
+									negative = true;
+							}
+
+							if (probabilities.size() != ratesVector.size() || negative || fabs(sum - 1.0) > 1e-6)
+							{
+								LOG4CXX_ERROR (logger, "Row " << state << " of mmppTransitions of correlated noise source " << i
+										<< " requires one probability >= 0 per state, summing up to 1");
+								return false;
+							}
+						}
+					}
+					LOG4CXX_DEBUG(logger, "Correlated noise source " << i << ": MMPP with " << ratesVector.size() << " states"
+							<< (noiseDescr.mmppTransitions.empty() ? " (cyclic)" : ""));
+				}
+				else if (process == "hawkes")
+				{
+					string baseRate, excitation, decay;
+
+					if (!(noise.lookupValue("hawkesBaseRate", baseRate)
+							&& noise.lookupValue("hawkesExcitation", excitation)
+							&& noise.lookupValue("hawkesDecay", decay)))
+					{
+						LOG4CXX_ERROR (logger, "Cannot read hawkesBaseRate, hawkesExcitation and/or hawkesDecay of correlated noise source " << i);
+						return false;
+					}
+
+					noiseDescr.process = HAWKES;
+					noiseDescr.hawkesBaseRate = atof(baseRate.c_str());
+					noiseDescr.hawkesExcitation = atof(excitation.c_str());
+					noiseDescr.hawkesDecay = atof(decay.c_str());
+
+					if (noiseDescr.hawkesBaseRate <= 0 || noiseDescr.hawkesDecay <= 0
+							|| noiseDescr.hawkesExcitation < 0 || noiseDescr.hawkesExcitation >= 1)
+					{
+						LOG4CXX_ERROR (logger, "Hawkes process of correlated noise source " << i
+								<< " requires hawkesBaseRate > 0, hawkesDecay > 0 and 0 <= hawkesExcitation < 1");
+						return false;
+					}
+					LOG4CXX_DEBUG(logger, "Correlated noise source " << i << ": Hawkes process with mean rate "
+							<< noiseDescr.hawkesBaseRate / (1 - noiseDescr.hawkesExcitation) << "/s");
+				}
+				else
+				{
+					LOG4CXX_ERROR (logger, "Correlated noise process " << process << " has not been implemented");
+					return false;
+				}
+				correlatedNoiseDescrVector.push_back(noiseDescr);
+			}
+		}
+		catch(const SettingNotFoundException &nfex)
+		{
+			LOG4CXX_INFO (logger, "Correlated noise declaration in openmsc.cfg either not given or could not be read");
+			ENABLE_CORRELATED_NOISE = false;
+		}
 	}
 	catch(const SettingNotFoundException &nfex)
 	{
 		LOG4CXX_ERROR(logger, "Setting not found in openmsc.cfg");
 		return false;
 	}
-	LOG4CXX_DEBUG(logger, "UEs per BS: " << *numOfUesPerBs_);
-	LOG4CXX_DEBUG(logger, "Base Stations: " << *numOfBss_);
 	readMsc.AddConfig(numOfUesPerBs_, numOfBss_);
 
 	return true;
@@ -1056,11 +1716,11 @@ int main (int argc, char** argv)
 	long int i;
 	int c;
 	pthread_t threads[4];
+	sigset_t shutdownSignals;
+	int signalNumber;
 	pthread_attr_t attr;
 	void *status;
 	char config_file_name[] = "openmsc.cfg";
-	IP_ADDRESS ipAddress;
-	PORT port;
 
 	log4cxx::BasicConfigurator::configure(log4cxx::AppenderPtr(fileAppender));
 	log4cxx::BasicConfigurator::configure(log4cxx::AppenderPtr(consoleAppender));
@@ -1072,13 +1732,23 @@ int main (int argc, char** argv)
 		{ 0, 'r', "<INTERVAL>", 0, "Print 'EventIDs per second' rate and total # of EventIDs to stdout using INFO logging level"},
 		{ "TCP", 't', 0, 0, "Using IPv4 over TCP to communicate with destination module"},
 		{ "UDP", 'u', 0, 0, "Using IPv4 over UDP to communicate with destination module"},
+		{ "uring", 'U', 0, 0, "Sending UDP/TCP through io_uring in batches (requires liburing, make URING=1)"},
+		{ "shm", 'S', "<NAME>", 0, "Publishing EventIDs to a shared memory ring /dev/shm/<NAME> for modules on the same host"},
 		{ "port", 'p', "<PORT>", 0, "Port number of the receiving module"},
 		{ "ip", 'i', "<IPv4 Address>", 0, "IP address of the receiving module"},
+		{ "destinations", 'D', "<IP>:<PORT>[,<IP>:<PORT>...]", 0, "Fan out to several receiving modules, one sender thread each"},
+		{ "partition", 'P', "<bs|ue|usecase|rr>", 0, "Distribute the EventIDs over the destinations by BS, UE, use-case or round-robin (default bs)"},
 		{ 0, 'f', 0, 0, "Write EventIDs to file 'eventStream.tsv'"},
+		{ "labels", 'L', 0, 0, "Write EventIDs to 'eventStream.tsv' and their use-case instance or noise source, line by line, to 'eventLabels.tsv'"},
 		{ "visualiser", 'v', "<NUMBER>", 0, "Enable real-time visualiser with a window size in seconds"},
 		{ "vInt", 'w', "<NUMBER>", 0, "Set update interval to customised value"},
+		{ "vBins", 'b', "<TIME>[x<ID>]", 0, "Aggregate the visualiser window into <TIME> x <ID> bins (default 256 ID bins)"},
+		{ "vHeatmap", 'm', 0, 0, "Plot the aggregated visualiser window as density heatmap"},
+		{ "stamp", 'x', 0, 0, "Prefix every EventID with a header holding sequence number, scheduled and send time (see wireFormat.hh)"},
 		{ "debug", 'd', "<LEVEL>", 0, "Debug level (ERROR|INFO|DEBUG|TRACE)" },
 		{ 0, 's', "<NUMBER>", 0, "Stop OpenMSC after it sent <NUMBER> EventIDs"},
+		{ "target-rate", 'T', "<EventIDs/s>", 0, "Adjust the UE activity continuously to hold the given EventID rate"},
+		{ "ramp", 'R', 0, 0, "Increase the EventID rate as given by ramp-* in openmsc.cfg until the receiver saturates, write the rate/latency curve and stop"},
 		{ 0 }
 	};
 	struct argp argp = { options, parse_opt, args_doc, doc };
@@ -1092,6 +1762,8 @@ int main (int argc, char** argv)
 	if(argp_parse (&argp, argc, argv, 0, 0, 0) != 0)
 		return(EXIT_FAILURE);
 
+	hotLog.Init(HOT_LOG_RING_SIZE, logger);
+
 	dictionary.Init();
 	readMsc.InitLog(logger);
 	dictionary.InitLog(logger);
@@ -1105,9 +1777,73 @@ int main (int argc, char** argv)
 
 	eventIdGenerator.Init(&readMsc);
 	eventIdGenerator.InitLog(logger);
+	// Without -D the EventIDs are sent to the single destination given by -i and -p
+	if (destinations.empty())
+	{
+		DESTINATION_STRUCT destination;
+		destination.ipAddress = ipAddress;
+		destination.port = port;
+		destinations.push_back(destination);
+	}
+	eventRouter.InitLog(logger);
+	eventRouter.Init(destinations.size(), destinationPartition, eventQueueLookahead, eventQueueMaxEntries, lateEventPolicy,
+			lateTolerance);
+
+	eventCounters.InitLog(logger);
+	eventCounters.Init(&readMsc, 1 + correlatedNoiseDescrVector.size(), MAX_COUNTING_THREADS);
+
+	// The load ramp moves the target of the target-rate controller
+	if (LOAD_RAMP)
+	{
+		TARGET_RATE = true;
+		targetRate = rampDefinition.startRate;
+	}
+	// The target-rate controller hands its UE activity over like the control socket, with or without socket
+	if (TARGET_RATE)
+		ENABLE_CONTROL = true;
+
+	if (ENABLE_CONTROL)
+	{
+		CONTROL_STATE_STRUCT controlState;
+		controlState.activityScale = 1;
+		controlState.numOfBss = numOfBss;
+		controlState.numOfUesPerBs = numOfUesPerBs;
+		controlSocket.InitLog(logger);
+
+		if (!controlSocket.Init(controlSocketPath, controlState, 1 + correlatedNoiseDescrVector.size(), &eventCounters,
+				&eventRouter))
+			return(EXIT_FAILURE);
+
+		if (TARGET_RATE)
+			controlSocket.EnableTargetRate(targetRate);
+	}
+
+	if (VISUALISER)
+	{
+		visualiserRings = new EventRing[destinations.size()];
+		for (unsigned int d = 0; d < destinations.size(); d++)
+			visualiserRings[d].Init(VISUALISER_RING_SIZE / destinations.size());
+	}
 	pthread_attr_init(&attr);
 	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
+	// SIGINT and SIGTERM are handled by the main thread only, all other threads inherit the blocked signal mask
+	sigemptyset(&shutdownSignals);
+	sigaddset(&shutdownSignals, SIGINT);
+	sigaddset(&shutdownSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &shutdownSignals, NULL);
+
+	if (hotLog.IsEnabled(HOT_LOG_LEVEL_DEBUG))
+	{
+		LOG4CXX_INFO(logger, "Creating formatHotLog thread");
+		rc = pthread_create(&threads[1], NULL, formatHotLog, (void *)i );
+
+		if (rc)
+		{
+			LOG4CXX_ERROR(logger,"Unable to create formatHotLog thread, " << rc);
+			exit(-1);
+		}
+	}
 	LOG4CXX_INFO(logger, "Creating generateEventIds thread");
 	rc = pthread_create(&threads[0], NULL, generateEventIds, (void *)i );
 
@@ -1116,12 +1852,16 @@ int main (int argc, char** argv)
 		exit(-1);
 	}
 
-	LOG4CXX_INFO(logger, "Creating sendStream thread");
-	rc = pthread_create(&threads[1], NULL, sendStream, (void *)i );
+	for (unsigned int d = 0; d < destinations.size(); d++)
+	{
+		LOG4CXX_INFO(logger, "Creating sendStream thread for destination " << d << " ("
+				<< destinations.at(d).ipAddress << ":" << destinations.at(d).port << ")");
+		rc = pthread_create(&threads[1], NULL, sendStream, (void *)(long)d);
 
-	if (rc){
-		LOG4CXX_ERROR(logger,"Unable to create sendStream thread, " << rc);
-		exit(-1);
+		if (rc){
+			LOG4CXX_ERROR(logger,"Unable to create sendStream thread, " << rc);
+			exit(-1);
+		}
 	}
 
 	if (ENABLE_NOISE)
@@ -1134,6 +1874,63 @@ int main (int argc, char** argv)
 			exit(-1);
 		}
 	}
+	if (ENABLE_CORRELATED_NOISE)
+	{
+		for (unsigned int noiseSourceId = 0; noiseSourceId < correlatedNoiseDescrVector.size(); noiseSourceId++)
+		{
+			LOG4CXX_INFO(logger, "Creating generateCorrelatedNoiseIds thread for noise source " << noiseSourceId);
+			rc = pthread_create(&threads[1], NULL, generateCorrelatedNoiseIds, (void *)(long)noiseSourceId);
+
+			if (rc){
+				LOG4CXX_ERROR(logger,"Unable to create generateCorrelatedNoiseIds thread, " << rc);
+				exit(-1);
+			}
+		}
+	}
+	if (ENABLE_METRICS)
+	{
+		LOG4CXX_INFO(logger, "Creating publishMetrics thread");
+		rc = pthread_create(&threads[1], NULL, publishMetrics, (void *)i );
+
+		if (rc)
+		{
+			LOG4CXX_ERROR(logger,"Unable to create publishMetrics thread, " << rc);
+			exit(-1);
+		}
+	}
+	if (ENABLE_CONTROL && !controlSocketPath.empty())
+	{
+		LOG4CXX_INFO(logger, "Creating serveControlSocket thread");
+		rc = pthread_create(&threads[1], NULL, serveControlSocket, (void *)i );
+
+		if (rc)
+		{
+			LOG4CXX_ERROR(logger,"Unable to create serveControlSocket thread, " << rc);
+			exit(-1);
+		}
+	}
+	if (TARGET_RATE)
+	{
+		LOG4CXX_INFO(logger, "Creating controlTargetRate thread");
+		rc = pthread_create(&threads[1], NULL, controlTargetRate, (void *)i );
+
+		if (rc)
+		{
+			LOG4CXX_ERROR(logger,"Unable to create controlTargetRate thread, " << rc);
+			exit(-1);
+		}
+	}
+	if (LOAD_RAMP)
+	{
+		LOG4CXX_INFO(logger, "Creating runLoadRamp thread");
+		rc = pthread_create(&threads[1], NULL, runLoadRamp, (void *)i );
+
+		if (rc)
+		{
+			LOG4CXX_ERROR(logger,"Unable to create runLoadRamp thread, " << rc);
+			exit(-1);
+		}
+	}
 	if (VISUALISER)
 	{
 		LOG4CXX_INFO(logger, "Creating visualiser thread");
@@ -1145,7 +1942,14 @@ int main (int argc, char** argv)
 			exit(-1);
 		}
 	}
-	pthread_exit(NULL);
+	// Waiting for shutdown and printing the final counters
+	sigwait(&shutdownSignals, &signalNumber);
+	LOG4CXX_INFO(logger, "Signal " << signalNumber << " received. OpenMSC will be terminated");
+	logEventCounters();
+
+	if (ENABLE_CONTROL && !controlSocketPath.empty())
+		remove(controlSocketPath.c_str());
 
-	return(EXIT_SUCCESS);
+	// The worker threads are still running, see terminateOpenMsc()
+	terminateOpenMsc(EXIT_SUCCESS);
 }
@@ -0,0 +1,527 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "patternGenerator.hh"
+#include <cstring>
+#include <limits>
+
+bool PatternGenerator::ReadDefinition(const libconfig::Setting &openmscConfig, GENERATOR_DEFINITION_STRUCT *definition,
+		ReadMsc *readMsc)
+{
+	const char *dist;
+	string bucketWidth, overflow;
+
+	definition->cdOverlap = false;
+	definition->maxConcurrentProcedures = 1;
+	definition->procedureOverflow = OVERFLOW_QUEUE;
+	definition->populationBucketWidth = TIME(1, "millisec");
+	definition->populationBuckets = 65536;
+
+	if (!(openmscConfig.lookupValue("numOfUesPerBs", definition->numOfUesPerBs)
+			&& openmscConfig.lookupValue("numOfBss", definition->numOfBss)
+			&& openmscConfig.lookupValue("ueActivity-Dist", dist)))
+	{
+		LOG4CXX_ERROR (logger, "Parameters numOfUesPerBs, numOfBss and/or ueActivity-Dist could not be read");
+		return false;
+	}
+
+	if (!(openmscConfig.lookupValue("cdOverlap", definition->cdOverlap)))
+	{
+		LOG4CXX_INFO(logger, "Communication Descriptor overlap (cdOverlap) has not been specified in openmsc.cfg. Set to false");
+		definition->cdOverlap = false;
+	}
+	else
+	{
+		if (definition->cdOverlap)
+		{
+			LOG4CXX_DEBUG(logger, "Communication Descriptor overlap set to true");
+		}
+		else
+			LOG4CXX_DEBUG(logger, "Communication Descriptor overlap set to false");
+	}
+
+	if (strcmp(dist,"constant") == 0)
+	{
+		float t;
+		definition->ueActivity.distribution = CONSTANT;
+		openmscConfig.lookupValue("ueActivity-Dist-Value", t);
+		definition->ueActivity.constantLatency = TIME(t, "millisec");
+	}
+	else if (strcmp(dist,"exponential") == 0)
+	{
+		definition->ueActivity.distribution = EXPONENTIAL;
+		openmscConfig.lookupValue("ueActivity-Dist-Lambda", definition->ueActivity.exponentialLambda);
+	}
+	else if (strcmp(dist,"uniform_real") == 0)
+	{
+		float min, max;
+		definition->ueActivity.distribution = UNIFORM_REAL;
+		openmscConfig.lookupValue("ueActivity-Dist-Min", min);
+		definition->ueActivity.uniformMin = TIME(min,"sec");
+		openmscConfig.lookupValue("ueActivity-Dist-Max", max);
+		definition->ueActivity.uniformMax = TIME(max,"sec");
+		LOG4CXX_DEBUG(logger, "Distribution: uniform_real\tMin = " << definition->ueActivity.uniformMin.sec() << "\tMax = "
+				<< definition->ueActivity.uniformMax.sec());
+	}
+	else if (strcmp(dist,"uniform_int") == 0)
+	{
+		int min, max;
+		definition->ueActivity.distribution = UNIFORM_INTEGER;
+		openmscConfig.lookupValue("ueActivity-Dist-Min", min);
+		definition->ueActivity.uniformMin = TIME(min,"sec");
+		openmscConfig.lookupValue("ueActivity-Dist-Max", max);
+		definition->ueActivity.uniformMax = TIME(max,"sec");
+		LOG4CXX_DEBUG(logger, "Distribution: uniform_int\tMin = " << definition->ueActivity.uniformMin.sec() << "\tMax = "
+				<< definition->ueActivity.uniformMax.sec());
+	}
+	else if (strcmp(dist,"gamma") == 0)
+	{
+		definition->ueActivity.distribution = GAMMA;
+		openmscConfig.lookupValue("ueActivity-Dist-Alpha", definition->ueActivity.gammaAlpha);
+		openmscConfig.lookupValue("ueActivity-Dist-Beta", definition->ueActivity.gammaBeta);
+	}
+	else if (strcmp(dist,"erlang") == 0)
+	{
+		definition->ueActivity.distribution = ERLANG;
+		openmscConfig.lookupValue("ueActivity-Dist-Alpha", definition->ueActivity.erlangAlpha);
+		openmscConfig.lookupValue("ueActivity-Dist-Beta", definition->ueActivity.erlangBeta);
+	}
+	else if (strcmp(dist,"gaussian") == 0)
+	{
+		definition->ueActivity.distribution = GAUSSIAN;
+		openmscConfig.lookupValue("ueActivity-Dist-Mu", definition->ueActivity.gaussianMu);
+		openmscConfig.lookupValue("ueActivity-Dist-Sigma", definition->ueActivity.gaussianSigma);
+	}
+	else
+	{
+		LOG4CXX_ERROR(logger,"ueActivity-Dist comprises unknown value!");
+		return false;
+	}
+	// Optional tuning of the UE activation calendar queue
+	if (openmscConfig.lookupValue("population-BucketWidth", bucketWidth))
+		definition->populationBucketWidth = TIME(atof(bucketWidth.c_str()), "sec");
+	openmscConfig.lookupValue("population-Buckets", definition->populationBuckets);
+
+	if (definition->populationBucketWidth.nanosec() == 0 || definition->populationBuckets == 0)
+	{
+		LOG4CXX_ERROR(logger, "population-BucketWidth and population-Buckets must be larger than 0");
+		return false;
+	}
+	// Optional number of use-cases a UE carries out at the same time
+	openmscConfig.lookupValue("procedures-MaxConcurrent", definition->maxConcurrentProcedures);
+	if (definition->maxConcurrentProcedures == 0 || definition->maxConcurrentProcedures > MAX_CONCURRENT_PROCEDURES)
+	{
+		LOG4CXX_ERROR(logger, "procedures-MaxConcurrent must be between 1 and " << MAX_CONCURRENT_PROCEDURES);
+		return false;
+	}
+	if (openmscConfig.lookupValue("procedures-Overflow", overflow))
+	{
+		if (overflow == "queue")
+			definition->procedureOverflow = OVERFLOW_QUEUE;
+		else if (overflow == "drop")
+			definition->procedureOverflow = OVERFLOW_DROP;
+		else
+		{
+			LOG4CXX_ERROR(logger, "procedures-Overflow must be either 'queue' or 'drop'");
+			return false;
+		}
+	}
+	if (definition->maxConcurrentProcedures > 1)
+		LOG4CXX_INFO(logger, "UEs carry out up to " << definition->maxConcurrentProcedures << " use-cases at the same time ("
+				<< (definition->procedureOverflow == OVERFLOW_QUEUE ? "queue" : "drop") << " on overflow)");
+	//Checking seed value
+	if(!openmscConfig.lookupValue("seed", definition->seed))
+	{
+		LOG4CXX_ERROR(logger,"Seed value not given in openmsc.cfg");
+		return false;
+	}
+	// Read information elements
+	try
+	{
+		const libconfig::Setting &informationElements = openmscConfig["informationElements"];
+		int count = informationElements.getLength();
+		LOG4CXX_DEBUG(logger, count << " information element(s) found in openmsc.cfg");
+		for(int i = 0; i < count; ++i)
+		{
+			const libconfig::Setting &ie = informationElements[i];
+			string ieName, ieDist;
+			if(!(ie.lookupValue("ieName", ieName) && ie.lookupValue("ieDist", ieDist)))
+			{
+				LOG4CXX_ERROR (logger, "Could not read ieName (" << ieName << ") and/or ieDist (" << ieDist << ") in openmsc.cfg");
+				return false;
+			}
+			INFORMATION_ELEMENT_DESCRIPTION_STRUCT ieDescrStruct;
+			if (ieDist.find("gaussian") != string::npos)
+			{
+				string ieDistMu, ieDistSigma;
+				ieDescrStruct.ieValueDistDef.distribution = GAUSSIAN;
+				if (!(ie.lookupValue("ieDistMu", ieDistMu) && ie.lookupValue("ieDistSigma", ieDistSigma)))
+				{
+					LOG4CXX_ERROR(logger, "ieDistMu and/or ieDistSigma could not be read from openmsc.cfg");
+					return false;
+				}
+				ieDescrStruct.ieValueDistDef.gaussianMu = atof(ieDistMu.c_str());
+				ieDescrStruct.ieValueDistDef.gaussianSigma = atof(ieDistSigma.c_str());
+			}
+			else if (ieDist.find("constant") != string::npos)
+			{
+				string ieDistValue;
+				ieDescrStruct.ieValueDistDef.distribution = CONSTANT;
+				if (!(ie.lookupValue("ieDistValue", ieDistValue)))
+				{
+					LOG4CXX_ERROR(logger, "ieDistValue could not be read from openmsc.cfg");
+					return false;
+				}
+				ieDescrStruct.ieValueDistDef.constantLatency = TIME(atof(ieDistValue.c_str()), "millisec");
+			}
+			else
+			{
+				LOG4CXX_ERROR (logger, "Unknown 'ieDist' distribution value specified in openmsc.cfg");
+				return false;
+			}
+			readMsc->AddInformationElementDescription(INFORMATION_ELEMENT_DESCRIPTION_PAIR (ieName, ieDescrStruct));
+		}
+	}
+	catch(const libconfig::SettingNotFoundException &nfex)
+	{
+		LOG4CXX_ERROR(logger, "Reading informationElements definitions from openmsc.cfg failed");
+		return false;
+	}
+	LOG4CXX_DEBUG(logger, "UEs per BS: " << definition->numOfUesPerBs);
+	LOG4CXX_DEBUG(logger, "Base Stations: " << definition->numOfBss);
+	return true;
+}
+
+bool PatternGenerator::Init(EventIdGenerator *eventIdGenerator, ReadMsc *readMsc, GENERATOR_DEFINITION_STRUCT definition,
+		RateProfile *rateProfile, TIME startTime)
+{
+	bool validDistribution = true;
+
+	eventIdGenerator_ = eventIdGenerator;
+	readMsc_ = readMsc;
+	definition_ = definition;
+	rateProfile_ = rateProfile;
+	generator.seed(definition.seed);
+	generatorComDescriptor.seed(definition.seed);
+	generatorUseCase.seed(definition.seed);
+	generatorProfile.seed(definition.seed);
+	controlState.activityScale = 1;
+	controlState.numOfBss = definition.numOfBss;
+	controlState.numOfUesPerBs = definition.numOfUesPerBs;
+	population.InitLog(logger);
+	population.Init(definition.numOfBss, definition.numOfUesPerBs, definition.maxConcurrentProcedures,
+			definition.populationBucketWidth, definition.populationBuckets, startTime);
+	// Generate inital starting time for each UE using the distribution specified in the openmsc.cfg file
+	for (UE_INDEX ueIndex = 0; ueIndex < population.GetNumOfUes(); ueIndex++)
+	{
+		TIME sTime = DrawUeActivity(&validDistribution);
+
+		if (!validDistribution)
+			return false;
+
+		population.GetUeState(ueIndex)->nextArrival = startTime.nanosec() + sTime.nanosec();
+		population.ScheduleArrival(ueIndex);
+		HOT_LOG_TRACE("Initial starting time for UE {} -> BS {} = {}ns using distribution {}", population.GetBsUe(ueIndex).second,
+				population.GetBsUe(ueIndex).first, startTime.nanosec() + sTime.nanosec(), definition_.ueActivity.distribution);
+	}
+	LOG4CXX_INFO(logger, "UE population of " << population.GetNumOfUes() << " UEs allocated with "
+			<< population.GetMemoryUsage() << " bytes ("
+			<< (population.GetNumOfUes() ? population.GetMemoryUsage() / population.GetNumOfUes() : 0) << " bytes per UE)");
+	return true;
+}
+
+void PatternGenerator::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+bool PatternGenerator::Generate(TIME horizon, EVENT_CALLBACK callback, void *context)
+{
+	UE_INDEX ueIndex;
+	bool validDistribution = true,
+		arrival;
+
+	while (population.PopDue(horizon, &ueIndex, &arrival))
+	{
+		UE_STATE_STRUCT *ueState = population.GetUeState(ueIndex);
+		PROCEDURE_SLOT_STRUCT *slot = population.GetDueProcedure(ueIndex);
+		BS_ID bs = population.GetBsUe(ueIndex).first;
+		UE_ID ue = population.GetBsUe(ueIndex).second;
+		TIME dueTime,
+			sTime;
+
+		if (arrival)
+		{
+			unsigned long long arrivalTime = ueState->nextArrival;
+
+			dueTime = population.ToTime(arrivalTime);
+			// Removed through the control socket: no further activation until the UE is back in range
+			if (bs > controlState.numOfBss || ue > controlState.numOfUesPerBs)
+			{
+				HOT_LOG_TRACE("UE {} - BS {} removed, activation skipped", ue, bs);
+				ueState->nextArrival = ~0ULL;
+				continue;
+			}
+			// Non-homogeneous activity: thin out this activation according to the rate profile
+			if (rateProfile_ != NULL && !rateProfile_->AcceptActivation(dueTime, &generatorProfile))
+			{
+				HOT_LOG_TRACE("Activation of UE {} - BS {} thinned out by rate profile", ue, bs);
+				sTime = DrawUeActivity(&validDistribution);
+
+				if (!validDistribution)
+					return false;
+
+				ueState->nextArrival = arrivalTime + sTime.nanosec();
+				population.ScheduleArrival(ueIndex);
+				continue;
+			}
+			// With several slots the next activation does not depend on the use-cases being carried out
+			ueState->nextArrival = ~0ULL;
+			if (definition_.maxConcurrentProcedures > 1)
+			{
+				sTime = DrawUeActivity(&validDistribution);
+
+				if (!validDistribution)
+					return false;
+
+				ueState->nextArrival = arrivalTime + sTime.nanosec();
+				population.ScheduleArrival(ueIndex);
+			}
+			slot = population.StartProcedure(ueIndex);
+
+			if (slot == NULL)
+			{
+				if (definition_.procedureOverflow == OVERFLOW_QUEUE
+						&& ueState->pendingArrivals < std::numeric_limits<unsigned short>::max())
+				{
+					ueState->pendingArrivals++;
+					HOT_LOG_TRACE("All procedure slots of UE {} - BS {} in use, {} use-cases waiting", ue, bs,
+							ueState->pendingArrivals);
+				}
+				else
+					HOT_LOG_TRACE("All procedure slots of UE {} - BS {} in use, use-case dropped", ue, bs);
+				population.Reschedule(ueIndex);
+				continue;
+			}
+			slot->useCaseId = eventIdGenerator_->DetermineUseCaseId(&generatorUseCase);
+			slot->step = 0;
+			slot->procedureStart = dueTime.nanosec();
+			slot->procedure = ++ueState->procedures;
+			HOT_LOG_DEBUG("Use-Case ID for UE {} - BS {} = {} ({} active)", ue, bs, slot->useCaseId,
+					ueState->activeProcedures);
+		}
+		else if (slot->periodicEnd != 0)
+		{
+			dueTime = TIME(slot->due, "nanosec");
+			// get the same periodic EventID with an updated IE value (in case it was not constant)
+			AddCommunicationDescriptor(dueTime, slot, bs, ue, callback, context);
+			// Re-arm the periodic step, it is cancelled once the next '=>' communication descriptor is due
+			slot->due = dueTime.nanosec() + eventIdGenerator_->CalculateLatency(slot->useCaseId, slot->step,
+					&generatorComDescriptor).nanosec();
+			if (slot->due >= slot->periodicEnd)
+			{
+				slot->step++;
+				slot->due = slot->periodicEnd;
+				slot->periodicEnd = 0;
+			}
+			population.Reschedule(ueIndex);
+			continue;
+		}
+		else
+		{
+			dueTime = TIME(slot->due, "nanosec");
+			AddCommunicationDescriptor(dueTime, slot, bs, ue, callback, context);
+			slot->step++;
+		}
+
+		if (ScheduleNextStep(slot, dueTime))
+		{
+			population.Reschedule(ueIndex);
+			continue;
+		}
+		// Use-case has been finished
+		unsigned long long procedureStart = slot->procedureStart;
+		population.FinishProcedure(ueIndex, slot);
+
+		if (ueState->pendingArrivals > 0)
+		{
+			// A waiting use-case takes over the slot straight away
+			ueState->pendingArrivals--;
+			slot = population.StartProcedure(ueIndex);
+			slot->useCaseId = eventIdGenerator_->DetermineUseCaseId(&generatorUseCase);
+			slot->step = 0;
+			slot->procedureStart = dueTime.nanosec();
+			slot->procedure = ++ueState->procedures;
+			HOT_LOG_DEBUG("Use-Case ID for UE {} - BS {} = {} (waited for a free slot)", ue, bs, slot->useCaseId);
+
+			if (!ScheduleNextStep(slot, dueTime))
+				population.FinishProcedure(ueIndex, slot);
+		}
+		else if (definition_.maxConcurrentProcedures == 1)
+		{
+			// Adding new starting time for the same UE
+			sTime = DrawUeActivity(&validDistribution);
+
+			if (!validDistribution)
+				return false;
+
+			// Without overlap the new use-case starts AFTER this one has been finished. With overlap the next
+			// activation counts from the start of this use-case, but the UE still runs only one use-case at a time.
+			// Both are counted in activity time.
+			unsigned long long finished = population.ToActivityTime(dueTime),
+					started = population.ToActivityTime(TIME(procedureStart, "nanosec")),
+					nextActivation = finished + sTime.nanosec();
+			if (definition_.cdOverlap && started + sTime.nanosec() > finished)
+				nextActivation = started + sTime.nanosec();
+			else if (definition_.cdOverlap)
+				nextActivation = finished;
+			ueState->nextArrival = nextActivation;
+			population.ScheduleArrival(ueIndex);
+			HOT_LOG_DEBUG("Next starting time for UE {} -> BS {} in {}s", ue, bs,
+					population.ToTime(nextActivation).sec() - dueTime.sec());
+		}
+		population.Reschedule(ueIndex);
+	}
+
+	return true;
+}
+
+bool PatternGenerator::ApplyControlState(CONTROL_STATE_STRUCT requested, TIME currentTime)
+{
+	bool validDistribution = true;
+	CONTROL_STATE_STRUCT previous = controlState;
+
+	// Queued activations follow the new activity by themselves
+	if (requested.activityScale != controlState.activityScale)
+		population.SetActivityScale(currentTime, requested.activityScale);
+
+	controlState = requested;
+
+	// Removed UEs drop out when their activation is due, only the UEs back in range may have to be scheduled
+	for (int bs = 1; bs <= controlState.numOfBss; bs++)
+	{
+		int firstUe = (bs > previous.numOfBss) ? 1 : previous.numOfUesPerBs + 1;
+
+		for (int ue = firstUe; ue <= controlState.numOfUesPerBs; ue++)
+		{
+			UE_INDEX ueIndex = (UE_INDEX)(bs - 1) * definition_.numOfUesPerBs + (ue - 1);
+			UE_STATE_STRUCT *ueState = population.GetUeState(ueIndex);
+
+			// Still waiting for an activation or carrying out a use-case
+			if (ueState->nextArrival != ~0ULL || ueState->activeProcedures > 0)
+				continue;
+
+			TIME sTime = DrawUeActivity(&validDistribution);
+
+			if (!validDistribution)
+				return false;
+
+			ueState->nextArrival = population.ToActivityTime(currentTime) + sTime.nanosec();
+			population.ScheduleArrival(ueIndex);
+		}
+	}
+
+	LOG4CXX_INFO(logger, "Control state applied: activity " << controlState.activityScale << ", " << controlState.numOfBss
+			<< " BSs, " << controlState.numOfUesPerBs << " UEs per BS (" << population.GetNumOfUes() << " UEs allocated, "
+			<< population.GetNumOfQueuedUes() << " queued)");
+	return true;
+}
+
+TIME PatternGenerator::GetNextActivationTime()
+{
+	return population.GetNextActivationTime();
+}
+
+UePopulation * PatternGenerator::GetPopulation()
+{
+	return &population;
+}
+
+TIME PatternGenerator::DrawUeActivity(bool *validDistribution)
+{
+	TIME sTime = eventIdGenerator_->CalculateUeActivity(&definition_.ueActivity, &generator, validDistribution);
+
+	// Draw candidate activations at the peak rate of the profile - they get thinned out on activation. The activity of
+	// the control state is applied by the activity time of the population.
+	if (rateProfile_ != NULL && rateProfile_->GetMaxMultiplier() != 1)
+		sTime = TIME(sTime.sec() / rateProfile_->GetMaxMultiplier(), "sec");
+
+	return sTime;
+}
+
+bool PatternGenerator::ScheduleNextStep(PROCEDURE_SLOT_STRUCT *slot, TIME dueTime)
+{
+	int mscLength = readMsc_->GetMscLength(slot->useCaseId);
+
+	if (slot->step < mscLength
+			&& readMsc_->GetPeriodicCommunicationDescriptorFlag(slot->useCaseId, slot->step)
+			&& slot->step + 1 < mscLength)
+	{
+		TIME latency = eventIdGenerator_->CalculateLatency(slot->useCaseId, slot->step + 1, &generatorComDescriptor);
+		TIME periodicStartTime = TIME(dueTime.nanosec() + eventIdGenerator_->CalculateLatency(slot->useCaseId,
+				slot->step, &generatorComDescriptor).nanosec(), "nanosec");
+
+		slot->periodicEnd = dueTime.nanosec() + latency.nanosec();
+		slot->due = periodicStartTime.nanosec();
+		// Not a single repetition before the next '=>' communication descriptor
+		if (slot->due >= slot->periodicEnd)
+		{
+			slot->step++;
+			slot->due = slot->periodicEnd;
+			slot->periodicEnd = 0;
+		}
+		return true;
+	}
+	else if (slot->step < mscLength
+			&& !readMsc_->GetPeriodicCommunicationDescriptorFlag(slot->useCaseId, slot->step))
+	{
+		TIME latency = eventIdGenerator_->CalculateLatency(slot->useCaseId, slot->step, &generatorComDescriptor);
+		slot->due = dueTime.nanosec() + latency.nanosec();
+		return true;
+	}
+
+	return false;
+}
+
+void PatternGenerator::AddCommunicationDescriptor(TIME dueTime, PROCEDURE_SLOT_STRUCT *slot, BS_ID bs, UE_ID ue,
+		EVENT_CALLBACK callback, void *context)
+{
+	// use-case ID, step, base-station ID, UE ID
+	EVENT_ID_VECTOR eventIdVector = eventIdGenerator_->GetEventIdForComDescr(slot->useCaseId, slot->step, bs, ue);
+	TIME_EVENT_PAIR event;
+
+	event.first = dueTime;
+	event.second.useCaseId = slot->useCaseId;
+	event.second.step = slot->step;
+	event.second.noiseSource = -1;
+	event.second.bsId = bs;
+	event.second.ueId = ue;
+	event.second.procedure = slot->procedure;
+	// iterate over vector (eventIdVector.size() > 1 if there was more than 1 IE in a particular primitive)
+	for (unsigned int i = 0; i < eventIdVector.size(); i++)
+	{
+		event.second.eventId = eventIdVector.at(i);
+		callback(event, context);
+		HOT_LOG_TRACE("Adding EventID {} at time {}ns for use-case {} and communication descriptor {}",
+				eventIdVector.at(i), dueTime.nanosec(), slot->useCaseId, slot->step);
+	}
+}
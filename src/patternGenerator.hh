@@ -0,0 +1,141 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <libconfig.h++>
+#include "uePopulation.hh"
+
+/**
+ * \class PatternGenerator
+ * This class generates the pattern EventIDs of the UE population, i.e. the generator loop of OpenMSC without any notion
+ * of wall-clock time, sockets or threads.
+ *
+ * Every UE is a small state machine with up to maxConcurrentProcedures procedure slots: when its next activation is due
+ * the UE starts a new use-case in a free slot, when an active slot is due the EventIDs of its current communication
+ * descriptor are handed to the callback. Afterwards only the next step of the slot is scheduled. A periodic
+ * communication descriptor ('->') re-arms its slot each time it has been sent, so its cost does not depend on the period.
+ *
+ * With a single slot a UE draws its next activation once its use-case has been finished (see cdOverlap). With several
+ * slots the activations of a UE form their own renewal process and a use-case which starts while all slots are in use
+ * either waits for the next free slot or is dropped (procedures-Overflow).
+ *
+ * The caller owns the time: Generate() runs all UEs due up to a horizon, be it the current time plus the lookahead of the
+ * eventQueue (openmsc) or a virtual time (libopenmsc). Once it returns, every EventID at or before the horizon has been
+ * handed to the callback, in the order of the UEs being due rather than strictly sorted by time.
+ */
+class PatternGenerator {
+public:
+	/**
+	 * Reading the UE population, its activity and the information elements from the openmscConfig group of openmsc.cfg
+	 * @param openmscConfig The openmscConfig group
+	 * @param definition Pointer to the struct which is filled
+	 * @param readMsc The ReadMsc class the information elements are added to
+	 * @return false if a setting is missing or invalid
+	 */
+	bool ReadDefinition(const libconfig::Setting &openmscConfig, GENERATOR_DEFINITION_STRUCT *definition, ReadMsc *readMsc);
+	/**
+	 * Initialising the generator, allocating the UE population and drawing the first activation of every UE
+	 * @param eventIdGenerator The EventIdGenerator initialised with the MSC
+	 * @param readMsc The ReadMsc class holding the MSC
+	 * @param definition The UE population and its activity
+	 * @param rateProfile The time-varying UE activity profile, NULL for a constant activity
+	 * @param startTime The time from which on UEs are activated
+	 * @return false if the distribution of the UE activity is invalid
+	 */
+	bool Init(EventIdGenerator *eventIdGenerator, ReadMsc *readMsc, GENERATOR_DEFINITION_STRUCT definition,
+			RateProfile *rateProfile, TIME startTime);
+	/**
+	 * Initialising logging in PatternGenerator class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Generating the EventIDs of all UEs which are due up to the horizon
+	 * @param horizon The time up to which UEs are carried out
+	 * @param callback The function every EventID is handed to
+	 * @param context Pointer handed to the callback
+	 * @return false if the distribution of the UE activity is invalid
+	 */
+	bool Generate(TIME horizon, EVENT_CALLBACK callback, void *context);
+	/**
+	 * Taking over a new population and UE activity, e.g. as requested through the control socket
+	 *
+	 * A change of the activity changes the speed of the activity time the pending activations are queued in, so it
+	 * takes effect at once also for UEs which have drawn their next activation far ahead, without touching them. UEs
+	 * beyond the requested number of BSs and UEs per BS finish their use-cases but do not start new ones, and become
+	 * active again once they are back in range. Only the UEs coming back into range are visited.
+	 * @param requested The requested state
+	 * @param currentTime The current time
+	 * @return false if the distribution of the UE activity is invalid
+	 */
+	bool ApplyControlState(CONTROL_STATE_STRUCT requested, TIME currentTime);
+	/**
+	 * Obtain the time the next UE is due
+	 * @return The time of the earliest activation or step, 0 if no UE is queued
+	 */
+	TIME GetNextActivationTime();
+	/**
+	 * Obtain the UE population, e.g. for its statistics
+	 * @return Pointer to the UE population
+	 */
+	UePopulation * GetPopulation();
+private:
+	/**
+	 * Drawing the time until the next activation of a UE
+	 * @param validDistribution Pointer to a boolean indicating whether the distribution in openmsc.cfg is valid
+	 * @return The time until the next (candidate) activation
+	 */
+	TIME DrawUeActivity(bool *validDistribution);
+	/**
+	 * Scheduling the next step of a use-case
+	 *
+	 * A periodic communication descriptor is not expanded up front: the slot becomes due at its first repetition and
+	 * re-arms itself each time it has been sent until the next '=>' communication descriptor is due. Any other step
+	 * becomes the new due time of the procedure slot.
+	 * @param slot The procedure slot carrying out the use-case
+	 * @param dueTime The time at which the previous step has been sent or the use-case has been started
+	 * @return false if the use-case has been finished
+	 */
+	bool ScheduleNextStep(PROCEDURE_SLOT_STRUCT *slot, TIME dueTime);
+	/**
+	 * Handing the EventIDs of a communication descriptor to the callback
+	 * @param dueTime The time the communication descriptor is due
+	 * @param slot The procedure slot carrying out the use-case
+	 * @param bs The base-station of the UE
+	 * @param ue The UE
+	 * @param callback The function every EventID is handed to
+	 * @param context Pointer handed to the callback
+	 */
+	void AddCommunicationDescriptor(TIME dueTime, PROCEDURE_SLOT_STRUCT *slot, BS_ID bs, UE_ID ue,
+			EVENT_CALLBACK callback, void *context);
+	GENERATOR_DEFINITION_STRUCT definition_;		/** The UE population and its activity */
+	CONTROL_STATE_STRUCT controlState;			/** Population and activity in effect */
+	UePopulation population;					/** State and activation calendar of all UEs */
+	EventIdGenerator *eventIdGenerator_;		/** Pointer to EventIdGenerator class */
+	ReadMsc *readMsc_;							/** Pointer to ReadMsc class */
+	RateProfile *rateProfile_;					/** Time-varying UE activity profile, NULL if not given */
+	base_generator_type generator,				/** Number generator for the UE activity */
+		generatorComDescriptor,					/** Number generator for the latencies of the communication descriptors */
+		generatorUseCase,						/** Number generator for the use-cases */
+		generatorProfile;						/** Number generator thinning out activations by the rate profile */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
@@ -0,0 +1,95 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "rateController.hh"
+#include <math.h>
+
+#define RATE_CONTROLLER_MAX_ERROR 2.0	/** Bound of the logarithmic error, e.g. while nothing has been sent yet */
+
+void RateController::Init(double targetRate, double tolerance, double kp, double ki, double minScale, double maxScale)
+{
+	targetRate_ = targetRate;
+	tolerance_ = tolerance;
+	kp_ = kp;
+	ki_ = ki;
+	minScale_ = minScale;
+	maxScale_ = maxScale;
+	integral = 0;
+	scale = 1;
+	onTarget = false;
+	LOG4CXX_DEBUG(logger, "Rate controller initialised: target " << targetRate << "/s +/- " << tolerance * 100
+			<< "%, kp = " << kp << ", ki = " << ki << ", UE activity scale between " << minScale << " and " << maxScale);
+}
+
+void RateController::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+double RateController::Update(double measuredRate, double interval)
+{
+	double error = (measuredRate > 0) ? log(targetRate_ / measuredRate) : RATE_CONTROLLER_MAX_ERROR;
+	double candidate;
+	bool wasOnTarget = onTarget;
+
+	if (error > RATE_CONTROLLER_MAX_ERROR)
+		error = RATE_CONTROLLER_MAX_ERROR;
+	else if (error < -RATE_CONTROLLER_MAX_ERROR)
+		error = -RATE_CONTROLLER_MAX_ERROR;
+
+	// Conditional integration: do not push the integral further while the scale is saturated in that direction
+	candidate = exp(kp_ * error + ki_ * (integral + error * interval));
+	if (!((candidate >= maxScale_ && error > 0) || (candidate <= minScale_ && error < 0)))
+		integral += error * interval;
+
+	scale = exp(kp_ * error + ki_ * integral);
+
+	if (scale > maxScale_)
+		scale = maxScale_;
+	else if (scale < minScale_)
+		scale = minScale_;
+
+	onTarget = fabs(measuredRate - targetRate_) <= tolerance_ * targetRate_;
+
+	if (onTarget != wasOnTarget)
+		LOG4CXX_INFO(logger, "EventID rate " << (onTarget ? "reached" : "left") << " the target of " << targetRate_
+				<< "/s: " << measuredRate << "/s (UE activity x " << scale << ")");
+
+	LOG4CXX_DEBUG(logger, "Rate controller: measured " << measuredRate << "/s, target " << targetRate_
+			<< "/s, error " << error << ", UE activity x " << scale);
+	return scale;
+}
+
+void RateController::SetTargetRate(double targetRate)
+{
+	targetRate_ = targetRate;
+}
+
+double RateController::GetTargetRate()
+{
+	return targetRate_;
+}
+
+bool RateController::IsOnTarget()
+{
+	return onTarget;
+}
@@ -0,0 +1,85 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "controlSocket.hh"
+
+/**
+ * \class RateController
+ * This class holds the EventID rate of the sender at a target by adjusting the UE activity (closed-loop target-rate mode).
+ *
+ * The EventID rate is roughly proportional to the UE activity, plus the noise which is not controlled. Hence, the
+ * controller is a PI controller on the logarithm of the rate: the error is ln(target / measured) and the activity scale
+ * is exp(kp * error + ki * integral of the error). The integral is only advanced while the scale is within its bounds,
+ * so it does not wind up while the target cannot be reached (e.g. noise alone exceeds it).
+ */
+class RateController {
+public:
+	/**
+	 * Initialising the controller, starting with the UE activity of openmsc.cfg
+	 * @param targetRate The EventID rate [1/s] to hold
+	 * @param tolerance The relative deviation from the target which counts as on target, e.g. 0.02
+	 * @param kp The proportional gain
+	 * @param ki The integral gain [1/s]
+	 * @param minScale The smallest UE activity scale
+	 * @param maxScale The largest UE activity scale
+	 */
+	void Init(double targetRate, double tolerance, double kp, double ki, double minScale, double maxScale);
+	/**
+	 * Initialising logging in RateController class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Taking a new measurement into account
+	 * @param measuredRate The EventID rate [1/s] measured over the last interval
+	 * @param interval The length of the interval [s]
+	 * @return The new UE activity scale
+	 */
+	double Update(double measuredRate, double interval);
+	/**
+	 * Changing the target rate without resetting the integral, so the activity moves on from its current value
+	 * @param targetRate The new EventID rate [1/s] to hold
+	 */
+	void SetTargetRate(double targetRate);
+	/**
+	 * Obtain the target rate
+	 * @return The EventID rate [1/s] to hold
+	 */
+	double GetTargetRate();
+	/**
+	 * Check whether the last measurement was within the tolerance
+	 * @return true if the measured rate was on target
+	 */
+	bool IsOnTarget();
+private:
+	double targetRate_;		/** EventID rate [1/s] to hold */
+	double tolerance_;		/** Relative deviation counting as on target */
+	double kp_;				/** Proportional gain */
+	double ki_;				/** Integral gain [1/s] */
+	double minScale_;		/** Smallest UE activity scale */
+	double maxScale_;		/** Largest UE activity scale */
+	double integral;		/** Integral of the error [s] */
+	double scale;			/** Current UE activity scale */
+	bool onTarget;			/** Last measurement within the tolerance */
+	log4cxx::LoggerPtr logger;	/** Pointer to LoggerPtr class */
+};
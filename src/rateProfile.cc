@@ -0,0 +1,158 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <fstream>
+#include <math.h>
+#include "rateProfile.hh"
+
+bool RateProfile::ReadProfile(string fileName)
+{
+	ifstream inputFile;
+	string line;
+	int lineNumber = 0;
+
+	inputFile.open(fileName.c_str());
+
+	if (!inputFile.is_open())
+	{
+		LOG4CXX_ERROR(logger, "Rate profile " << fileName << " could not be opened");
+		return false;
+	}
+
+	rateProfileMap.clear();
+	maxMultiplier = 0;
+
+	while (getline(inputFile, line))
+	{
+		MSC_LINE_VECTOR lineVector;
+		lineNumber++;
+		boost::algorithm::trim(line);
+
+		if (line.empty() || line.at(0) == '#')
+			continue;
+
+		boost::split(lineVector, line, boost::is_any_of(",;\t"));
+
+		if (lineVector.size() < 2)
+		{
+			LOG4CXX_ERROR(logger, "Line " << lineNumber << " of rate profile " << fileName
+					<< " does not follow the format '<time>,<multiplier>': " << line);
+			return false;
+		}
+
+		double t = atof(lineVector.at(0).c_str());
+		RATE_MULTIPLIER m = atof(lineVector.at(1).c_str());
+
+		if (t < 0 || m < 0)
+		{
+			LOG4CXX_ERROR(logger, "Line " << lineNumber << " of rate profile " << fileName
+					<< " holds a negative time or multiplier: " << line);
+			return false;
+		}
+
+		rateProfileMap[t] = m;
+
+		if (m > maxMultiplier)
+			maxMultiplier = m;
+	}
+
+	inputFile.close();
+
+	if (rateProfileMap.empty() || maxMultiplier <= 0)
+	{
+		LOG4CXX_ERROR(logger, "Rate profile " << fileName << " does not hold a single positive multiplier");
+		return false;
+	}
+
+	LOG4CXX_DEBUG(logger, rateProfileMap.size() << " points read from rate profile " << fileName
+			<< " (maximum multiplier = " << maxMultiplier << ")");
+	return true;
+}
+
+void RateProfile::Init(TIME startTime, double period, double timeScale, bool interpolate)
+{
+	startTime_ = startTime.sec();
+	period_ = period;
+	timeScale_ = timeScale;
+	interpolate_ = interpolate;
+}
+
+void RateProfile::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+RATE_MULTIPLIER RateProfile::GetMultiplier(TIME t)
+{
+	RATE_PROFILE_MAP_IT next, previous;
+	double profileTime = (t.sec() - startTime_) * timeScale_;
+
+	if (profileTime < 0)
+		profileTime = 0;
+
+	if (period_ > 0)
+		profileTime = fmod(profileTime, period_);
+
+	next = rateProfileMap.upper_bound(profileTime);
+
+	if (next == rateProfileMap.begin())
+		return next->second;
+
+	previous = next;
+	previous--;
+
+	if (next == rateProfileMap.end())
+	{
+		// Wrap around to the first point if the profile is periodic
+		if (period_ > 0 && interpolate_ && period_ > previous->first)
+		{
+			double w = (profileTime - previous->first) / (period_ + rateProfileMap.begin()->first - previous->first);
+			return previous->second + w * (rateProfileMap.begin()->second - previous->second);
+		}
+		return previous->second;
+	}
+
+	if (!interpolate_)
+		return previous->second;
+
+	double w = (profileTime - previous->first) / (next->first - previous->first);
+	return previous->second + w * (next->second - previous->second);
+}
+
+RATE_MULTIPLIER RateProfile::GetMaxMultiplier()
+{
+	return maxMultiplier;
+}
+
+bool RateProfile::AcceptActivation(TIME t, base_generator_type *gen)
+{
+	boost::uniform_01<base_generator_type&> uniform (*gen);
+	RATE_MULTIPLIER m = GetMultiplier(t);
+	bool accept = uniform() * maxMultiplier < m;
+
+	HOT_LOG_TRACE("Rate multiplier at {}ns = {} -> activation {}", t.nanosec(), m, accept ? "accepted" : "thinned out");
+	return accept;
+}
@@ -0,0 +1,82 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "noiseGenerator.hh"
+
+/**
+ * \class RateProfile
+ * This class holds a time-varying UE activity profile (e.g. a diurnal load curve) read from a CSV file.
+ *
+ * The profile is applied by thinning: UE activations are drawn at the peak rate of the profile and each activation is
+ * accepted with probability GetMultiplier() / GetMaxMultiplier(). Hence, no UE schedule has to be recomputed when the
+ * rate changes.
+ */
+class RateProfile {
+public:
+	/**
+	 * Reading the profile from a CSV file with lines of the form '<time [s]>,<rate multiplier>'. Empty lines and lines
+	 * starting with '#' are ignored.
+	 * @param fileName The name of the CSV file
+	 * @return Boolean indicating whether or not the profile could be read
+	 */
+	bool ReadProfile(string fileName);
+	/**
+	 * Initialising the profile
+	 * @param startTime The time at which the profile starts
+	 * @param period Length of the profile in seconds after which it repeats. If 0, the last value is held
+	 * @param timeScale Number of profile seconds per real second, e.g. 1440 plays a 24h profile in one minute
+	 * @param interpolate Linear interpolation between points if true, step function otherwise
+	 */
+	void Init(TIME startTime, double period, double timeScale, bool interpolate);
+	/**
+	 * Initialising logging in RateProfile class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Obtain the rate multiplier at a given time
+	 * @param t The (absolute) time
+	 * @return The rate multiplier of the profile at the given time
+	 */
+	RATE_MULTIPLIER GetMultiplier(TIME t);
+	/**
+	 * Obtain the largest rate multiplier of the profile, i.e. the rate at which candidate activations are drawn
+	 * @return The maximum rate multiplier
+	 */
+	RATE_MULTIPLIER GetMaxMultiplier();
+	/**
+	 * Decide whether a candidate UE activation at the given time is kept
+	 * @param t The (absolute) time of the candidate activation
+	 * @param gen boost number generator
+	 * @return true if the activation should be carried out
+	 */
+	bool AcceptActivation(TIME t, base_generator_type *gen);
+private:
+	RATE_PROFILE_MAP rateProfileMap;	/** Profile time [s] <> rate multiplier */
+	RATE_MULTIPLIER maxMultiplier;		/** Largest multiplier in rateProfileMap */
+	double startTime_;					/** Absolute start time [s] of the profile */
+	double period_;						/** Period [s] of the profile, 0 if not periodic */
+	double timeScale_;					/** Profile seconds per real second */
+	bool interpolate_;					/** Linear interpolation between points */
+	log4cxx::LoggerPtr logger;			/** Pointer to LoggerPtr class */
+};
@@ -50,17 +50,17 @@ void ReadMsc::InitLog(log4cxx::LoggerPtr l)
 {
 	logger = l;
 }
-int ReadMsc::ReadMscConfigFile ()
+int ReadMsc::ReadMscConfigFile (string fileName)
 {
 	ifstream inputFile;	/** char file input stream */
 	string line;		/** string to hold a line from the MSC file */
 	USE_CASE_ID useCaseId = 0; /** Integer use-case identifier initialised with 0*/
 
-	inputFile.open ("openmsc.msc");
+	inputFile.open (fileName.c_str());
 
 	if (!inputFile.is_open())
 	{
-		printf("openmsc.msc could not be opened\n");
+		printf("%s could not be opened\n", fileName.c_str());
 
 		return(EXIT_FAILURE);
 	}
@@ -171,13 +171,22 @@ USE_CASE_ID ReadMsc::GetUseCaseId4Probability(PROBABILITY p)
 		pTmp += (*it).second;
 		if (pTmp > p)
 		{
-			LOG4CXX_DEBUG(logger, "For given probability " << p << " the sum " << pTmp << " corresponds to use-case ID = " << (*it).first);
+			HOT_LOG_DEBUG("For given probability {} the sum {} corresponds to use-case ID = {}", p, pTmp, (*it).first);
 			return (*it).first;
 		}
 	}
 
 	return 0;
 }
+PROBABILITY ReadMsc::GetUseCaseProbability(USE_CASE_ID useCaseId)
+{
+	USE_CASE_PROBABILITY_MAP_IT it = useCaseProbabilityMap.find(useCaseId);
+
+	if (it == useCaseProbabilityMap.end())
+		return 0;
+
+	return (*it).second;
+}
 int ReadMsc::GetIeValue(INFORMATION_ELEMENT ie)
 {
 	INFORMATION_ELEMENT_DESCRIPTION_MAP_IT it;
@@ -684,6 +693,11 @@ IDENTIFIER ReadMsc::TranslateInformationElement2ID(INFORMATION_ELEMENT ie)
 void ReadMsc::EstablishDictConnection(Dictionary *dict_)
 {
 	dictionary_ = dict_;
+	// Identifiers are numbered from 1 in the new dictionary, also for instances which are not global (zero-initialised)
+	networkElementsCounter = 0;
+	protocolTypesCounter = 0;
+	primitiveNamesCounter = 0;
+	informationElementsCounter = 0;
 }
 void ReadMsc::AddConfig(int *uesPerBs_, int *bss_)
 {
@@ -23,7 +23,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "visualiser.hh"
+#include "hotLog.hh"
 /**
  * Class for parsing MSCgen configuration file
  */
@@ -32,9 +32,10 @@ public:
 	/**
 	 * \brief Read in MSC config file
 	 *
+	 * \param fileName The MSC file, openmsc.msc in the working directory by default
 	 * \return integer return value indicating success (0) or failure (> 0)
 	 */
-	int ReadMscConfigFile ();
+	int ReadMscConfigFile (string fileName = "openmsc.msc");
 	/**
 	 * Obtain the number of communication descriptions for a particular use-case ID
 	 * @param useCaseId The use-case ID for which the length should be determined
@@ -62,6 +63,12 @@ public:
 	 * @return The probability for the given use-case ID
 	 */
 	USE_CASE_ID GetUseCaseId4Probability(PROBABILITY p);
+	/**
+	 * Obtain the probability of a use-case as given in openmsc.msc
+	 * @param useCaseId The integer number for the use-case ID
+	 * @return The probability of the use-case, 0 if the use-case does not exist
+	 */
+	PROBABILITY GetUseCaseProbability(USE_CASE_ID useCaseId);
 	/**
 	 * Calculate the value for an information element different from UE_ID or BS_ID.
 	 * @param ie The information element
@@ -112,7 +119,7 @@ public:
 	 */
 	IDENTIFIER TranslateInformationElement2ID(INFORMATION_ELEMENT ie);
 	/**
-	 * Keep pointer to Dictionary class and its previous initilisation in openmsc.cc
+	 * Keep pointer to Dictionary class and its previous initilisation in openmsc.cc. Restarts the numbering of the identifiers
 	 * @param dict_ Pointer to Dictionary class
 	 */
 	void EstablishDictConnection(Dictionary *dict_);
@@ -0,0 +1,464 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "wireFormat.hh"
+#include "shmRing.hh"
+#include "latencyStatistics.hh"
+
+using namespace std;
+
+#define BATCH_SIZE 64				/** Datagrams received with a single recvmmsg() call */
+#define DATAGRAM_SIZE 2048			/** Maximal size of a received datagram */
+#define TCP_READ_SIZE 262144		/** Bytes read from the TCP stream at once */
+#define SHM_SPIN_ROUNDS 100000		/** Empty polls of the shared-memory ring before sleeping on its doorbell */
+
+volatile sig_atomic_t running = 1;	/** Cleared by SIGINT/SIGTERM or when the duration has passed */
+
+/**
+ * Receiver statistics
+ */
+struct statistics {
+	unsigned long long messages,		/** Messages received */
+		bytes,							/** Bytes received */
+		invalid,						/** Stamped messages with an invalid header */
+		lastMessages;					/** Messages at the last per-second report */
+	SEQUENCE_STATISTICS_STRUCT sequence;	/** Loss and reordering */
+	LATENCY_HISTOGRAM_STRUCT latency;	/** One-way latency from the send time */
+	LATENCY_HISTOGRAM_STRUCT lateness;	/** Send time - scheduled time, i.e. how late the sender was */
+	LATENCY_HISTOGRAM_STRUCT secondLatency;	/** One-way latency since the last per-second report */
+} stats;
+
+bool stamped = false;				/** Expect the wire header of openmsc -x */
+const char *statisticsFile = NULL;	/** File the counters are written to every second (-o), e.g. for the openmsc load ramp */
+
+void stop(int signal)
+{
+	running = 0;
+}
+
+unsigned long long now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+void accountStamped(uint64_t sequence, uint64_t scheduledTime, uint64_t sendTime, unsigned long long receiveTime);
+/**
+ * Accounting a single received EventID (message without the wire header in plain mode)
+ */
+void account(const char *message, size_t length, unsigned long long receiveTime)
+{
+	WIRE_HEADER_STRUCT header;
+
+	stats.messages++;
+	stats.bytes += length;
+
+	if (!stamped)
+		return;
+
+	if (length < WIRE_HEADER_SIZE || !DecodeWireHeader(message, &header))
+	{
+		stats.invalid++;
+		return;
+	}
+
+	accountStamped(header.sequence, header.scheduledTime, header.sendTime, receiveTime);
+}
+/**
+ * Accounting sequence number, one-way latency and sender lateness of a stamped EventID
+ */
+void accountStamped(uint64_t sequence, uint64_t scheduledTime, uint64_t sendTime, unsigned long long receiveTime)
+{
+	SequenceStatisticsAdd(&stats.sequence, sequence);
+	// One-way latency, sender and receiver are expected to share the clock (loopback or PTP synchronised)
+	LatencyHistogramAdd(&stats.latency, sendTime, receiveTime);
+	LatencyHistogramAdd(&stats.secondLatency, sendTime, receiveTime);
+	LatencyHistogramAdd(&stats.lateness, scheduledTime, sendTime);
+}
+
+/**
+ * Writing '<messages> <lost> <p99 latency of the last second [ns]>' to the statistics file. The file is replaced
+ * atomically, so a reader never sees a partial line.
+ */
+void writeStatistics()
+{
+	string temporary = string(statisticsFile) + ".tmp";
+	FILE *file = fopen(temporary.c_str(), "w");
+
+	if (file == NULL)
+	{
+		perror("Writing the statistics file failed");
+		return;
+	}
+
+	fprintf(file, "%llu %llu %llu\n", stats.messages, stats.sequence.lost,
+			LatencyHistogramPercentile(&stats.secondLatency, 0.99));
+	fclose(file);
+	rename(temporary.c_str(), statisticsFile);
+	LatencyHistogramReset(&stats.secondLatency);
+}
+
+void reportSecond(double elapsed)
+{
+	cout << fixed << setprecision(1) << elapsed << "s\t" << stats.messages - stats.lastMessages << " msg/s";
+	if (stamped)
+		cout << "\tlost " << stats.sequence.lost << "\tp99 " << LatencyHistogramPercentile(&stats.latency, 0.99) / 1000.0 << "us";
+	cout << "\n";
+	cout.flush();
+	stats.lastMessages = stats.messages;
+
+	if (statisticsFile != NULL)
+		writeStatistics();
+}
+
+void summary(double elapsed)
+{
+	cout << "\n#### Summary ####\n"
+			<< "Duration:\t" << setprecision(3) << elapsed << "s\n"
+			<< "Messages:\t" << stats.messages << "\n"
+			<< "Bytes:\t\t" << stats.bytes << "\n"
+			<< "Average rate:\t" << setprecision(0) << (elapsed > 0 ? stats.messages / elapsed : 0) << " msg/s\n";
+
+	if (stamped)
+	{
+		cout << "Invalid:\t" << stats.invalid << "\n"
+				<< "Sequence:\t";
+		SequenceStatisticsPrint(cout, &stats.sequence);
+		cout << "Latency [us]:\t";
+		LatencyHistogramPrint(cout, &stats.latency);
+		cout << "Lateness [us]:\t";
+		LatencyHistogramPrint(cout, &stats.lateness);
+	}
+}
+
+void receiveUdp(int sock, unsigned long long startTime, unsigned long long endTime)
+{
+	vector <char> buffers(BATCH_SIZE * DATAGRAM_SIZE);
+	mmsghdr messages[BATCH_SIZE];
+	iovec iovecs[BATCH_SIZE];
+	unsigned long long nextReport = startTime + 1000000000ULL;
+
+	for (int i = 0; i < BATCH_SIZE; i++)
+	{
+		iovecs[i].iov_base = &buffers[i * DATAGRAM_SIZE];
+		iovecs[i].iov_len = DATAGRAM_SIZE;
+		memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+		messages[i].msg_hdr.msg_iov = &iovecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (running)
+	{
+		// The socket has a receive timeout, so the per-second report is printed even without traffic
+		int received = recvmmsg(sock, messages, BATCH_SIZE, MSG_WAITFORONE, NULL);
+		unsigned long long receiveTime = now();
+
+		for (int i = 0; i < received; i++)
+			account(&buffers[i * DATAGRAM_SIZE], messages[i].msg_len, receiveTime);
+
+		if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			perror("recvmmsg");
+			return;
+		}
+
+		if (receiveTime >= nextReport)
+		{
+			reportSecond((receiveTime - startTime) / 1e9);
+			nextReport += 1000000000ULL;
+		}
+
+		if (endTime > 0 && receiveTime >= endTime)
+			running = 0;
+	}
+}
+
+void receiveTcp(int listenSock, unsigned long long startTime, unsigned long long endTime, bool echo)
+{
+	vector <char> buffer(TCP_READ_SIZE + WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH);
+	unsigned long long nextReport = startTime + 1000000000ULL;
+	int sock = -1;
+	size_t pending = 0;		/** Bytes of an incomplete stamped message kept at the start of the buffer */
+
+	while (running)
+	{
+		if (sock < 0)
+		{
+			sock = accept(listenSock, NULL, NULL);
+			if (sock < 0)
+			{
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				{
+					perror("accept");
+					return;
+				}
+			}
+			else
+			{
+				timeval timeout = {0, 100000};
+				int one = 1;
+				setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+				setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+				pending = 0;
+			}
+		}
+
+		ssize_t received = sock < 0 ? -1 : read(sock, &buffer[pending], TCP_READ_SIZE);
+		unsigned long long receiveTime = now();
+
+		if (received == 0 || (received < 0 && sock >= 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+		{
+			close(sock);
+			sock = -1;
+		}
+		else if (received > 0)
+		{
+			// openmsc sends in lockstep over TCP and waits for every EventID to be echoed
+			if (echo)
+			{
+				for (ssize_t written = 0; written < received; )
+				{
+					ssize_t w = write(sock, &buffer[pending + written], received - written);
+					if (w <= 0)
+						break;
+					written += w;
+				}
+			}
+
+			if (!stamped)
+			{
+				// Plain EventIDs carry no framing - every read is counted as a single message
+				account(&buffer[0], received, receiveTime);
+			}
+			else
+			{
+				size_t available = pending + received, offset = 0;
+				WIRE_HEADER_STRUCT header;
+
+				while (available - offset >= WIRE_HEADER_SIZE)
+				{
+					if (!DecodeWireHeader(&buffer[offset], &header))
+					{
+						// Lost the framing - drop the rest of this read
+						stats.invalid++;
+						offset = available;
+						break;
+					}
+					if (available - offset < (size_t)WIRE_HEADER_SIZE + header.length)
+						break;
+
+					account(&buffer[offset], WIRE_HEADER_SIZE + header.length, receiveTime);
+					offset += WIRE_HEADER_SIZE + header.length;
+				}
+
+				pending = available - offset;
+				memmove(&buffer[0], &buffer[offset], pending);
+			}
+		}
+
+		if (receiveTime >= nextReport)
+		{
+			reportSecond((receiveTime - startTime) / 1e9);
+			nextReport += 1000000000ULL;
+		}
+
+		if (endTime > 0 && receiveTime >= endTime)
+			running = 0;
+	}
+
+	if (sock >= 0)
+		close(sock);
+}
+
+void receiveShm(const char *name, unsigned long long startTime, unsigned long long endTime)
+{
+	SHM_RING_STRUCT *ring;
+	SHM_EVENT_RECORD record;
+	uint64_t cursor;
+	unsigned long long overrun = 0, nextReport = startTime + 1000000000ULL;
+	unsigned int idle = 0;
+
+	while ((ring = ShmRingAttach(name)) == NULL && running)
+	{
+		if (endTime > 0 && now() >= endTime)
+			return;
+		usleep(100000);
+	}
+
+	if (ring == NULL)
+		return;
+	// Starting with the records published from now on, overruns show up as sequence gaps
+	cursor = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	stats.sequence.nextSequence = cursor;
+
+	while (running)
+	{
+		unsigned long long receiveTime;
+
+		if (ShmRingRead(ring, &cursor, &record, &overrun))
+		{
+			receiveTime = now();
+			stats.messages++;
+			stats.bytes += record.length;
+			accountStamped(record.sequence, record.scheduledTime, record.sendTime, receiveTime);
+			idle = 0;
+		}
+		else
+		{
+			// Spinning keeps the latency low under load, sleeping on the doorbell keeps an idle consumer off the CPU
+			if (++idle > SHM_SPIN_ROUNDS)
+				ShmRingWait(ring, cursor, 100);
+			receiveTime = now();
+			// A restarted openmsc replaces the segment and starts counting from 0 again
+			if (ShmRingClosed(ring))
+			{
+				SHM_RING_STRUCT *successor = ShmRingAttach(name);
+
+				if (successor != NULL)
+				{
+					ShmRingDetach(ring);
+					ring = successor;
+					cursor = 0;
+					stats.sequence.nextSequence = 0;
+				}
+			}
+		}
+
+		if (receiveTime >= nextReport)
+		{
+			reportSecond((receiveTime - startTime) / 1e9);
+			nextReport += 1000000000ULL;
+		}
+
+		if (endTime > 0 && receiveTime >= endTime)
+			running = 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool tcp = false, echo = true;
+	const char *shmName = NULL;
+	double duration = 0;
+	int option, sock;
+	sockaddr_in address;
+	timeval timeout = {0, 100000};
+	int one = 1, receiveBuffer = 64 * 1024 * 1024;
+
+	while ((option = getopt(argc, argv, "tsnd:m:o:")) != -1)
+	{
+		switch (option)
+		{
+		case 't':
+			tcp = true;
+			break;
+		case 's':
+			stamped = true;
+			break;
+		case 'n':
+			echo = false;
+			break;
+		case 'd':
+			duration = atof(optarg);
+			break;
+		case 'm':
+			shmName = optarg;
+			stamped = true;
+			break;
+		case 'o':
+			statisticsFile = optarg;
+			break;
+		default:
+			optind = argc;
+		}
+	}
+
+	if (optind != argc - (shmName == NULL ? 1 : 0))
+	{
+		cerr << "Usage: receiverBenchmark [-t] [-s] [-n] [-d <SECONDS>] [-o <FILE>] <PORT>\n"
+				<< "       receiverBenchmark -m <NAME> [-d <SECONDS>] [-o <FILE>]\n"
+				<< "  -t  TCP instead of UDP\n"
+				<< "  -s  EventIDs are stamped with sequence number and send time (openmsc -x)\n"
+				<< "  -n  Do not echo TCP data back (openmsc waits for the echo)\n"
+				<< "  -m  Read from the shared-memory ring /dev/shm/<NAME> (openmsc -S)\n"
+				<< "  -d  Stop after <SECONDS> and print the summary (default: until SIGINT)\n"
+				<< "  -o  Write '<MESSAGES> <LOST> <P99 LATENCY [ns]>' to <FILE> every second (openmsc ramp-ReceiverStatistics)\n";
+		return 1;
+	}
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+	memset(&stats, 0, sizeof(stats));
+	LatencyHistogramReset(&stats.latency);
+	LatencyHistogramReset(&stats.lateness);
+	LatencyHistogramReset(&stats.secondLatency);
+
+	if (shmName != NULL)
+	{
+		unsigned long long startTime = now();
+		receiveShm(shmName, startTime, duration > 0 ? startTime + (unsigned long long)(duration * 1e9) : 0);
+		summary((now() - startTime) / 1e9);
+		return 0;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(atoi(argv[optind]));
+	sock = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	if (sock < 0 || bind(sock, (sockaddr *)&address, sizeof(address)) != 0 || (tcp && listen(sock, 1) != 0))
+	{
+		perror("Binding the receiver socket failed");
+		return 1;
+	}
+
+	unsigned long long startTime = now();
+	unsigned long long endTime = duration > 0 ? startTime + (unsigned long long)(duration * 1e9) : 0;
+
+	if (tcp)
+		receiveTcp(sock, startTime, endTime, echo);
+	else
+		receiveUdp(sock, startTime, endTime);
+
+	close(sock);
+	summary((now() - startTime) / 1e9);
+	return 0;
+}
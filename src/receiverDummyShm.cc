@@ -0,0 +1,89 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include "shmRing.hh"
+
+using namespace std;
+
+/**
+ * Reference consumer of the shared-memory output transport (openmsc -S <NAME>)
+ *
+ * Attaches to /dev/shm/<NAME>, starts with the records published from now on and prints every EventID together with
+ * its classification. Sleeps on the doorbell of the ring while there is nothing to read.
+ */
+int main(int argc, char* argv[])
+{
+	SHM_RING_STRUCT *ring;
+	SHM_EVENT_RECORD record;
+	uint64_t cursor;
+	unsigned long long lost = 0, reportedLost = 0;
+
+	if (argc != 2)
+	{
+		cerr << "Usage: receiverDummyShm <NAME>\n";
+		return 1;
+	}
+	// openmsc creates the segment when it starts sending
+	while ((ring = ShmRingAttach(argv[1])) == NULL)
+		sleep(1);
+
+	cursor = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	cout << "Attached to /dev/shm/" << argv[1] << " with " << ring->capacity << " records\n";
+
+	for (;;)
+	{
+		if (!ShmRingRead(ring, &cursor, &record, &lost))
+		{
+			// A restarted openmsc replaces the segment
+			if (ShmRingClosed(ring))
+			{
+				ShmRingDetach(ring);
+				while ((ring = ShmRingAttach(argv[1])) == NULL)
+					sleep(1);
+				cursor = 0;
+				cout << "Re-attached to /dev/shm/" << argv[1] << "\n";
+				continue;
+			}
+			ShmRingWait(ring, cursor, 1000);
+			continue;
+		}
+
+		if (lost > reportedLost)
+		{
+			cout << "!!! " << lost - reportedLost << " EventIDs overrun\n";
+			reportedLost = lost;
+		}
+
+		cout << record.sequence << "\t" << record.scheduledTime << "\t";
+		cout.write(record.eventId, record.length);
+
+		if (record.noiseSource >= 0)
+			cout << "\tnoise source " << record.noiseSource << "\n";
+		else
+			cout << "\tuse-case " << record.useCaseId << " step " << record.step << "\n";
+	}
+
+	return 0;
+}
@@ -10,17 +10,63 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <time.h>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
+#include "wireFormat.hh"
+#include "latencyStatistics.hh"
 
 using boost::asio::ip::tcp;
 using namespace std;
 
+SEQUENCE_STATISTICS_STRUCT sequenceStatistics;	/** Loss and reordering of stamped EventIDs */
+LATENCY_HISTOGRAM_STRUCT latencyHistogram;		/** One-way latency of stamped EventIDs */
+LATENCY_HISTOGRAM_STRUCT latenessHistogram;		/** Send time - scheduled time of stamped EventIDs */
+time_t lastReport = 0;							/** Time of the last latency report */
+
+/**
+ * Decoding and accounting the wire header of a stamped EventID (openmsc -x), the latency and loss statistics are
+ * printed once per second
+ *
+ * @param data Received message
+ * @param length Length of the message
+ * @return Offset of the EventID within the message, 0 if the message is a plain EventID
+ */
+size_t stamped(const char *data, size_t length)
+{
+	WIRE_HEADER_STRUCT header;
+	struct timespec now;
+	unsigned long long receiveTime;
+
+	if (length < WIRE_HEADER_SIZE || !DecodeWireHeader(data, &header))
+		return 0;
+	clock_gettime(CLOCK_REALTIME, &now);
+	receiveTime = now.tv_sec * 1000000000ULL + now.tv_nsec;
+	SequenceStatisticsAdd(&sequenceStatistics, header.sequence);
+	LatencyHistogramAdd(&latencyHistogram, header.sendTime, receiveTime);
+	LatencyHistogramAdd(&latenessHistogram, header.scheduledTime, header.sendTime);
+	cout << "Sequence:\t\t" << header.sequence << "\n"
+			<< "Latency [us]:\t\t" << ((long long) (receiveTime - header.sendTime)) / 1000.0 << "\n"
+			<< "Lateness [us]:\t\t" << ((long long) (header.sendTime - header.scheduledTime)) / 1000.0 << endl;
+	if (now.tv_sec != lastReport)
+	{
+		lastReport = now.tv_sec;
+		cout << "####### Statistics #######\nSequence:\t";
+		SequenceStatisticsPrint(cout, &sequenceStatistics);
+		cout << "Latency [us]:\t";
+		LatencyHistogramPrint(cout, &latencyHistogram);
+		cout << "Lateness [us]:\t";
+		LatencyHistogramPrint(cout, &latenessHistogram);
+	}
+
+	return WIRE_HEADER_SIZE;
+}
+
 class session
 {
 	public:
 		session(boost::asio::io_service& io_service)
-		: socket_(io_service)
+		: socket_(io_service), pending_(0), consumed_(0)
 		{
 		}
 
@@ -31,7 +77,7 @@ class session
 
 		void start()
 		{
-		socket_.async_read_some(boost::asio::buffer(data_, max_length),
+		socket_.async_read_some(boost::asio::buffer(data_, max_length / 2),
 		boost::bind(&session::handle_read, this,
 		boost::asio::placeholders::error,
 		boost::asio::placeholders::bytes_transferred));
@@ -44,54 +90,26 @@ class session
 		{
 			if (!error)
 			{
-				tcp::endpoint sender_endpoint;
-				int sizeSource = 5,
-				  sizeDestination = 5,
-				  sizeProtocolType = 2,
-				  sizePrimitiveName = 2,
-				  informationElement = 2,
-				  informationElementValue = 3,
-				  start,
-				  end;
-				cout << "#######################" << endl;
-				start = 0;
-				end = sizeSource;
-				cout << "Source (" << end - start << "):\t\t";
-				for (int i = start; i < end; i++)
-					cout << data_[i];
-				cout << endl;
-				start += sizeSource;
-				end += sizeDestination;
-				cout << "Destination (" << end - start << "):\t";
-				for (int i = start; i < end; i++)
-					cout << data_[i];
-				cout << endl;
-				start += sizeDestination;
-				end += sizeProtocolType;
-				cout << "Protocol Type (" << end - start << "):\t";
-				for (int i = start; i < end; i++)
-					cout <<  data_[i];
-				cout << endl;
-				start += sizeProtocolType;
-				end += sizePrimitiveName;
-				cout << "Primitive Name (" << end - start << "):\t";
-				for (int i = start; i < end; i++)
-					cout << data_[i];
-				cout << endl;
-				start += sizePrimitiveName;
-				end += informationElement;
-				cout << "Information Element (" << end - start << "):";
-				for (int i = start; i < end; i++)
-					cout << data_[i];
-				cout << endl;
-				start += informationElement;
-				end += informationElementValue;
-				cout << "IE Value (" << end - start << "):\t\t";
-				for (int i = start; i < end; i++)
-					cout << data_[i];
-				cout << endl;
+				size_t available = pending_ + bytes_transferred;
+				WIRE_HEADER_STRUCT header;
+
+				// Stamped EventIDs (openmsc -x) may be split across or packed into reads, so they are deframed
+				consumed_ = 0;
+				while (available - consumed_ >= WIRE_HEADER_SIZE && DecodeWireHeader(data_ + consumed_, &header)
+						&& available - consumed_ >= (size_t) WIRE_HEADER_SIZE + header.length)
+				{
+					stamped(data_ + consumed_, WIRE_HEADER_SIZE + header.length);
+					print(data_ + consumed_ + WIRE_HEADER_SIZE);
+					consumed_ += WIRE_HEADER_SIZE + header.length;
+				}
+				if (consumed_ == 0 && (available < WIRE_HEADER_SIZE || !DecodeWireHeader(data_, &header)))
+				{
+					print(data_);
+					consumed_ = available;
+				}
+				pending_ = available;
 				boost::asio::async_write(socket_,
-				boost::asio::buffer(data_, bytes_transferred),
+				boost::asio::buffer(data_ + available - bytes_transferred, bytes_transferred),
 				boost::bind(&session::handle_write, this,
 				boost::asio::placeholders::error));
 			}
@@ -101,11 +119,68 @@ class session
 			}
 		}
 
+		/**
+		 * Printing the fields of an EventID
+		 *
+		 * @param eventId Start of the EventID
+		 */
+		void print(const char *eventId)
+		{
+			int sizeSource = 5,
+			  sizeDestination = 5,
+			  sizeProtocolType = 2,
+			  sizePrimitiveName = 2,
+			  informationElement = 2,
+			  informationElementValue = 3,
+			  start,
+			  end;
+			cout << "#######################" << endl;
+			start = 0;
+			end = sizeSource;
+			cout << "Source (" << end - start << "):\t\t";
+			for (int i = start; i < end; i++)
+				cout << eventId[i];
+			cout << endl;
+			start += sizeSource;
+			end += sizeDestination;
+			cout << "Destination (" << end - start << "):\t";
+			for (int i = start; i < end; i++)
+				cout << eventId[i];
+			cout << endl;
+			start += sizeDestination;
+			end += sizeProtocolType;
+			cout << "Protocol Type (" << end - start << "):\t";
+			for (int i = start; i < end; i++)
+				cout <<  eventId[i];
+			cout << endl;
+			start += sizeProtocolType;
+			end += sizePrimitiveName;
+			cout << "Primitive Name (" << end - start << "):\t";
+			for (int i = start; i < end; i++)
+				cout << eventId[i];
+			cout << endl;
+			start += sizePrimitiveName;
+			end += informationElement;
+			cout << "Information Element (" << end - start << "):";
+			for (int i = start; i < end; i++)
+				cout << eventId[i];
+			cout << endl;
+			start += informationElement;
+			end += informationElementValue;
+			cout << "IE Value (" << end - start << "):\t\t";
+			for (int i = start; i < end; i++)
+				cout << eventId[i];
+			cout << endl;
+		}
+
 	void handle_write(const boost::system::error_code& error)
 	{
 		if (!error)
 		{
-			socket_.async_read_some(boost::asio::buffer(data_, max_length),
+			// Keeping the incomplete stamped EventID at the end of the read for the next one
+			memmove(data_, data_ + consumed_, pending_ - consumed_);
+			pending_ -= consumed_;
+			socket_.async_read_some(boost::asio::buffer(data_ + pending_, max_length / 2),
 			boost::bind(&session::handle_read, this,
 			boost::asio::placeholders::error,
 			boost::asio::placeholders::bytes_transferred));
@@ -117,8 +192,10 @@ class session
 	}
 
 	tcp::socket socket_;
-	enum { max_length = 1024 };
+	enum { max_length = 2 * (WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH) };
 	char data_[max_length];
+	size_t pending_,	/** Bytes in data_ */
+		consumed_;		/** Bytes of data_ which have been printed */
 };
 
 class server
@@ -171,6 +248,8 @@ int main(int argc, char* argv[])
 
 		boost::asio::io_service io_service;
 
+		LatencyHistogramReset(&latencyHistogram);
+		LatencyHistogramReset(&latenessHistogram);
 		using namespace std; // For atoi.
 		server s(io_service, atoi(argv[1]));
 
@@ -34,11 +34,57 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <time.h>
 #include <boost/asio.hpp>
+#include "wireFormat.hh"
+#include "latencyStatistics.hh"
 
 using boost::asio::ip::udp;
 using namespace std;
-enum { max_length = 1024 };
+enum { max_length = WIRE_HEADER_SIZE + WIRE_MAX_EVENT_ID_LENGTH };
+
+SEQUENCE_STATISTICS_STRUCT sequenceStatistics;	/** Loss and reordering of stamped EventIDs */
+LATENCY_HISTOGRAM_STRUCT latencyHistogram;		/** One-way latency of stamped EventIDs */
+LATENCY_HISTOGRAM_STRUCT latenessHistogram;		/** Send time - scheduled time of stamped EventIDs */
+time_t lastReport = 0;							/** Time of the last latency report */
+
+/**
+ * Decoding and accounting the wire header of a stamped EventID (openmsc -x), the latency and loss statistics are
+ * printed once per second
+ *
+ * @param data Received message
+ * @param length Length of the message
+ * @return Offset of the EventID within the message, 0 if the message is a plain EventID
+ */
+size_t stamped(const char *data, size_t length)
+{
+	WIRE_HEADER_STRUCT header;
+	struct timespec now;
+	unsigned long long receiveTime;
+
+	if (length < WIRE_HEADER_SIZE || !DecodeWireHeader(data, &header))
+		return 0;
+	clock_gettime(CLOCK_REALTIME, &now);
+	receiveTime = now.tv_sec * 1000000000ULL + now.tv_nsec;
+	SequenceStatisticsAdd(&sequenceStatistics, header.sequence);
+	LatencyHistogramAdd(&latencyHistogram, header.sendTime, receiveTime);
+	LatencyHistogramAdd(&latenessHistogram, header.scheduledTime, header.sendTime);
+	cout << "Sequence:\t\t" << header.sequence << "\n"
+			<< "Latency [us]:\t\t" << ((long long) (receiveTime - header.sendTime)) / 1000.0 << "\n"
+			<< "Lateness [us]:\t\t" << ((long long) (header.sendTime - header.scheduledTime)) / 1000.0 << endl;
+	if (now.tv_sec != lastReport)
+	{
+		lastReport = now.tv_sec;
+		cout << "####### Statistics #######\nSequence:\t";
+		SequenceStatisticsPrint(cout, &sequenceStatistics);
+		cout << "Latency [us]:\t";
+		LatencyHistogramPrint(cout, &latencyHistogram);
+		cout << "Lateness [us]:\t";
+		LatencyHistogramPrint(cout, &latenessHistogram);
+	}
+
+	return WIRE_HEADER_SIZE;
+}
 
 void server(boost::asio::io_service& io_service, unsigned short port)
 {
@@ -57,41 +103,42 @@ void server(boost::asio::io_service& io_service, unsigned short port)
 		udp::endpoint sender_endpoint;
 		size_t length = sock.receive_from(boost::asio::buffer(data, max_length), sender_endpoint);
 		cout << "#######################\nReceived msg from " << sender_endpoint.address() << ":\n";
+		const char *eventId = data + stamped(data, length);
 		start = 0;
 		end = sizeSource;
 		cout << "Source (" << end - start << "):\t\t";
 		for (int i = start; i < end; i++)
-			cout << data[i];
+			cout << eventId[i];
 		cout << endl;
 		start += sizeSource;
 		end += sizeDestination;
 		cout << "Destination (" << end - start << "):\t";
 		for (int i = start; i < end; i++)
-			cout << data[i];
+			cout << eventId[i];
 		cout << endl;
 		start += sizeDestination;
 		end += sizeProtocolType;
 		cout << "Protocol Type (" << end - start << "):\t";
 		for (int i = start; i < end; i++)
-			cout <<  data[i];
+			cout <<  eventId[i];
 		cout << endl;
 		start += sizeProtocolType;
 		end += sizePrimitiveName;
 		cout << "Primitive Name (" << end - start << "):\t";
 		for (int i = start; i < end; i++)
-			cout << data[i];
+			cout << eventId[i];
 		cout << endl;
 		start += sizePrimitiveName;
 		end += informationElement;
 		cout << "Information Element (" << end - start << "):";
 		for (int i = start; i < end; i++)
-			cout << data[i];
+			cout << eventId[i];
 		cout << endl;
 		start += informationElement;
 		end += informationElementValue;
 		cout << "IE Value (" << end - start << "):\t\t";
 		for (int i = start; i < end; i++)
-			cout << data[i];
+			cout << eventId[i];
 		cout << endl;
 		//sock.send_to(boost::asio::buffer(data, length), sender_endpoint);
 	}
@@ -109,6 +156,8 @@ int main(int argc, char* argv[])
 
 		boost::asio::io_service io_service;
 
+		LatencyHistogramReset(&latencyHistogram);
+		LatencyHistogramReset(&latenessHistogram);
 		using namespace std; // For atoi.
 		server(io_service, atoi(argv[1]));
 	}
@@ -0,0 +1,178 @@
+#!/bin/bash
+#
+# @author Sebastian Robitzsch <srobitzsch@gmail.com>
+#
+# @section LICENSE
+#
+# OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+#
+# Copyright (C) 2013-2014 Sebastian Robitzsch
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Runs the benchmark scenarios in doc/example/scenarios end-to-end against bin/receiverBenchmark and reports the maximal
+# sustainable EventID rate of each. The load of a scenario is stepped up by multiplying all values tagged [load] (and
+# dividing all values tagged [load-inverse]) in its openmsc.cfg until the p99 lateness or the loss exceeds its limit.
+#
+# Run the script using the following command (requires 'make openmsc receiverBenchmark'):
+# ./runScenarios.sh [-d <SECONDS>] [-l <MICROSECONDS>] [-o <PERCENT>] [-f <FACTOR>] [-m <STEPS>] [-p <PORT>] [<SCENARIO> ...]
+
+root=$(cd "$(dirname "$0")/../.." && pwd)
+scenarioDir=$root/doc/example/scenarios
+openmsc=$root/bin/openmsc
+receiver=$root/bin/receiverBenchmark
+
+duration=10		# seconds per load step
+maxLateness=10000	# maximal p99 lateness [us]
+maxLoss=0.1		# maximal loss [%]
+factor=2		# load factor between two steps
+maxSteps=8		# maximal number of load steps per scenario
+port=5000
+
+usage()
+{
+	echo "Usage: $0 [-d <SECONDS>] [-l <MICROSECONDS>] [-o <PERCENT>] [-f <FACTOR>] [-m <STEPS>] [-p <PORT>] [<SCENARIO> ...]"
+	echo "  -d  Duration of a load step (default $duration)"
+	echo "  -l  Maximal p99 lateness of the sender (default $maxLateness)"
+	echo "  -o  Maximal loss (default $maxLoss)"
+	echo "  -f  Load factor between two steps (default $factor)"
+	echo "  -m  Maximal number of load steps per scenario (default $maxSteps)"
+	echo "  -p  UDP port of the receiver (default $port)"
+	echo "Scenarios (default all): $(cd "$scenarioDir" && ls -d */ | tr -d '/' | tr '\n' ' ')"
+	exit 1
+}
+
+while getopts "d:l:o:f:m:p:h" option
+do
+	case $option in
+	d) duration=$OPTARG ;;
+	l) maxLateness=$OPTARG ;;
+	o) maxLoss=$OPTARG ;;
+	f) factor=$OPTARG ;;
+	m) maxSteps=$OPTARG ;;
+	p) port=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+scenarios="$*"
+if [ -z "$scenarios" ]
+then
+	scenarios=$(cd "$scenarioDir" && ls -d */ | tr -d '/')
+fi
+
+for binary in "$openmsc" "$receiver"
+do
+	if [ ! -x "$binary" ]
+	then
+		echo "$binary not found, run 'make openmsc receiverBenchmark' in src first" >&2
+		exit 1
+	fi
+done
+
+# Writing openmsc.cfg with all [load] values multiplied and all [load-inverse] values divided by the load factor
+scaleConfig()
+{
+	awk -v load="$1" '
+	function scale(line, f,    pre, value, post, out, n, token)
+	{
+		# only the value between "=" and ";" is scaled, the comment may contain numbers as well
+		pre = substr(line, 1, index(line, "="))
+		value = substr(line, index(line, "=") + 1)
+		post = substr(value, index(value, ";"))
+		value = substr(value, 1, index(value, ";") - 1)
+		out = ""
+		while (match(value, /[0-9]+(\.[0-9]+)?([eE][-+]?[0-9]+)?/))
+		{
+			token = substr(value, RSTART, RLENGTH)
+			n = sprintf("%.6g", token * f)
+			# keep floats floats, libconfig does not convert between int and float settings
+			if (token ~ /\./ && n !~ /[.eE]/)
+				n = n ".0"
+			out = out substr(value, 1, RSTART - 1) n
+			value = substr(value, RSTART + RLENGTH)
+		}
+		return pre out value post
+	}
+	/=.*\[load\]/ { print scale($0, load); next }
+	/=.*\[load-inverse\]/ { print scale($0, 1 / load); next }
+	{ print }'
+}
+
+# Mean EventID rate of the per-second reports, skipping the ramp-up and the last (partial) second
+meanRate()
+{
+	awk '/^[0-9.]+s\t/ { rate = $2 + 0; if (rate > 0 || n > 0) r[n++] = rate }
+	END { s = 0; c = 0; for (i = 1; i < n - 1; i++) { s += r[i]; c++ } printf "%.0f", (c > 0 ? s / c : 0) }' "$1"
+}
+
+printf "%-20s %8s %12s %14s %10s %8s %10s\n" "Scenario" "Load" "EventIDs/s" "p99 late [us]" "Loss [%]" "CPU [%]" "RSS [MB]"
+
+for scenario in $scenarios
+do
+	if [ ! -f "$scenarioDir/$scenario/openmsc.cfg" ] || [ ! -f "$scenarioDir/$scenario/openmsc.msc" ]
+	then
+		echo "Scenario $scenario not found in $scenarioDir" >&2
+		continue
+	fi
+
+	load=1
+	best=""
+	for ((step = 0; step < maxSteps; step++))
+	do
+		workDir=$(mktemp -d)
+		cp "$scenarioDir/$scenario/openmsc.msc" "$workDir"
+		scaleConfig $load < "$scenarioDir/$scenario/openmsc.cfg" > "$workDir/openmsc.cfg"
+
+		"$receiver" -s "$port" > "$workDir/receiver.txt" &
+		receiverPid=$!
+		sleep 0.5
+		(cd "$workDir" && /usr/bin/time -f "%U %S %M" -o time.txt \
+				timeout -s INT "$duration" "$openmsc" -d ERROR -x -u -i 127.0.0.1 -p "$port" > openmsc.txt 2>&1)
+		sleep 0.5
+		kill -INT $receiverPid
+		wait $receiverPid
+
+		rate=$(meanRate "$workDir/receiver.txt")
+		loss=$(awk -F'[()%]' '/^Sequence:/ { print $2 + 0 }' "$workDir/receiver.txt")
+		lateness=$(awk '/^Lateness/ { for (i = 1; i < NF; i++) if ($i == "p99") print $(i + 1) }' "$workDir/receiver.txt")
+		read user system rss < <(tail -1 "$workDir/time.txt")
+		cpu=$(awk -v u="$user" -v s="$system" -v d="$duration" 'BEGIN { printf "%.0f", 100 * (u + s) / d }')
+		rss=$(awk -v m="$rss" 'BEGIN { printf "%.1f", m / 1024 }')
+		rm -rf "$workDir"
+
+		if [ -z "$lateness" ] || [ -z "$loss" ]
+		then
+			echo "$scenario: no stamped EventIDs received at load $load" >&2
+			break
+		fi
+
+		sustainable=$(awk -v l="$lateness" -v ml="$maxLateness" -v o="$loss" -v mo="$maxLoss" \
+				'BEGIN { print ((l <= ml && o <= mo) ? 1 : 0) }')
+		if [ "$sustainable" -eq 0 ]
+		then
+			break
+		fi
+		best=$(printf "%-20s %8s %12s %14s %10s %8s %10s" "$scenario" "$load" "$rate" "$lateness" "$loss" "$cpu" "$rss")
+		load=$(awk -v l="$load" -v f="$factor" 'BEGIN { printf "%g", l * f }')
+	done
+
+	if [ -n "$best" ]
+	then
+		echo "$best"
+	else
+		printf "%-20s %8s\n" "$scenario" "-"
+	fi
+done
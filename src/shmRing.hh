@@ -0,0 +1,354 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Shared-memory output transport for consumers on the same host
+ *
+ * openmsc -S <NAME> publishes every EventID as a fixed-size binary record into a ring in the POSIX shared memory
+ * segment /dev/shm/<NAME>. The ring has a single producer (one sender thread) and any number of consumers: every
+ * consumer keeps its own read position and sees all records, nobody takes records away from the others. The producer
+ * never waits for the consumers - a consumer falling behind by more than the capacity of the ring is overrun and can
+ * tell how many records it has lost from the sequence numbers.
+ *
+ * Publishing a record is a plain store into the segment. The producer only enters the kernel (FUTEX_WAKE on the
+ * doorbell) if a consumer has announced that it went to sleep, so busy consumers read without any syscall per EventID.
+ *
+ * Every record carries its sequence number, written last by the producer. A consumer copies a record and checks the
+ * sequence number before and after copying, so a record overwritten while it was read is detected (seqlock).
+ */
+#define SHM_RING_MAGIC 0x4f4d5343		/** 'OMSC' */
+#define SHM_RING_VERSION 1
+#define SHM_RING_DEFAULT_CAPACITY 1048576	/** Records in the ring (128 MB) */
+#define SHM_MAX_EVENT_ID_LENGTH 92		/** Longer EventIDs are truncated (SHM_RECORD_TRUNCATED) */
+#define SHM_RECORD_TRUNCATED 0x1
+
+/**
+ * \typedef SHM_EVENT_RECORD
+ * \brief Fixed-size binary EventID record of 128 bytes (two cache lines)
+ */
+typedef struct shmEventRecord {
+	uint64_t sequence;		/** Sequence number + 1 in the ring (0 = never written), the plain sequence number once read */
+	uint64_t scheduledTime;	/** Time [ns] the EventID was scheduled for */
+	uint64_t sendTime;		/** Time [ns] the EventID was published */
+	uint16_t useCaseId;		/** Use-case of a pattern EventID, 0 for noise */
+	uint16_t step;			/** Communication descriptor of a pattern EventID */
+	int16_t noiseSource;	/** Noise source (0 = uncorrelated, i + 1 = correlated i), -1 for pattern EventIDs */
+	uint8_t flags;			/** SHM_RECORD_TRUNCATED */
+	uint8_t length;			/** Length of the EventID */
+	char eventId[SHM_MAX_EVENT_ID_LENGTH];	/** The EventID, not terminated */
+} SHM_EVENT_RECORD;
+
+/**
+ * \typedef SHM_RING_STRUCT
+ * \brief Layout of the shared memory segment: header, producer position, doorbell and the records
+ */
+typedef struct shmRing {
+	uint32_t magic;			/** SHM_RING_MAGIC, written last when the segment has been set up */
+	uint32_t version;		/** SHM_RING_VERSION */
+	uint32_t recordSize;	/** sizeof(SHM_EVENT_RECORD) */
+	uint32_t capacity;		/** Number of records, a power of two */
+	char padding0[48];
+	volatile uint64_t head;	/** Number of records published so far */
+	char padding1[56];
+	volatile int32_t doorbell;	/** Futex word, incremented whenever sleeping consumers are woken up */
+	volatile int32_t sleepers;	/** Number of consumers waiting on the doorbell */
+	char padding2[56];
+	SHM_EVENT_RECORD records[1];	/** capacity records */
+} SHM_RING_STRUCT;
+
+/**
+ * Size of the shared memory segment holding a ring
+ * @param capacity Number of records
+ * @return Size in bytes
+ */
+static inline size_t ShmRingSize(uint32_t capacity)
+{
+	return sizeof(SHM_RING_STRUCT) + (capacity - 1) * sizeof(SHM_EVENT_RECORD);
+}
+
+/**
+ * Building the path of the segment for shm_open()
+ * @param name The name of the segment, with or without leading '/'
+ * @param path Buffer of 256 bytes into which the path is written
+ */
+static inline void ShmRingPath(const char *name, char *path)
+{
+	path[0] = '/';
+	strncpy(path + 1, name[0] == '/' ? name + 1 : name, 254);
+	path[255] = '\0';
+}
+
+/**
+ * Marking the ring in /dev/shm/<name> as closed, so consumers still attached to it re-attach to its successor
+ * @param name The name of the segment
+ */
+static inline void ShmRingClose(const char *name)
+{
+	char path[256];
+	struct stat status;
+	int fd;
+	void *segment;
+
+	ShmRingPath(name, path);
+	fd = shm_open(path, O_RDWR, 0);
+
+	if (fd < 0)
+		return;
+
+	if (fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(SHM_RING_STRUCT))
+	{
+		segment = mmap(NULL, sizeof(SHM_RING_STRUCT), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if (segment != MAP_FAILED)
+		{
+			SHM_RING_STRUCT *ring = (SHM_RING_STRUCT *)segment;
+			__atomic_store_n(&ring->magic, 0, __ATOMIC_SEQ_CST);
+			__atomic_fetch_add(&ring->doorbell, 1, __ATOMIC_RELEASE);
+			syscall(SYS_futex, &ring->doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+			munmap(segment, sizeof(SHM_RING_STRUCT));
+		}
+	}
+
+	close(fd);
+}
+
+/**
+ * Creating a ring in /dev/shm/<name>, replacing (and closing) an existing one
+ * @param name The name of the segment
+ * @param capacity Minimal number of records (rounded up to a power of two)
+ * @return The mapped ring or NULL on failure
+ */
+static inline SHM_RING_STRUCT * ShmRingCreate(const char *name, uint32_t capacity)
+{
+	uint32_t n = 1;
+	char path[256];
+	int fd;
+	void *segment;
+
+	while (n < capacity)
+		n <<= 1;
+
+	ShmRingPath(name, path);
+	ShmRingClose(name);
+	shm_unlink(path);
+	fd = shm_open(path, O_CREAT | O_RDWR, 0644);
+
+	if (fd < 0)
+		return NULL;
+
+	if (ftruncate(fd, ShmRingSize(n)) != 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	segment = mmap(NULL, ShmRingSize(n), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (segment == MAP_FAILED)
+		return NULL;
+	// The segment is zero-filled by ftruncate, i.e. all records are marked as never written
+	SHM_RING_STRUCT *ring = (SHM_RING_STRUCT *)segment;
+	ring->version = SHM_RING_VERSION;
+	ring->recordSize = sizeof(SHM_EVENT_RECORD);
+	ring->capacity = n;
+	ring->head = 0;
+	ring->doorbell = 0;
+	ring->sleepers = 0;
+	__atomic_store_n(&ring->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+	return ring;
+}
+
+/**
+ * Attaching to an existing ring in /dev/shm/<name>
+ * @param name The name of the segment
+ * @return The mapped ring or NULL if it does not exist (yet) or is incompatible
+ */
+static inline SHM_RING_STRUCT * ShmRingAttach(const char *name)
+{
+	char path[256];
+	struct stat status;
+	int fd;
+	void *segment;
+
+	ShmRingPath(name, path);
+	// Consumers only write the sleepers counter, but that requires a writable mapping
+	fd = shm_open(path, O_RDWR, 0);
+
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(SHM_RING_STRUCT))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	segment = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (segment == MAP_FAILED)
+		return NULL;
+
+	SHM_RING_STRUCT *ring = (SHM_RING_STRUCT *)segment;
+
+	if (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC || ring->version != SHM_RING_VERSION
+			|| ring->recordSize != sizeof(SHM_EVENT_RECORD) || (size_t)status.st_size < ShmRingSize(ring->capacity))
+	{
+		munmap(segment, status.st_size);
+		return NULL;
+	}
+
+	return ring;
+}
+
+/**
+ * Publishing an EventID (producer only)
+ * @param ring The ring
+ * @param eventId The EventID
+ * @param length Length of the EventID
+ * @param scheduledTime Time [ns] the EventID was scheduled for
+ * @param sendTime Time [ns] the EventID is published
+ * @param useCaseId Use-case of a pattern EventID, 0 for noise
+ * @param step Communication descriptor of a pattern EventID
+ * @param noiseSource Noise source, -1 for pattern EventIDs
+ */
+static inline void ShmRingPublish(SHM_RING_STRUCT *ring, const char *eventId, size_t length, uint64_t scheduledTime,
+		uint64_t sendTime, uint16_t useCaseId, uint16_t step, int16_t noiseSource)
+{
+	uint64_t sequence = ring->head;
+	SHM_EVENT_RECORD *record = &ring->records[sequence & (ring->capacity - 1)];
+	// Invalidating the slot first, so a consumer copying it meanwhile detects the overwrite
+	__atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	record->scheduledTime = scheduledTime;
+	record->sendTime = sendTime;
+	record->useCaseId = useCaseId;
+	record->step = step;
+	record->noiseSource = noiseSource;
+	record->flags = length > SHM_MAX_EVENT_ID_LENGTH ? SHM_RECORD_TRUNCATED : 0;
+	record->length = length > SHM_MAX_EVENT_ID_LENGTH ? SHM_MAX_EVENT_ID_LENGTH : length;
+	memcpy(record->eventId, eventId, record->length);
+	__atomic_store_n(&record->sequence, sequence + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->head, sequence + 1, __ATOMIC_RELEASE);
+	// Only ring the doorbell if somebody sleeps - the fence orders the head store before the sleepers load
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&ring->sleepers, __ATOMIC_RELAXED) > 0)
+	{
+		__atomic_fetch_add(&ring->doorbell, 1, __ATOMIC_RELEASE);
+		syscall(SYS_futex, &ring->doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	}
+}
+
+/**
+ * Reading the next record (consumer)
+ * @param ring The ring
+ * @param cursor Pointer to the sequence number the consumer reads next. Moved past overrun records
+ * @param record Pointer into which the record is copied
+ * @param lost Pointer to which the number of records lost due to an overrun is added
+ * @return false if there is no new record
+ */
+static inline bool ShmRingRead(SHM_RING_STRUCT *ring, uint64_t *cursor, SHM_EVENT_RECORD *record,
+		unsigned long long *lost)
+{
+	for (;;)
+	{
+		uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+		if (*cursor >= head)
+			return false;
+		// Fallen behind by more than the ring - skipping to the oldest record which can still be valid
+		if (head - *cursor > ring->capacity)
+		{
+			*lost += head - ring->capacity - *cursor;
+			*cursor = head - ring->capacity;
+		}
+
+		const SHM_EVENT_RECORD *slot = &ring->records[*cursor & (ring->capacity - 1)];
+		uint64_t before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		memcpy(record, (const void *)slot, sizeof(SHM_EVENT_RECORD));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		uint64_t after = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+
+		if (before == *cursor + 1 && after == before)
+		{
+			record->sequence = *cursor;
+			(*cursor)++;
+			return true;
+		}
+		// Overwritten while copying - the producer is a full ring ahead, so the next round skips forward
+		(*lost)++;
+		(*cursor)++;
+	}
+}
+
+/**
+ * Waiting for new records (consumer). Returns immediately if there are records after the cursor.
+ * @param ring The ring
+ * @param cursor The sequence number the consumer reads next
+ * @param timeoutMs Maximal time to wait [ms]
+ */
+static inline void ShmRingWait(SHM_RING_STRUCT *ring, uint64_t cursor, long timeoutMs)
+{
+	struct timespec timeout;
+	int32_t doorbell = __atomic_load_n(&ring->doorbell, __ATOMIC_ACQUIRE);
+
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+	__atomic_fetch_add(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+	// Re-checking after announcing the sleep: a record published meanwhile is either seen here or rings the doorbell
+	if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) <= cursor)
+		syscall(SYS_futex, &ring->doorbell, FUTEX_WAIT, doorbell, &timeout, NULL, 0);
+
+	__atomic_fetch_sub(&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Checking whether the producer has replaced the ring (consumer)
+ * @param ring The ring
+ * @return true if the ring has been closed and the consumer should detach and attach again
+ */
+static inline bool ShmRingClosed(SHM_RING_STRUCT *ring)
+{
+	return __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC;
+}
+
+/**
+ * Unmapping a ring (consumer)
+ * @param ring The ring
+ */
+static inline void ShmRingDetach(SHM_RING_STRUCT *ring)
+{
+	munmap(ring, ShmRingSize(ring->capacity));
+}
@@ -0,0 +1,1021 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Offline analysis of a stream written by 'openmsc -f'. All patterns of patterns.csv are matched against
+ * eventStream.tsv in a single pass:
+ *
+ * - Both files are memory-mapped, EventIDs are hashed in place and never copied.
+ * - patterns.csv is compiled into a trie. A match follows the trie with the EventIDs of the stream. An EventID
+ *   continues the youngest open match waiting for it, otherwise it starts a new match if a pattern begins with it.
+ *   Preferring the youngest match keeps an instance which lost an EventID from taking the EventIDs of the next
+ *   instance of the same pattern.
+ * - A match is closed when it reaches a leaf or when it is older than the maximal instance duration (-m). It is a
+ *   complete pattern instance if it stopped at the end of a pattern.
+ * - The window is cut into time slices which are matched in parallel (-j). Every slice first replays one maximal
+ *   instance duration of the preceding stream to recover the matches still open at its start, and follows its own
+ *   matches past its end until they are closed. As a match only competes with younger ones, the result is the same
+ *   as with a single slice.
+ *
+ * Written to the working directory, in the format of the former scripts/plotStreamOverTime.awk:
+ *
+ * eventStreamPatternColoured		<time> <EventID index> <PID> of all complete instances, one block per instance
+ * eventStreamPatternStartColoured	First EventID of every complete instance
+ * eventStreamOrdinary				EventIDs of patterns which are not part of a complete instance
+ * eventStreamNoiseColoured			EventIDs which do not appear in any pattern, i.e. noise and periodic EventIDs
+ * hashedEventIds					<EventID> <index>, indices are assigned in the order of first appearance
+ * patternStatistics.tsv			Complete and incomplete instances and their duration per PID
+ * gnuplot.plt						Plot of all series ('gnuplot gnuplot.plt' creates streamOverTime.(png|eps))
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#define NONE 0xffffffff				/** No symbol, node, match or instance */
+#define FOREIGN 0xfffffffe			/** EventID taken by a match started before the time slice */
+#define OUTPUT_BUFFER_SIZE 4194304	/** stdio buffer of every output file */
+#define RGB_COLOUR_PATTERN_1 "#c74f10"	/** OpenMSC colour */
+#define RGB_COLOUR_PATTERN_2 "#C7AA10"	/** Adjacent colour to OpenMSC colour */
+#define RGB_COLOUR_NOISE "#80ADFF"
+
+/**
+ * Memory-mapped input file
+ */
+struct mappedFile {
+	const char *data;	/** First byte of the file */
+	const char *end;	/** Byte after the last one of the file */
+};
+
+/**
+ * EventID symbol table. Symbols point into the memory-mapped files and are found by open addressing over their FNV-1a
+ * hash.
+ */
+struct symbolTable {
+	vector<uint32_t> slots;			/** Symbol + 1, 0 for an empty slot. The size is a power of two */
+	vector<const char *> begin;		/** First byte of every symbol */
+	vector<uint32_t> length;		/** Length of every symbol */
+	vector<uint32_t> hash;			/** Hash of every symbol */
+};
+
+/**
+ * Node of the pattern trie. The root is node 0.
+ */
+struct trieNode {
+	uint32_t symbol;		/** EventID leading to this node */
+	uint32_t firstChild;	/** First child, NONE for a leaf */
+	uint32_t nextSibling;	/** Next child of the parent */
+	uint32_t pid;			/** Pattern ending at this node, 0 if none */
+	uint32_t anyPid;		/** First pattern through this node, incomplete instances are attributed to it */
+};
+
+/**
+ * EventID of the analysed window
+ */
+struct eventRecord {
+	const char *line;		/** Line in eventStream.tsv */
+	uint32_t symbol;		/** Pattern symbol, or the number of pattern symbols + the index of the noise symbol */
+	uint32_t instance;		/** Pattern instance, NONE if unmatched, FOREIGN if owned by an earlier time slice */
+};
+
+/**
+ * Pattern instance, i.e. a closed match started in the time slice
+ */
+struct instanceRecord {
+	uint32_t pid;			/** Matched pattern, or the pattern an incomplete instance is attributed to */
+	bool complete;			/** Stopped at the end of a pattern */
+	double start;			/** Time of the first EventID */
+	double end;				/** Time of the last EventID */
+};
+
+/**
+ * Open or closed match of a time slice
+ */
+struct matchState {
+	uint32_t node;			/** Current trie node */
+	uint32_t instance;		/** Instance of the time slice, FOREIGN if started outside of it */
+	bool open;
+};
+
+/**
+ * Match waiting for an EventID. Entries become stale when their match moves on or is closed and are removed lazily.
+ */
+struct waitEntry {
+	uint32_t match;			/** Waiting match */
+	uint32_t from;			/** Node of the match when the entry was made */
+	uint32_t to;			/** Node reached with the EventID */
+	uint32_t next;			/** Next entry of the same EventID, youngest match first */
+};
+
+/**
+ * Time slice of the window, matched by its own thread
+ */
+struct timeSlice {
+	const char *warmUp;		/** First line replayed to recover the open matches */
+	const char *begin;		/** First line of the slice */
+	const char *end;		/** Line after the slice */
+	pthread_t thread;
+	vector<eventRecord> events;		/** All EventIDs of the slice */
+	vector<instanceRecord> instances;	/** Instances started in the slice */
+	vector< pair<const char *, uint32_t> > tail;	/** EventIDs after the slice taken by its instances */
+	symbolTable noise;				/** EventIDs of the slice which are not in patterns.csv */
+	vector<uint32_t> noiseMap;		/** Slice noise symbol -> global noise symbol */
+	uint32_t instanceBase;			/** Global index of the first instance */
+};
+
+/**
+ * Matching state of a time slice
+ */
+struct matcher {
+	timeSlice *slice;
+	vector<matchState> matches;
+	vector<uint32_t> waitHead;		/** First wait entry per pattern symbol */
+	vector<waitEntry> waits;
+	uint32_t freeWait;				/** First unused wait entry */
+	deque< pair<double, uint32_t> > started;	/** <start time, match> of all matches in the order of their start */
+	uint32_t openOwn;				/** Open matches started in the slice */
+};
+
+double maxDuration = 30;		/** Age closing a match [s] */
+uint32_t colouredPid = 0;		/** Only colour this pattern (-P), 0 for all */
+symbolTable patternSymbols;		/** EventIDs of patterns.csv */
+vector<trieNode> trie;
+vector<uint32_t> rootChild;		/** Child of the root per pattern symbol */
+vector<uint32_t> patternLength;	/** Number of EventIDs per PID, index 0 unused */
+const char *windowEnd;			/** Line after the analysed window */
+
+uint32_t hashBytes(const char *p, uint32_t length)
+{
+	uint32_t h = 2166136261u;
+
+	for (uint32_t i = 0; i < length; i++)
+	{
+		h ^= (unsigned char)p[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+void initTable(symbolTable *table, size_t capacity)
+{
+	size_t size = 1024;
+
+	while (size < 2 * capacity)
+		size *= 2;
+
+	table->slots.assign(size, 0);
+}
+
+uint32_t findSymbol(const symbolTable *table, const char *p, uint32_t length, uint32_t h)
+{
+	size_t mask = table->slots.size() - 1;
+
+	for (size_t i = h & mask; table->slots[i] != 0; i = (i + 1) & mask)
+	{
+		uint32_t s = table->slots[i] - 1;
+
+		if (table->hash[s] == h && table->length[s] == length && memcmp(table->begin[s], p, length) == 0)
+			return s;
+	}
+
+	return NONE;
+}
+
+uint32_t addSymbol(symbolTable *table, const char *p, uint32_t length, uint32_t h)
+{
+	uint32_t s = findSymbol(table, p, length, h);
+
+	if (s != NONE)
+		return s;
+
+	s = table->begin.size();
+	table->begin.push_back(p);
+	table->length.push_back(length);
+	table->hash.push_back(h);
+
+	// Keeping the load factor below 1/2
+	if (2 * table->begin.size() > table->slots.size())
+	{
+		table->slots.assign(2 * table->slots.size(), 0);
+
+		for (uint32_t i = 0; i < s; i++)
+		{
+			size_t mask = table->slots.size() - 1, slot = table->hash[i] & mask;
+
+			while (table->slots[slot] != 0)
+				slot = (slot + 1) & mask;
+
+			table->slots[slot] = i + 1;
+		}
+	}
+
+	size_t mask = table->slots.size() - 1, slot = h & mask;
+
+	while (table->slots[slot] != 0)
+		slot = (slot + 1) & mask;
+
+	table->slots[slot] = s + 1;
+
+	return s;
+}
+
+bool mapFile(const char *fileName, mappedFile *file)
+{
+	struct stat st;
+	int fd = open(fileName, O_RDONLY);
+
+	if (fd == -1 || fstat(fd, &st) == -1)
+	{
+		cerr << "Opening " << fileName << " failed: " << strerror(errno) << endl;
+		return false;
+	}
+
+	file->data = "";
+
+	if (st.st_size > 0)
+	{
+		void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data == MAP_FAILED)
+		{
+			cerr << "Mapping " << fileName << " failed: " << strerror(errno) << endl;
+			close(fd);
+			return false;
+		}
+
+		madvise(data, st.st_size, MADV_SEQUENTIAL);
+		file->data = (const char *)data;
+	}
+
+	file->end = file->data + st.st_size;
+	close(fd);
+
+	return true;
+}
+
+/**
+ * Start of the line p points into, or the next line if p is within a line
+ */
+const char *lineAt(const char *p, const char *begin, const char *end)
+{
+	if (p <= begin || p[-1] == '\n')
+		return p;
+
+	const char *newLine = (const char *)memchr(p, '\n', end - p);
+
+	return newLine == NULL ? end : newLine + 1;
+}
+
+const char *nextLine(const char *p, const char *end)
+{
+	const char *newLine = (const char *)memchr(p, '\n', end - p);
+
+	return newLine == NULL ? end : newLine + 1;
+}
+
+/**
+ * Parsing an eventStream.tsv line '<time>\t<EventID>'
+ * @return The next line
+ */
+const char *parseLine(const char *line, const char *end, double *time, const char **id, uint32_t *length)
+{
+	const char *next = nextLine(line, end), *lineEnd = next;
+	const char *tab = (const char *)memchr(line, '\t', next - line);
+	char buffer[64];
+
+	*length = 0;
+
+	if (tab == NULL || tab - line >= (ptrdiff_t)sizeof(buffer))
+		return next;
+
+	while (lineEnd > tab + 1 && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r'))
+		lineEnd--;
+
+	memcpy(buffer, line, tab - line);
+	buffer[tab - line] = '\0';
+	*time = strtod(buffer, NULL);
+	*id = tab + 1;
+	*length = lineEnd - tab - 1;
+
+	return next;
+}
+
+double lineTime(const char *line, const char *end)
+{
+	double time = 0;
+	const char *id;
+	uint32_t length;
+
+	parseLine(line, end, &time, &id, &length);
+
+	return time;
+}
+
+/**
+ * First line in [begin, end) with a time >= time (after = false) or > time (after = true). The stream is ordered by
+ * time, so this is a binary search over the bytes.
+ */
+const char *seekTime(const char *begin, const char *end, double time, bool after)
+{
+	const char *low = begin, *high = end;
+
+	while (low < high)
+	{
+		const char *middle = lineAt(low + (high - low) / 2, begin, end);
+
+		if (middle >= high)
+			middle = low;
+
+		double t = lineTime(middle, end);
+
+		if (after ? t > time : t >= time)
+			high = middle;
+		else
+			low = nextLine(middle, end);
+	}
+
+	return low;
+}
+
+/**
+ * Compiling patterns.csv ('<length>\t<EventID>,<EventID>,...' per line, PIDs count the lines without comments from 1)
+ * into the trie
+ */
+void readPatterns(const mappedFile &file)
+{
+	uint32_t pid = 0, duplicates = 0;
+	trieNode root = {NONE, NONE, NONE, 0, 0};
+
+	initTable(&patternSymbols, (file.end - file.data) / 8);
+	trie.push_back(root);
+	patternLength.push_back(0);
+
+	for (const char *line = file.data; line < file.end;)
+	{
+		const char *next = nextLine(line, file.end), *lineEnd = next;
+
+		while (lineEnd > line && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r'))
+			lineEnd--;
+
+		if (lineEnd == line || *line == '#')
+		{
+			line = next;
+			continue;
+		}
+
+		pid++;
+		const char *p = (const char *)memchr(line, '\t', lineEnd - line);
+		uint32_t node = 0, length = 0;
+
+		for (p = p == NULL ? lineEnd : p + 1; p < lineEnd;)
+		{
+			const char *comma = (const char *)memchr(p, ',', lineEnd - p);
+			const char *idEnd = comma == NULL ? lineEnd : comma;
+			uint32_t symbol = addSymbol(&patternSymbols, p, idEnd - p, hashBytes(p, idEnd - p)), child;
+
+			if (symbol == rootChild.size())
+				rootChild.push_back(NONE);
+
+			if (node == 0)
+				child = rootChild[symbol];
+			else
+				for (child = trie[node].firstChild; child != NONE && trie[child].symbol != symbol;
+						child = trie[child].nextSibling);
+
+			if (child == NONE)
+			{
+				trieNode n = {symbol, NONE, trie[node].firstChild, 0, pid};
+
+				child = trie.size();
+				trie.push_back(n);
+				trie[node].firstChild = child;
+
+				if (node == 0)
+					rootChild[symbol] = child;
+			}
+
+			node = child;
+			length++;
+			p = idEnd + 1;
+		}
+
+		patternLength.push_back(length);
+
+		if (node != 0 && trie[node].pid == 0)
+			trie[node].pid = pid;
+		else if (node != 0)
+			duplicates++;
+
+		line = next;
+	}
+
+	cout << "Read " << pid << " patterns with " << patternSymbols.begin.size() << " EventIDs (" << trie.size() - 1
+			<< " trie nodes)\n";
+
+	if (duplicates > 0)
+		cout << duplicates << " patterns are duplicates of earlier ones and will never be matched\n";
+}
+
+void addEvent(timeSlice *slice, const char *line, uint32_t symbol, uint32_t instance)
+{
+	eventRecord event = {line, symbol, instance};
+
+	slice->events.push_back(event);
+}
+
+/**
+ * Closing a match. It is a complete instance if it stopped at the end of a pattern.
+ */
+void closeMatch(matcher *m, uint32_t match)
+{
+	matchState &state = m->matches[match];
+
+	state.open = false;
+
+	if (state.instance == FOREIGN)
+		return;
+
+	instanceRecord &instance = m->slice->instances[state.instance];
+
+	instance.complete = trie[state.node].pid != 0;
+	instance.pid = instance.complete ? trie[state.node].pid : trie[state.node].anyPid;
+	m->openOwn--;
+}
+
+/**
+ * Moving a match to the given trie node and letting it wait for the EventIDs of the node's children
+ */
+void advanceMatch(matcher *m, uint32_t match, uint32_t node, double time)
+{
+	matchState &state = m->matches[match];
+
+	state.node = node;
+
+	if (state.instance != FOREIGN)
+		m->slice->instances[state.instance].end = time;
+
+	if (trie[node].firstChild == NONE)
+	{
+		closeMatch(m, match);
+		return;
+	}
+
+	for (uint32_t child = trie[node].firstChild; child != NONE; child = trie[child].nextSibling)
+	{
+		uint32_t entry = m->freeWait, *link = &m->waitHead[trie[child].symbol];
+
+		if (entry == NONE)
+		{
+			entry = m->waits.size();
+			m->waits.push_back(waitEntry());
+		}
+		else
+			m->freeWait = m->waits[entry].next;
+
+		// Keeping the entries ordered by match, so the youngest match gets the EventID first
+		while (*link != NONE && m->waits[*link].match > match)
+			link = &m->waits[*link].next;
+
+		m->waits[entry].match = match;
+		m->waits[entry].from = node;
+		m->waits[entry].to = child;
+		m->waits[entry].next = *link;
+		*link = entry;
+	}
+}
+
+/**
+ * Taking the youngest open match waiting for the given EventID
+ * @return The match, NONE if none is waiting
+ */
+uint32_t takeWaitingMatch(matcher *m, uint32_t symbol, uint32_t *node)
+{
+	uint32_t *link = &m->waitHead[symbol];
+
+	while (*link != NONE)
+	{
+		uint32_t entry = *link;
+		waitEntry &wait = m->waits[entry];
+		uint32_t match = wait.match;
+		bool valid = m->matches[match].open && m->matches[match].node == wait.from;
+
+		*node = wait.to;
+		*link = wait.next;
+		wait.next = m->freeWait;
+		m->freeWait = entry;
+
+		if (valid)
+			return match;
+	}
+
+	return NONE;
+}
+
+/**
+ * Closing all matches older than the maximal instance duration
+ */
+void expireMatches(matcher *m, double time)
+{
+	while (!m->started.empty() && m->started.front().first < time - maxDuration)
+	{
+		uint32_t match = m->started.front().second;
+
+		m->started.pop_front();
+
+		if (m->matches[match].open)
+			closeMatch(m, match);
+	}
+}
+
+/**
+ * Time slice thread
+ *
+ * This function matches all patterns against the EventIDs of a time slice. Lines before the slice only recover the
+ * matches open at its start, lines after it are only matched until all matches started in the slice are closed.
+ *
+ * @param pointer to the time slice
+ * @return void
+ */
+void *matchTimeSlice(void *arg)
+{
+	timeSlice *slice = (timeSlice *)arg;
+	matcher m;
+	uint32_t numOfPatternSymbols = patternSymbols.begin.size();
+
+	m.slice = slice;
+	m.waitHead.assign(numOfPatternSymbols, NONE);
+	m.freeWait = NONE;
+	m.openOwn = 0;
+	initTable(&slice->noise, 0);
+
+	for (const char *p = slice->warmUp; p < windowEnd;)
+	{
+		const char *line = p, *id;
+		double time;
+		uint32_t length, node;
+
+		p = parseLine(line, windowEnd, &time, &id, &length);
+
+		if (length == 0)
+			continue;
+
+		bool own = line >= slice->begin && line < slice->end, after = line >= slice->end;
+
+		if (after && m.openOwn == 0)
+			break;
+
+		expireMatches(&m, time);
+		uint32_t h = hashBytes(id, length);
+		uint32_t symbol = findSymbol(&patternSymbols, id, length, h);
+
+		if (symbol == NONE)
+		{
+			if (own)
+				addEvent(slice, line, numOfPatternSymbols + addSymbol(&slice->noise, id, length, h), NONE);
+			continue;
+		}
+
+		uint32_t match = takeWaitingMatch(&m, symbol, &node);
+
+		if (match == NONE && rootChild[symbol] != NONE)
+		{
+			matchState state = {0, FOREIGN, true};
+
+			if (own)
+			{
+				instanceRecord instance = {0, false, time, time};
+
+				state.instance = slice->instances.size();
+				slice->instances.push_back(instance);
+				m.openOwn++;
+			}
+
+			match = m.matches.size();
+			node = rootChild[symbol];
+			m.matches.push_back(state);
+			m.started.push_back(make_pair(time, match));
+		}
+
+		if (match == NONE)
+		{
+			if (own)
+				addEvent(slice, line, symbol, NONE);
+			continue;
+		}
+
+		uint32_t instance = m.matches[match].instance;
+
+		advanceMatch(&m, match, node, time);
+
+		if (own)
+			addEvent(slice, line, symbol, instance);
+		else if (after && instance != FOREIGN)
+			slice->tail.push_back(make_pair(line, instance));
+	}
+
+	// End of the window, or all matches of the slice are closed
+	for (uint32_t match = 0; match < m.matches.size(); match++)
+		if (m.matches[match].open)
+			closeMatch(&m, match);
+
+	return NULL;
+}
+
+FILE *openOutput(const char *fileName)
+{
+	FILE *file = fopen(fileName, "w");
+
+	if (file == NULL)
+	{
+		cerr << "Opening " << fileName << " failed: " << strerror(errno) << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	setvbuf(file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+	return file;
+}
+
+/**
+ * Writing '<time>\t<EventID index>' with the time as written by openmsc
+ */
+void writeEvent(FILE *file, const eventRecord &event, uint32_t index)
+{
+	const char *tab = (const char *)memchr(event.line, '\t', windowEnd - event.line);
+
+	fwrite(event.line, 1, tab - event.line, file);
+	fprintf(file, "\t%u", index);
+}
+
+void writeGnuplot(unsigned long numOfIds)
+{
+	FILE *file = openOutput("gnuplot.plt");
+	const char *terminals[] = {"pngcairo", "eps enhanced"}, *extensions[] = {"png", "eps"};
+	double pointSizes[][3] = {{0.1, 2, 1}, {0.1, 1, 0.3}};
+	char title[32] = "Patterns";
+
+	if (colouredPid != 0)
+		snprintf(title, sizeof(title), "Pattern ID %u", colouredPid);
+
+	fprintf(file, "set xlabel 'Time [s]'\n");
+	fprintf(file, "set title 'Total Number of IDs in this Window = %lu'\n", numOfIds);
+	fprintf(file, "set ylabel 'Identifiers'\n");
+	fprintf(file, "set grid\n");
+	fprintf(file, "set key top left\n");
+
+	for (int i = 0; i < 2; i++)
+	{
+		fprintf(file, "set terminal %s\n", terminals[i]);
+		fprintf(file, "set output 'streamOverTime.%s'\n", extensions[i]);
+		fprintf(file, "plot 'eventStreamOrdinary' using 1:2 with points pt 7 ps %g lc rgb '#555555' noti, \\\n",
+				pointSizes[i][0]);
+		fprintf(file, "'eventStreamPatternColoured' using 1:2 with line lw 2 lc rgb '%s' noti, \\\n",
+				RGB_COLOUR_PATTERN_1);
+		fprintf(file, "'eventStreamPatternStartColoured' using 1:2 with points pt 7 ps %g lc rgb '%s' noti, \\\n",
+				pointSizes[i][1], RGB_COLOUR_PATTERN_1);
+		fprintf(file, "'eventStreamPatternColoured' using 1:2 with points pt 7 ps %g lc rgb '%s' title '%s', \\\n",
+				pointSizes[i][2], RGB_COLOUR_PATTERN_2, title);
+		fprintf(file, "'eventStreamNoiseColoured' using 1:2 with points pt 13 ps %g lc rgb '%s' title 'Noise'\n",
+				pointSizes[i][2], RGB_COLOUR_NOISE);
+	}
+
+	fclose(file);
+}
+
+int main(int argc, char* argv[])
+{
+	double start = 0, end = -1;
+	long numOfThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	const char *patternsFile = "patterns.csv", *streamFile = "eventStream.tsv";
+	int option;
+	mappedFile patterns, stream;
+	timespec startTime, endTime;
+
+	while ((option = getopt(argc, argv, "s:e:P:m:j:")) != -1)
+	{
+		switch (option)
+		{
+		case 's':
+			start = atof(optarg);
+			break;
+		case 'e':
+			end = atof(optarg);
+			break;
+		case 'P':
+			colouredPid = strtoul(optarg, NULL, 10);
+			break;
+		case 'm':
+			maxDuration = atof(optarg);
+			break;
+		case 'j':
+			numOfThreads = atol(optarg);
+			break;
+		default:
+			optind = argc + 1;
+		}
+	}
+
+	if (argc - optind == 2)
+	{
+		patternsFile = argv[optind];
+		streamFile = argv[optind + 1];
+	}
+	else if (optind != argc || numOfThreads < 1 || maxDuration <= 0)
+	{
+		cerr << "Usage: streamAnalyser [-s <SECONDS>] [-e <SECONDS>] [-P <PID>] [-m <SECONDS>] [-j <THREADS>]"
+				<< " [<patterns.csv> <eventStream.tsv>]\n"
+				<< "  -s  Start of the analysed window (default: 0)\n"
+				<< "  -e  End of the analysed window (default: end of the stream)\n"
+				<< "  -P  Only colour the instances of pattern <PID> (default: all patterns)\n"
+				<< "  -m  Maximal duration of a pattern instance (default: 30)\n"
+				<< "  -j  Number of time slices matched in parallel (default: number of CPUs)\n";
+		return 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+	if (!mapFile(patternsFile, &patterns) || !mapFile(streamFile, &stream))
+		return 1;
+
+	readPatterns(patterns);
+
+	const char *windowBegin = seekTime(stream.data, stream.end, start, false);
+	windowEnd = end < 0 ? stream.end : seekTime(windowBegin, stream.end, end, true);
+
+	// Cutting the window into time slices of about the same number of bytes
+	vector<timeSlice> slices;
+	const char *sliceBegin = windowBegin;
+
+	slices.reserve(numOfThreads);
+
+	for (long i = 0; i < numOfThreads; i++)
+	{
+		const char *sliceEnd = i == numOfThreads - 1 ? windowEnd
+				: lineAt(windowBegin + (windowEnd - windowBegin) * (i + 1) / numOfThreads, windowBegin, windowEnd);
+
+		if (sliceEnd <= sliceBegin)
+			continue;
+
+		slices.push_back(timeSlice());
+		slices.back().begin = sliceBegin;
+		slices.back().end = sliceEnd;
+		slices.back().warmUp = sliceBegin == windowBegin ? windowBegin
+				: seekTime(windowBegin, sliceBegin, lineTime(sliceBegin, windowEnd) - maxDuration, false);
+		sliceBegin = sliceEnd;
+	}
+
+	for (size_t i = 0; i < slices.size(); i++)
+	{
+		int rc = pthread_create(&slices[i].thread, NULL, matchTimeSlice, &slices[i]);
+
+		if (rc)
+		{
+			cerr << "Unable to create time slice thread, " << rc << endl;
+			return 1;
+		}
+	}
+
+	for (size_t i = 0; i < slices.size(); i++)
+		pthread_join(slices[i].thread, NULL);
+
+	// Global instance and noise symbol numbering, in the order of the slices
+	uint32_t numOfPatternSymbols = patternSymbols.begin.size(), numOfInstances = 0;
+	symbolTable noiseSymbols;
+	vector<instanceRecord> instances;
+	vector< pair<const char *, uint32_t> > tail;
+
+	initTable(&noiseSymbols, 0);
+
+	for (size_t i = 0; i < slices.size(); i++)
+	{
+		timeSlice &slice = slices[i];
+
+		slice.instanceBase = numOfInstances;
+		numOfInstances += slice.instances.size();
+		instances.insert(instances.end(), slice.instances.begin(), slice.instances.end());
+
+		for (size_t t = 0; t < slice.tail.size(); t++)
+			tail.push_back(make_pair(slice.tail[t].first, slice.instanceBase + slice.tail[t].second));
+
+		for (size_t s = 0; s < slice.noise.begin.size(); s++)
+			slice.noiseMap.push_back(numOfPatternSymbols + addSymbol(&noiseSymbols, slice.noise.begin[s],
+					slice.noise.length[s], slice.noise.hash[s]));
+	}
+
+	sort(tail.begin(), tail.end());
+
+	// Resolving symbols and instances, numbering the EventIDs in the order of their first appearance
+	vector<uint32_t> eventIdIndex(numOfPatternSymbols + noiseSymbols.begin.size(), 0), eventsPerInstance(numOfInstances + 1, 0);
+	uint32_t numOfIndices = 0;
+	unsigned long numOfIds = 0;
+	FILE *hashed = openOutput("hashedEventIds");
+
+	for (size_t i = 0; i < slices.size(); i++)
+	{
+		timeSlice &slice = slices[i];
+
+		for (size_t e = 0; e < slice.events.size(); e++)
+		{
+			eventRecord &event = slice.events[e];
+
+			if (event.symbol >= numOfPatternSymbols)
+				event.symbol = slice.noiseMap[event.symbol - numOfPatternSymbols];
+
+			if (event.instance == FOREIGN)
+			{
+				vector< pair<const char *, uint32_t> >::iterator it = lower_bound(tail.begin(), tail.end(),
+						make_pair(event.line, (uint32_t)0));
+
+				event.instance = it != tail.end() && it->first == event.line ? it->second : NONE;
+			}
+			else if (event.instance != NONE)
+				event.instance += slice.instanceBase;
+
+			if (event.instance != NONE)
+				eventsPerInstance[event.instance + 1]++;
+
+			if (eventIdIndex[event.symbol] == 0)
+			{
+				const symbolTable &table = event.symbol < numOfPatternSymbols ? patternSymbols : noiseSymbols;
+				uint32_t s = event.symbol < numOfPatternSymbols ? event.symbol : event.symbol - numOfPatternSymbols;
+
+				eventIdIndex[event.symbol] = ++numOfIndices;
+				fwrite(table.begin[s], 1, table.length[s], hashed);
+				fprintf(hashed, "\t%u\n", numOfIndices);
+			}
+
+			numOfIds++;
+		}
+	}
+
+	fclose(hashed);
+
+	// Writing the series
+	vector<const eventRecord *> instanceEvents(numOfIds);
+	unsigned long numOfPatternIds = 0, numOfIncompleteIds = 0, numOfUnmatchedIds = 0, numOfNoiseIds = 0;
+	FILE *ordinary = openOutput("eventStreamOrdinary"), *noise = openOutput("eventStreamNoiseColoured");
+
+	for (uint32_t i = 0; i < numOfInstances; i++)
+		eventsPerInstance[i + 1] += eventsPerInstance[i];
+
+	vector<uint32_t> fill(eventsPerInstance.begin(), eventsPerInstance.end() - 1);
+
+	for (size_t i = 0; i < slices.size(); i++)
+	{
+		for (size_t e = 0; e < slices[i].events.size(); e++)
+		{
+			const eventRecord &event = slices[i].events[e];
+
+			if (event.symbol >= numOfPatternSymbols)
+			{
+				writeEvent(noise, event, eventIdIndex[event.symbol]);
+				fputc('\n', noise);
+				numOfNoiseIds++;
+				continue;
+			}
+
+			if (event.instance == NONE)
+				numOfUnmatchedIds++;
+			else if (instances[event.instance].complete)
+				numOfPatternIds++;
+			else
+				numOfIncompleteIds++;
+
+			if (event.instance != NONE)
+				instanceEvents[fill[event.instance]++] = &event;
+
+			if (event.instance == NONE || !instances[event.instance].complete
+					|| (colouredPid != 0 && instances[event.instance].pid != colouredPid))
+			{
+				writeEvent(ordinary, event, eventIdIndex[event.symbol]);
+				fputc('\n', ordinary);
+			}
+		}
+	}
+
+	fclose(ordinary);
+	fclose(noise);
+
+	FILE *coloured = openOutput("eventStreamPatternColoured"), *colouredStart = openOutput("eventStreamPatternStartColoured");
+	vector<unsigned long> complete(patternLength.size(), 0), incomplete(patternLength.size(), 0);
+	vector<double> sumDuration(patternLength.size(), 0), maxDuration(patternLength.size(), 0);
+	unsigned long numOfComplete = 0;
+
+	for (uint32_t i = 0; i < numOfInstances; i++)
+	{
+		const instanceRecord &instance = instances[i];
+		double duration = instance.end - instance.start;
+
+		if (!instance.complete)
+		{
+			incomplete[instance.pid]++;
+			continue;
+		}
+
+		numOfComplete++;
+		complete[instance.pid]++;
+		sumDuration[instance.pid] += duration;
+		maxDuration[instance.pid] = max(maxDuration[instance.pid], duration);
+
+		if ((colouredPid != 0 && instance.pid != colouredPid) || eventsPerInstance[i] == eventsPerInstance[i + 1])
+			continue;
+
+		// One block per instance, so gnuplot connects its EventIDs only
+		for (uint32_t e = eventsPerInstance[i]; e < eventsPerInstance[i + 1]; e++)
+		{
+			writeEvent(coloured, *instanceEvents[e], eventIdIndex[instanceEvents[e]->symbol]);
+			fprintf(coloured, "\t%u\n", instance.pid);
+		}
+
+		fputc('\n', coloured);
+		writeEvent(colouredStart, *instanceEvents[eventsPerInstance[i]],
+				eventIdIndex[instanceEvents[eventsPerInstance[i]]->symbol]);
+		fprintf(colouredStart, "\t%u\n", instance.pid);
+	}
+
+	fclose(coloured);
+	fclose(colouredStart);
+
+	FILE *statistics = openOutput("patternStatistics.tsv");
+
+	fprintf(statistics, "# PID\tLength\tComplete\tIncomplete\tMean duration [s]\tMax duration [s]\n");
+
+	for (uint32_t pid = 1; pid < patternLength.size(); pid++)
+		if (complete[pid] + incomplete[pid] > 0)
+			fprintf(statistics, "%u\t%u\t%lu\t%lu\t%.9g\t%.9g\n", pid, patternLength[pid], complete[pid],
+					incomplete[pid], complete[pid] > 0 ? sumDuration[pid] / complete[pid] : 0, maxDuration[pid]);
+
+	fclose(statistics);
+	writeGnuplot(numOfIds);
+	clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+	double elapsed = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+
+	const char *firstLine = NULL, *lastLine = NULL;
+
+	for (size_t i = 0; i < slices.size(); i++)
+	{
+		if (slices[i].events.empty())
+			continue;
+
+		if (firstLine == NULL)
+			firstLine = slices[i].events.front().line;
+
+		lastLine = slices[i].events.back().line;
+	}
+
+	cout << "Analysed " << numOfIds << " EventIDs";
+
+	if (numOfIds > 0)
+		cout << " between " << lineTime(firstLine, windowEnd) << "s and " << lineTime(lastLine, windowEnd) << "s";
+
+	cout << " in " << fixed << setprecision(3) << elapsed << "s (" << setprecision(0) << numOfIds / elapsed
+			<< " EventIDs/s, " << slices.size() << " time slices)\n"
+			<< "Complete pattern instances:   " << numOfComplete << " (" << numOfPatternIds << " EventIDs, "
+			<< setprecision(2) << (numOfIds > 0 ? 100.0 * numOfPatternIds / numOfIds : 0) << "%)\n"
+			<< "Incomplete pattern instances: " << numOfInstances - numOfComplete << " (" << numOfIncompleteIds
+			<< " EventIDs)\n"
+			<< "Unmatched pattern EventIDs:   " << numOfUnmatchedIds << "\n"
+			<< "Noise EventIDs:               " << numOfNoiseIds << " (" << noiseSymbols.begin.size() << " distinct)\n"
+			<< "Distinct EventIDs:            " << numOfIndices << "\n"
+			<< "Per pattern statistics written to patternStatistics.tsv, plot with 'gnuplot gnuplot.plt'\n";
+
+	return 0;
+}
@@ -23,6 +23,7 @@
  */
 
 #include <map>
+#include <deque>
 #include <string>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/asio.hpp>
@@ -223,6 +224,35 @@ typedef struct noiseDescription {
 				eventIdRangeMax;
 	DISTRIBUTION_DEFINITION_STRUCT distribution;
 } NOISE_DESCRIPTION_STRUCT;
+/**
+ * \typedef NOISE_PROCESS
+ * \brief integer representation of a correlated noise process using the noiseProcessEnum enumeration declaration in enum.hh
+ */
+typedef int NOISE_PROCESS;
+/**
+ * \typedef CORRELATED_NOISE_DESCRIPTION_STRUCT
+ * \brief struct to hold a single correlated noise source from openmsc.cfg 'noise = {correlated()}'
+ *
+ * Note, only the fields of the chosen process are used. Without mmppTransitions the MMPP states are left cyclically, i.e.
+ * state i is followed by state i+1.
+ */
+typedef struct correlatedNoiseDescription {
+	NOISE_PROCESS process;
+	int eventIdRangeMin,							/** Noise EventID range start */
+		eventIdRangeMax;							/** Noise EventID range stop (inclusive) */
+	vector <double> mmppRates;						/** Poisson rate [1/s] of each MMPP state */
+	vector <double> mmppSojournTimes;				/** Mean time [s] spent in each MMPP state */
+	vector <vector <double> > mmppTransitions;		/** Probability of going from MMPP state i to state j (optional) */
+	double hawkesBaseRate;							/** Background rate mu [1/s] of the Hawkes process */
+	double hawkesExcitation;						/** Branching ratio alpha (expected offspring per event), must be < 1 */
+	double hawkesDecay;								/** Decay rate beta [1/s] of the excitation kernel */
+	TIME batchInterval;								/** Length of the window generated in one go */
+} CORRELATED_NOISE_DESCRIPTION_STRUCT;
+/**
+ * \typedef CORRELATED_NOISE_DESCRIPTION_VECTOR
+ * \brief vector of CORRELATED_NOISE_DESCRIPTION_STRUCTs
+ */
+typedef vector <CORRELATED_NOISE_DESCRIPTION_STRUCT> CORRELATED_NOISE_DESCRIPTION_VECTOR;
 /**
  * \typedef INFORMATION_ELEMENT_DESCRIPTION_STRUCT
  * \brief struct to hold occurrence and value information about information elements defined in openmsc.cfg
@@ -252,6 +282,11 @@ typedef pair <BS_ID,UE_ID> BS_UE_PAIR;
  * \brief TIME <> EVENT_ID pair
  */
 typedef pair <TIME,EVENT_ID> TIME_EVENT_ID_PAIR;
+/**
+ * \typedef TIME_EVENT_ID_PAIR_VECTOR
+ * \brief vector of TIME <> EVENT_ID pairs, e.g. a batch of generated noise EventIDs
+ */
+typedef vector <TIME_EVENT_ID_PAIR> TIME_EVENT_ID_PAIR_VECTOR;
 /**
  * \typedef INFORMATION_ELEMENTS_PAIR
  * \brief pair to hold a single IE information specified in openmsc.cfg
@@ -267,16 +302,39 @@ typedef map <INFORMATION_ELEMENT, INFORMATION_ELEMENT_DESCRIPTION_STRUCT> INFORM
  * \brief Iterator for INFORMATION_ELEMENT_DESCRIPTION_MAP
  */
 typedef map <INFORMATION_ELEMENT, INFORMATION_ELEMENT_DESCRIPTION_STRUCT>::iterator INFORMATION_ELEMENT_DESCRIPTION_MAP_IT;
+/**
+ * \typedef EVENT_STRUCT
+ * \brief An EventID together with its origin, so the consumers do not need to parse the EventID again
+ */
+typedef struct event {
+	EVENT_ID eventId;			/** The EventID */
+	unsigned short useCaseId;	/** Use-case the EventID belongs to (pattern EventIDs only) */
+	unsigned short step;		/** Communication descriptor of the use-case (pattern EventIDs only) */
+	short noiseSource;			/** Noise source which generated the EventID (0 = uncorrelated, i + 1 = correlated source i), -1 for pattern EventIDs */
+	BS_ID bsId;					/** Base-station of the UE which triggered the EventID (pattern EventIDs only) */
+	UE_ID ueId;					/** UE which triggered the EventID (pattern EventIDs only) */
+	unsigned int procedure;		/** Use-case instance of the UE, counted from 1 per UE (pattern EventIDs only) */
+} EVENT_STRUCT;
+/**
+ * \typedef TIME_EVENT_PAIR
+ * \brief TIME <> EVENT_STRUCT pair
+ */
+typedef pair <TIME,EVENT_STRUCT> TIME_EVENT_PAIR;
+/**
+ * \typedef TIME_EVENT_VECTOR
+ * \brief vector of TIME <> EVENT_STRUCT pairs, e.g. the slots of the visualiser ring buffer
+ */
+typedef vector <TIME_EVENT_PAIR> TIME_EVENT_VECTOR;
 /**
  * \typedef EVENT_MAP
- * \brief TIME <> EVENT_ID map
+ * \brief TIME <> EVENT_STRUCT map
  */
-typedef map <TIME,EVENT_ID> EVENT_MAP;
+typedef map <TIME,EVENT_STRUCT> EVENT_MAP;
 /**
- * \typedef EVENT_TIMER_MAP
- * \brief TIME <> BS_UE_PAIR map
+ * \typedef EVENT_MULTIMAP
+ * \brief TIME <> EVENT_STRUCT multimap, keeping EventIDs generated for the same time in the order they were generated
  */
-typedef map <TIME,BS_UE_PAIR> EVENT_TIMER_MAP;
+typedef multimap <TIME,EVENT_STRUCT> EVENT_MULTIMAP;
 /**
  * \typedef HASHED_NOISE_EVENT_ID_MAP
  * \brief Hashed integer number for string Noise EventID representation
@@ -289,14 +347,24 @@ typedef map <int, EVENT_ID> HASHED_NOISE_EVENT_ID_MAP;
 typedef map <int, EVENT_ID>::iterator HASHED_NOISE_EVENT_ID_MAP_IT;
 /**
  * \typedef EVENT_MAP_IT
- * \brief Iterator for TIME <> EVENT_ID map
+ * \brief Iterator for TIME <> EVENT_STRUCT map
+ */
+typedef map <TIME,EVENT_STRUCT>::iterator EVENT_MAP_IT;
+/**
+ * \typedef VISUALISER_EVENT_STRUCT
+ * \brief An EventID inside the sliding window of the visualiser
  */
-typedef map <TIME,EVENT_ID>::iterator EVENT_MAP_IT;
+typedef struct visualiserEvent {
+	double time;	/** Time [s] at which the EventID was scheduled */
+	int hashedId;	/** Integer representation of the EventID used as y coordinate */
+	bool noise;		/** true if the EventID is noise */
+} VISUALISER_EVENT_STRUCT;
 /**
- * \typedef EVENT_TIMER_MAP_IT
- * \brief iterator for TIME <> BS_UE_PAIR map
+ * \typedef VISUALISER_EVENT_DEQUE
+ * \brief Sliding window of the visualiser sorted by time. New EventIDs are appended at the back, expired ones are
+ * removed from the front.
  */
-typedef map <TIME,BS_UE_PAIR>::iterator EVENT_TIMER_MAP_IT;
+typedef deque <VISUALISER_EVENT_STRUCT> VISUALISER_EVENT_DEQUE;
 /**
  * \typedef NETWORK_ELEMENTS_MAP
  * std::map of network elements as keys and their corresponding unique identifiers
@@ -361,6 +429,245 @@ typedef map <USE_CASE_ID, PROBABILITY> USE_CASE_PROBABILITY_MAP;
  * The probability is read from the openmsc.msc file
  */
 typedef map <USE_CASE_ID, PROBABILITY>::iterator USE_CASE_PROBABILITY_MAP_IT;
+/**
+ * \typedef UE_INDEX
+ * \brief Position of a UE in the population state array, i.e. (BS_ID - 1) * numOfUesPerBs + (UE_ID - 1)
+ */
+typedef unsigned int UE_INDEX;
+/**
+ * \typedef UE_STATE_STRUCT
+ * \brief Compact per-UE state of the population model (24 bytes per UE)
+ *
+ * The use-cases a UE carries out are held in its procedure slots (PROCEDURE_SLOT_STRUCT). A UE is queued at most once
+ * for its next activation (in activity time) and once for the earliest next step of its active procedures.
+ */
+typedef struct ueState {
+	unsigned long long nextActivation;	/** Time [ns] at which the next step of this UE is due (~0 = not queued) */
+	unsigned long long nextArrival;		/** Activity time [ns] at which the UE starts its next use-case (~0 = not drawn yet) */
+	unsigned short activeProcedures;	/** Number of procedure slots in use */
+	unsigned short pendingArrivals;		/** Use-cases waiting for a free procedure slot */
+	unsigned int procedures;			/** Use-cases started so far, numbering the use-case instances of the UE */
+} UE_STATE_STRUCT;
+/**
+ * \typedef PROCEDURE_SLOT_STRUCT
+ * \brief A use-case carried out by a UE (32 bytes per slot)
+ *
+ * A free slot has useCaseId = 0. An active slot is due when the EventIDs of communication descriptor 'step' have to be
+ * sent, i.e. only the next step of a use-case is ever scheduled. A periodic communication descriptor ('->') re-arms the
+ * slot each time it has been sent until periodicEnd, at which the next '=>' communication descriptor is due.
+ */
+typedef struct procedureSlot {
+	unsigned long long due;				/** Time [ns] at which the next step of this use-case is due */
+	unsigned long long procedureStart;	/** Time [ns] at which the use-case was started */
+	unsigned long long periodicEnd;		/** Time [ns] at which the periodic step ends (0 = step is not periodic) */
+	unsigned short useCaseId;			/** Use-case carried out in this slot (0 = free) */
+	unsigned short step;				/** Step within the use-case which is due next */
+	unsigned int procedure;				/** Instance of the use-case, see UE_STATE_STRUCT::procedures */
+} PROCEDURE_SLOT_STRUCT;
+/**
+ * \typedef PROCEDURE_SLOT_VECTOR
+ * \brief vector holding the procedure slots of all UEs, maxConcurrentProcedures consecutive slots per UE
+ */
+typedef vector <PROCEDURE_SLOT_STRUCT> PROCEDURE_SLOT_VECTOR;
+/**
+ * \typedef PROCEDURE_OVERFLOW
+ * \brief What a UE does with a use-case which starts while all of its procedure slots are in use
+ */
+typedef procedureOverflowEnum PROCEDURE_OVERFLOW;
+/**
+ * \typedef UE_STATE_VECTOR
+ * \brief vector holding the UE_STATE_STRUCT of every UE in the network
+ */
+typedef vector <UE_STATE_STRUCT> UE_STATE_VECTOR;
+/**
+ * \typedef CALENDAR_ENTRY_STRUCT
+ * \brief A UE queued in a calendar queue together with the time it is due at
+ *
+ * The time is kept in the entry, so scanning a bucket does not touch the UE state array. An entry whose time no longer
+ * matches the UE state is outdated and skipped when it is popped.
+ */
+typedef struct calendarEntry {
+	unsigned long long time;			/** Time [ns] at which the UE is due */
+	UE_INDEX ueIndex;					/** The UE */
+} CALENDAR_ENTRY_STRUCT;
+/**
+ * \typedef CALENDAR_BUCKET
+ * \brief vector of CALENDAR_ENTRY_STRUCTs, a single bucket of a calendar queue
+ */
+typedef vector <CALENDAR_ENTRY_STRUCT> CALENDAR_BUCKET;
+/**
+ * \typedef RATE_MULTIPLIER
+ * \brief Factor by which the UE activity rate is scaled at a particular point in time
+ */
+typedef double RATE_MULTIPLIER;
+/**
+ * \typedef RATE_PROFILE_MAP
+ * \brief std::map holding the rate multiplier for each point in time of a rate profile (time in seconds relative to the start of the profile)
+ */
+typedef map <double, RATE_MULTIPLIER> RATE_PROFILE_MAP;
+/**
+ * \typedef RATE_PROFILE_MAP_IT
+ * \brief std::map iterator for RATE_PROFILE_MAP
+ */
+typedef map <double, RATE_MULTIPLIER>::iterator RATE_PROFILE_MAP_IT;
+/**
+ * \typedef LATE_EVENT_POLICY
+ * \brief What the sender does with an EventID which is due longer than the late tolerance ago (see lateEventPolicyEnum)
+ */
+typedef lateEventPolicyEnum LATE_EVENT_POLICY;
+/**
+ * \typedef STATISTICS_READER
+ * \brief Reader of the lateness statistics of the eventQueue, each restarting them on its own (see statisticsReaderEnum)
+ */
+typedef statisticsReaderEnum STATISTICS_READER;
+/**
+ * \typedef EVENT_QUEUE_STATISTICS_STRUCT
+ * \brief Fill level and lateness of the event queue between generators and sender
+ *
+ * Lateness is the time between the scheduled and the actual sending time of an EventID. The lateness values cover the
+ * EventIDs sent since the statistics were reset last.
+ */
+typedef struct eventQueueStatistics {
+	size_t entries;						/** Number of EventIDs currently queued */
+	unsigned long long sentEvents;		/** EventIDs handed to the sender */
+	unsigned long long lateEvents;		/** EventIDs sent later than the late tolerance */
+	unsigned long long droppedEvents;	/** Late EventIDs dropped (policy LATE_DROP_COUNT only) */
+	unsigned long long blockedAdds;		/** Number of times a generator had to wait for the queue */
+	TIME currentLateness;				/** Lateness of the EventID sent last */
+	TIME maxLateness;					/** Maximal lateness since the reader restarted the statistics */
+	TIME meanLateness;					/** Mean lateness since the reader restarted the statistics */
+	unsigned long long latenessSamples;	/** Number of EventIDs the mean lateness is based on */
+} EVENT_QUEUE_STATISTICS_STRUCT;
+/**
+ * \typedef COUNTER_VECTOR
+ * \brief Snapshot of the EventID counters (see EventCounters for the layout)
+ */
+typedef vector <unsigned long long> COUNTER_VECTOR;
+/**
+ * \typedef METRIC_PAIR
+ * \brief Label value <> value of a single metric in a snapshot of the MetricsPublisher
+ */
+typedef pair <string,double> METRIC_PAIR;
+/**
+ * \typedef METRIC_VECTOR
+ * \brief vector of METRIC_PAIR, i.e. all values of a metric family
+ */
+typedef vector <METRIC_PAIR> METRIC_VECTOR;
+/**
+ * \typedef METRICS_FORMAT
+ * \brief Format of the snapshots written by the MetricsPublisher (see metricsFormatEnum)
+ */
+typedef metricsFormatEnum METRICS_FORMAT;
+/**
+ * \typedef CONTROL_STATE_STRUCT
+ * \brief Population and UE activity requested through the control socket, applied by the EventID generator as a whole
+ */
+typedef struct controlState {
+	double activityScale;	/** UE activity relative to openmsc.cfg (1 = as configured) */
+	int numOfBss;			/** Number of BSs whose UEs start use-cases */
+	int numOfUesPerBs;		/** Number of UEs per BS which start use-cases (at most numOfUesPerBs of openmsc.cfg) */
+} CONTROL_STATE_STRUCT;
+/**
+ * \typedef RAMP_MODE
+ * \brief How the target EventID rate of a load ramp increases (see rampModeEnum)
+ */
+typedef rampModeEnum RAMP_MODE;
+/**
+ * \typedef RAMP_DEFINITION_STRUCT
+ * \brief Schedule of a load ramp and the limits at which the receiver counts as saturated
+ */
+typedef struct rampDefinition {
+	RAMP_MODE mode;				/** Step or linear increase of the target rate */
+	double startRate;			/** Target EventID rate [1/s] of the first window */
+	double rateIncrease;		/** Increase [1/s] per step, or per second for a linear ramp */
+	double maxRate;				/** Target rate at which the ramp ends without a knee */
+	TIME settleTime;			/** Time after a step before its window is measured (step mode only) */
+	TIME window;				/** Length of a measurement window */
+	double maxDeviation;		/** Relative shortfall of the sent rate against the target */
+	double maxLate;				/** Fraction of EventIDs sent later than the late tolerance */
+	double maxLoss;				/** Fraction of EventIDs lost at the receiver (receiver statistics only) */
+	string outputFile;			/** File the rate/latency curve is written to */
+	string receiverStatistics;	/** File with the statistics of a cooperating receiver (receiverBenchmark -o), may be empty */
+} RAMP_DEFINITION_STRUCT;
+/**
+ * \typedef RECEIVER_STATISTICS_STRUCT
+ * \brief Counters of a cooperating receiver, read from the file written by receiverBenchmark -o
+ */
+typedef struct receiverStatistics {
+	unsigned long long messages;		/** EventIDs received */
+	unsigned long long lost;			/** EventIDs missing in the sequence numbers */
+	unsigned long long latencyP99;		/** 99th percentile of the one-way latency [ns] */
+} RECEIVER_STATISTICS_STRUCT;
+/**
+ * \typedef RAMP_WINDOW_STRUCT
+ * \brief Measurements of a single window of a load ramp, i.e. one point of the rate/latency curve
+ */
+typedef struct rampWindow {
+	double targetRate;					/** Target EventID rate [1/s] at the end of the window */
+	double sentRate;					/** EventIDs sent per second */
+	double lateFraction;				/** Fraction of EventIDs sent later than the late tolerance */
+	TIME meanLateness;					/** Mean lateness of the sender */
+	TIME maxLateness;					/** Maximal lateness of the sender */
+	unsigned long long droppedEvents;	/** Late EventIDs dropped by the sender */
+	unsigned long long blockedAdds;		/** Times a generator had to wait for a full queue, e.g. on TCP backpressure */
+	bool receiverValid;					/** The receiver statistics below could be read */
+	double lossFraction;				/** Fraction of EventIDs lost at the receiver */
+	TIME latencyP99;					/** 99th percentile of the one-way latency at the receiver */
+} RAMP_WINDOW_STRUCT;
+/**
+ * \typedef GENERATOR_DEFINITION_STRUCT
+ * \brief The UE population and its activity as declared in openmsc.cfg, i.e. everything the pattern generator needs
+ * besides the MSC
+ */
+typedef struct generatorDefinition {
+	int numOfBss;								/** Number of BSs */
+	int numOfUesPerBs;							/** Number of UEs attached to each BS */
+	DISTRIBUTION_DEFINITION_STRUCT ueActivity;	/** Distribution of the time between two activations of a UE */
+	bool cdOverlap;								/** The next activation counts from the start of the previous use-case */
+	unsigned int maxConcurrentProcedures;		/** Number of use-cases a single UE can carry out at the same time */
+	PROCEDURE_OVERFLOW procedureOverflow;		/** What a UE does with a use-case while all its slots are in use */
+	TIME populationBucketWidth;					/** Time covered by a single bucket of the UE activation calendar queue */
+	unsigned int populationBuckets;				/** Number of buckets of the UE activation calendar queue */
+	int seed;									/** Seed of the random number generators */
+} GENERATOR_DEFINITION_STRUCT;
+/**
+ * \typedef EVENT_CALLBACK
+ * \brief Function the pattern generator hands every generated EventID to, together with an opaque context pointer
+ */
+typedef void (*EVENT_CALLBACK)(const TIME_EVENT_PAIR &event, void *context);
+/**
+ * \typedef GENERATION_TIME
+ * \brief Whether an embedded generator runs in virtual or in real time (see generationTimeEnum)
+ */
+typedef generationTimeEnum GENERATION_TIME;
+/**
+ * \typedef HOT_LOG_LEVEL
+ * \brief Level of a hot-path log message (see hotLog.hh)
+ */
+typedef hotLogLevelEnum HOT_LOG_LEVEL;
+/**
+ * \typedef HOT_LOG_ARG
+ * \brief Type of an argument of a hot-path log message
+ */
+typedef hotLogArgEnum HOT_LOG_ARG;
+/**
+ * \typedef PARTITION
+ * \brief Function distributing the EventIDs over the destinations (see partitionEnum)
+ */
+typedef partitionEnum PARTITION;
+/**
+ * \typedef DESTINATION_STRUCT
+ * \brief A receiving module the EventIDs are sent to
+ */
+typedef struct destination {
+	IP_ADDRESS ipAddress;	/** IP address of the receiving module */
+	PORT port;				/** Port number of the receiving module */
+} DESTINATION_STRUCT;
+/**
+ * \typedef DESTINATION_VECTOR
+ * \brief vector of DESTINATION_STRUCT
+ */
+typedef vector <DESTINATION_STRUCT> DESTINATION_VECTOR;
 /**
  * \typedef Time
  * \brief boost::posix_time definition
@@ -378,3 +685,13 @@ typedef boost::minstd_rand base_generator_type;
 typedef boost::asio::time_traits<boost::posix_time::ptime> time_traits_t;
 
 #define PRECISION 10
+#define CACHE_LINE_SIZE 64	/** Size of a CPU cache line in bytes, used to keep per-thread data apart */
+#define MAX_COUNTING_THREADS 64	/** Maximal number of threads counting sent EventIDs */
+#define MAX_DESTINATIONS 32	/** Maximal number of destinations, each with its own sender thread */
+#define HOT_LOG_RING_SIZE 65536	/** Number of hot-path log messages buffered for the formatting thread */
+#define HOT_LOG_MAX_ARGS 6	/** Maximal number of arguments of a hot-path log message */
+#define HOT_LOG_PAYLOAD_SIZE 96	/** Bytes of arguments of a hot-path log message */
+#define MAX_CONCURRENT_PROCEDURES 64	/** Maximal number of use-cases a single UE can carry out at the same time */
+#define VISUALISER_RING_SIZE 262144	/** Number of sent EventIDs buffered for the visualiser */
+#define CONTROL_POLL_INTERVAL 100	/** Milliseconds after which a change through the control socket is applied at the latest */
+#define LIBOPENMSC_RING_WAIT 50	/** Microseconds the libopenmsc producer waits for the consumer of a full ring */
@@ -0,0 +1,371 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uePopulation.hh"
+
+void CalendarQueue::Init(unsigned long long bucketWidth, unsigned int numOfBuckets, unsigned long long startTime)
+{
+	unsigned long long n = 1;
+
+	while (n < numOfBuckets)
+		n <<= 1;
+
+	buckets.assign(n, CALENDAR_BUCKET());
+	bucketMask = n - 1;
+	bucketWidth_ = bucketWidth > 0 ? bucketWidth : 1;
+	currentSlot = startTime / bucketWidth_;
+	size = 0;
+}
+
+void CalendarQueue::Push(UE_INDEX ueIndex, unsigned long long t)
+{
+	unsigned long long slot = t / bucketWidth_;
+	CALENDAR_ENTRY_STRUCT entry;
+
+	// UEs due in the past are handled with the slot which is currently drained
+	if (slot < currentSlot)
+		slot = currentSlot;
+
+	entry.time = t;
+	entry.ueIndex = ueIndex;
+	buckets[slot & bucketMask].push_back(entry);
+	size++;
+}
+
+bool CalendarQueue::PopDue(unsigned long long horizon, CALENDAR_ENTRY_STRUCT *entry)
+{
+	if (size == 0)
+	{
+		// Nothing to drain - simply move on with the time
+		AdvanceTo(horizon);
+		return false;
+	}
+
+	while (currentSlot * bucketWidth_ <= horizon)
+	{
+		CALENDAR_BUCKET &bucket = buckets[currentSlot & bucketMask];
+
+		for (size_t i = 0; i < bucket.size(); i++)
+		{
+			// Entries of a later year stay in this bucket
+			if (bucket[i].time / bucketWidth_ <= currentSlot && bucket[i].time <= horizon)
+			{
+				*entry = bucket[i];
+				bucket[i] = bucket.back();
+				bucket.pop_back();
+				size--;
+				return true;
+			}
+		}
+
+		// Only move to the next slot once this slot is entirely in the past
+		if ((currentSlot + 1) * bucketWidth_ > horizon)
+			break;
+
+		currentSlot++;
+	}
+
+	return false;
+}
+
+void CalendarQueue::AdvanceTo(unsigned long long t)
+{
+	if (t / bucketWidth_ > currentSlot)
+		currentSlot = t / bucketWidth_;
+}
+
+unsigned long long CalendarQueue::GetNextTime()
+{
+	unsigned long long next = ~0ULL;
+
+	if (size == 0)
+		return next;
+
+	// Scan one year of buckets for the first slot holding a UE
+	for (unsigned long long slot = currentSlot; slot <= currentSlot + bucketMask; slot++)
+	{
+		CALENDAR_BUCKET &bucket = buckets[slot & bucketMask];
+
+		for (size_t i = 0; i < bucket.size(); i++)
+		{
+			if (bucket[i].time / bucketWidth_ <= slot && bucket[i].time < next)
+				next = bucket[i].time;
+		}
+
+		if (next != ~0ULL)
+			return next;
+	}
+
+	// All queued UEs are due in a later year
+	for (size_t b = 0; b < buckets.size(); b++)
+	{
+		for (size_t i = 0; i < buckets[b].size(); i++)
+		{
+			if (buckets[b][i].time < next)
+				next = buckets[b][i].time;
+		}
+	}
+
+	return next;
+}
+
+unsigned long long CalendarQueue::GetCurrentBucketEnd()
+{
+	return (currentSlot + 1) * bucketWidth_ - 1;
+}
+
+UE_INDEX CalendarQueue::GetSize()
+{
+	return size;
+}
+
+size_t CalendarQueue::GetMemoryUsage()
+{
+	size_t bytes = buckets.capacity() * sizeof(CALENDAR_BUCKET);
+
+	for (size_t b = 0; b < buckets.size(); b++)
+		bytes += buckets[b].capacity() * sizeof(CALENDAR_ENTRY_STRUCT);
+
+	return bytes;
+}
+
+void UePopulation::Init(int numOfBss, int numOfUesPerBs, unsigned int maxConcurrentProcedures, TIME bucketWidth,
+		unsigned int numOfBuckets, TIME startTime)
+{
+	UE_STATE_STRUCT idle;
+	PROCEDURE_SLOT_STRUCT freeSlot;
+
+	idle.nextActivation = ~0ULL;
+	idle.nextArrival = ~0ULL;
+	idle.activeProcedures = 0;
+	idle.pendingArrivals = 0;
+	idle.procedures = 0;
+	freeSlot.due = 0;
+	freeSlot.procedureStart = 0;
+	freeSlot.periodicEnd = 0;
+	freeSlot.useCaseId = 0;
+	freeSlot.step = 0;
+	freeSlot.procedure = 0;
+	numOfUesPerBs_ = numOfUesPerBs;
+	maxConcurrentProcedures_ = maxConcurrentProcedures > 0 ? maxConcurrentProcedures : 1;
+	ueStates.assign((size_t)numOfBss * numOfUesPerBs, idle);
+	slots.assign(ueStates.size() * maxConcurrentProcedures_, freeSlot);
+	stepQueue.Init(bucketWidth.nanosec(), numOfBuckets, startTime.nanosec());
+	arrivalQueue.Init(bucketWidth.nanosec(), numOfBuckets, startTime.nanosec());
+	scaleOrigin = startTime.nanosec();
+	activityOrigin = startTime.nanosec();
+	activityScale_ = 1;
+	horizon_ = startTime.nanosec();
+	LOG4CXX_DEBUG(logger, "UE population initialised with " << ueStates.size() << " UEs, " << maxConcurrentProcedures_
+			<< " procedure slots per UE and two calendar queues of " << numOfBuckets << " buckets x " << bucketWidth.nanosec() << "ns");
+}
+
+void UePopulation::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+void UePopulation::SetActivityScale(TIME t, double activityScale)
+{
+	// Activations up to the last horizon have been handed out at the previous speed already
+	TIME origin = (t.nanosec() > horizon_) ? t : TIME(horizon_, "nanosec");
+
+	activityOrigin = ToActivityTime(origin);
+	scaleOrigin = origin.nanosec();
+	activityScale_ = activityScale;
+	LOG4CXX_DEBUG(logger, "Activity time runs " << activityScale << " times as fast as the time from " << origin.sec() << "s on");
+}
+
+unsigned long long UePopulation::ToActivityTime(TIME t)
+{
+	// Differences keep the precision of the nanoseconds, the absolute times exceed the mantissa of a double
+	long long elapsed = (long long)(t.nanosec() - scaleOrigin);
+
+	return activityOrigin + (long long)(elapsed * activityScale_);
+}
+
+TIME UePopulation::ToTime(unsigned long long activityTime)
+{
+	long long elapsed = (long long)(activityTime - activityOrigin);
+
+	return TIME(scaleOrigin + (long long)(elapsed / activityScale_), "nanosec");
+}
+
+void UePopulation::Schedule(UE_INDEX ueIndex, TIME t)
+{
+	ueStates[ueIndex].nextActivation = t.nanosec();
+	stepQueue.Push(ueIndex, t.nanosec());
+}
+
+void UePopulation::Reschedule(UE_INDEX ueIndex)
+{
+	PROCEDURE_SLOT_STRUCT *slot = GetDueProcedure(ueIndex);
+
+	// Without an active procedure an entry left in the calendar queue is outdated
+	if (slot == NULL)
+		ueStates[ueIndex].nextActivation = ~0ULL;
+	else if (slot->due != ueStates[ueIndex].nextActivation)
+		Schedule(ueIndex, TIME(slot->due, "nanosec"));
+}
+
+void UePopulation::ScheduleArrival(UE_INDEX ueIndex)
+{
+	if (ueStates[ueIndex].nextArrival != ~0ULL)
+		arrivalQueue.Push(ueIndex, ueStates[ueIndex].nextArrival);
+}
+
+PROCEDURE_SLOT_STRUCT * UePopulation::StartProcedure(UE_INDEX ueIndex)
+{
+	PROCEDURE_SLOT_STRUCT *slot = &slots[(size_t)ueIndex * maxConcurrentProcedures_];
+
+	if (ueStates[ueIndex].activeProcedures >= maxConcurrentProcedures_)
+		return NULL;
+
+	for (unsigned int i = 0; i < maxConcurrentProcedures_; i++)
+	{
+		if (slot[i].useCaseId == 0)
+		{
+			ueStates[ueIndex].activeProcedures++;
+			return &slot[i];
+		}
+	}
+
+	return NULL;
+}
+
+void UePopulation::FinishProcedure(UE_INDEX ueIndex, PROCEDURE_SLOT_STRUCT *slot)
+{
+	slot->useCaseId = 0;
+	slot->step = 0;
+	slot->periodicEnd = 0;
+	ueStates[ueIndex].activeProcedures--;
+}
+
+PROCEDURE_SLOT_STRUCT * UePopulation::GetDueProcedure(UE_INDEX ueIndex)
+{
+	PROCEDURE_SLOT_STRUCT *slot = &slots[(size_t)ueIndex * maxConcurrentProcedures_],
+			*due = NULL;
+
+	if (ueStates[ueIndex].activeProcedures == 0)
+		return NULL;
+
+	// Earliest deadline first between the procedures of the UE
+	for (unsigned int i = 0; i < maxConcurrentProcedures_; i++)
+	{
+		if (slot[i].useCaseId != 0 && (due == NULL || slot[i].due < due->due))
+			due = &slot[i];
+	}
+
+	return due;
+}
+
+bool UePopulation::PopDue(TIME horizon, UE_INDEX *ueIndex, bool *arrival)
+{
+	CALENDAR_ENTRY_STRUCT entry;
+	unsigned long long h = horizon.nanosec();
+
+	if (h > horizon_)
+		horizon_ = h;
+
+	for (;;)
+	{
+		// Bucket by bucket of the steps, so the use-cases of a UE are carried out in order
+		unsigned long long end = (stepQueue.GetSize() > 0 && stepQueue.GetCurrentBucketEnd() < h)
+				? stepQueue.GetCurrentBucketEnd() : h;
+
+		while (stepQueue.PopDue(end, &entry))
+		{
+			if (entry.time != ueStates[entry.ueIndex].nextActivation)
+				continue;
+
+			ueStates[entry.ueIndex].nextActivation = ~0ULL;
+			*ueIndex = entry.ueIndex;
+			*arrival = false;
+			return true;
+		}
+		while (arrivalQueue.PopDue(ToActivityTime(TIME(end, "nanosec")), &entry))
+		{
+			if (entry.time != ueStates[entry.ueIndex].nextArrival)
+				continue;
+
+			*ueIndex = entry.ueIndex;
+			*arrival = true;
+			return true;
+		}
+
+		if (end == h)
+			return false;
+
+		stepQueue.AdvanceTo(end + 1);
+	}
+}
+
+TIME UePopulation::GetNextActivationTime()
+{
+	unsigned long long nextStep = stepQueue.GetNextTime(),
+			nextArrival = arrivalQueue.GetNextTime();
+
+	if (nextArrival != ~0ULL && ToTime(nextArrival).nanosec() < nextStep)
+		nextStep = ToTime(nextArrival).nanosec();
+
+	// Nothing queued
+	if (nextStep == ~0ULL)
+		return TIME();
+
+	return TIME(nextStep, "nanosec");
+}
+
+UE_STATE_STRUCT * UePopulation::GetUeState(UE_INDEX ueIndex)
+{
+	return &ueStates[ueIndex];
+}
+
+BS_UE_PAIR UePopulation::GetBsUe(UE_INDEX ueIndex)
+{
+	return BS_UE_PAIR (ueIndex / numOfUesPerBs_ + 1, ueIndex % numOfUesPerBs_ + 1);
+}
+
+UE_INDEX UePopulation::GetNumOfUes()
+{
+	return ueStates.size();
+}
+
+int UePopulation::GetNumOfBss()
+{
+	return ueStates.size() / numOfUesPerBs_;
+}
+
+UE_INDEX UePopulation::GetNumOfQueuedUes()
+{
+	return stepQueue.GetSize() + arrivalQueue.GetSize();
+}
+
+unsigned int UePopulation::GetMaxConcurrentProcedures()
+{
+	return maxConcurrentProcedures_;
+}
+
+size_t UePopulation::GetMemoryUsage()
+{
+	return ueStates.capacity() * sizeof(UE_STATE_STRUCT) + slots.capacity() * sizeof(PROCEDURE_SLOT_STRUCT)
+			+ stepQueue.GetMemoryUsage() + arrivalQueue.GetMemoryUsage();
+}
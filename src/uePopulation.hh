@@ -0,0 +1,233 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rateProfile.hh"
+
+/**
+ * \class CalendarQueue
+ * This class schedules UEs using a calendar queue, a ring of buckets each covering bucketWidth nanoseconds. A UE due at
+ * time t is stored in bucket (t / bucketWidth) % numOfBuckets, so scheduling is O(1) and popping the due UEs only touches
+ * the buckets between the last and the current time. UEs further away than one round of the ring (a 'year') stay in their
+ * bucket and are skipped until their year has come.
+ */
+class CalendarQueue {
+public:
+	/**
+	 * Initialising the calendar queue
+	 * @param bucketWidth The time [ns] covered by a single bucket
+	 * @param numOfBuckets The number of buckets (rounded up to a power of two)
+	 * @param startTime The time [ns] from which on UEs can be scheduled
+	 */
+	void Init(unsigned long long bucketWidth, unsigned int numOfBuckets, unsigned long long startTime);
+	/**
+	 * Queuing a UE. UEs due in the past are handled with the bucket which is currently drained.
+	 * @param ueIndex The index of the UE
+	 * @param t The time [ns] at which the UE is due
+	 */
+	void Push(UE_INDEX ueIndex, unsigned long long t);
+	/**
+	 * Obtain an entry which is due at or before the given time and remove it from the calendar queue
+	 * @param horizon All entries due at or before this time [ns] are returned
+	 * @param entry Pointer into which the entry is written
+	 * @return true if a due entry was found
+	 */
+	bool PopDue(unsigned long long horizon, CALENDAR_ENTRY_STRUCT *entry);
+	/**
+	 * Moving on to the bucket holding the given time once all entries due before it have been popped
+	 * @param t The time [ns]
+	 */
+	void AdvanceTo(unsigned long long t);
+	/**
+	 * Obtain the time at which the next entry is due
+	 * @return The earliest time [ns] of all entries, ~0 if the calendar queue is empty
+	 */
+	unsigned long long GetNextTime();
+	/**
+	 * Obtain the end of the bucket which is drained at the moment
+	 * @return The last time [ns] covered by the current bucket
+	 */
+	unsigned long long GetCurrentBucketEnd();
+	/**
+	 * Obtain the number of entries
+	 * @return The number of entries in the calendar queue
+	 */
+	UE_INDEX GetSize();
+	/**
+	 * Obtain the memory allocated by the calendar queue
+	 * @return Number of bytes allocated for the buckets
+	 */
+	size_t GetMemoryUsage();
+private:
+	vector <CALENDAR_BUCKET> buckets;	/** Buckets holding the queued UEs */
+	unsigned long long bucketWidth_;	/** Time [ns] covered by a single bucket */
+	unsigned long long bucketMask;		/** numOfBuckets - 1 */
+	unsigned long long currentSlot;		/** Slot (time / bucketWidth) which is drained at the moment */
+	UE_INDEX size;						/** Number of entries */
+};
+
+/**
+ * \class UePopulation
+ * This class holds the state of all UEs in a compact array and schedules their activations and use-case steps using two
+ * calendar queues (see CalendarQueue).
+ *
+ * Activations are drawn for the UE activity of openmsc.cfg and queued in activity time, which runs activityScale times as
+ * fast as the time. Changing the UE activity only moves the mapping between both times, so it neither touches the UEs nor
+ * the calendar queue. Steps of use-cases are queued in time. Every UE owns maxConcurrentProcedures procedure slots, each
+ * carrying out one use-case, and is queued only once for all of them, at the earliest next step.
+ *
+ * A UE is requeued by adding a new entry, the outdated entry is skipped when it is popped. PopDue() drains both calendar
+ * queues bucket by bucket, the steps of a bucket going before the activations.
+ */
+class UePopulation {
+public:
+	/**
+	 * Initialising the population and allocating the state array for all UEs. Activity time starts equal to the time.
+	 * @param numOfBss The number of BSs in the network
+	 * @param numOfUesPerBs The number of UEs attached to each BS
+	 * @param maxConcurrentProcedures The number of use-cases a single UE can carry out at the same time
+	 * @param bucketWidth The time covered by a single bucket of the calendar queues
+	 * @param numOfBuckets The number of buckets of the calendar queues (rounded up to a power of two)
+	 * @param startTime The time from which on UEs can be scheduled
+	 */
+	void Init(int numOfBss, int numOfUesPerBs, unsigned int maxConcurrentProcedures, TIME bucketWidth, unsigned int numOfBuckets, TIME startTime);
+	/**
+	 * Changing the speed of the activity time, e.g. when the UE activity has changed. Activations which have not been
+	 * popped yet follow the new speed, which is exact for the exponential distribution since it is memoryless.
+	 * @param t The time from which on the new speed applies (at the earliest the last horizon given to PopDue())
+	 * @param activityScale UE activity relative to openmsc.cfg
+	 */
+	void SetActivityScale(TIME t, double activityScale);
+	/**
+	 * Translate a time into activity time
+	 * @param t The time
+	 * @return The activity time [ns]
+	 */
+	unsigned long long ToActivityTime(TIME t);
+	/**
+	 * Translate an activity time into time
+	 * @param activityTime The activity time [ns]
+	 * @return The time
+	 */
+	TIME ToTime(unsigned long long activityTime);
+	/**
+	 * Initialising logging in UePopulation class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Queuing a UE for a use-case step at the given time
+	 * @param ueIndex The index of the UE
+	 * @param t The time at which the UE is due
+	 */
+	void Schedule(UE_INDEX ueIndex, TIME t);
+	/**
+	 * Queuing a UE at the earliest next step of its active procedures, unless it is queued there already
+	 * @param ueIndex The index of the UE
+	 */
+	void Reschedule(UE_INDEX ueIndex);
+	/**
+	 * Queuing a UE for its next activation (UE_STATE_STRUCT::nextArrival), which must have been popped or replaced
+	 * @param ueIndex The index of the UE
+	 */
+	void ScheduleArrival(UE_INDEX ueIndex);
+	/**
+	 * Occupying a free procedure slot of a UE for a new use-case
+	 * @param ueIndex The index of the UE
+	 * @return Pointer to the slot, NULL if all procedure slots of the UE are in use
+	 */
+	PROCEDURE_SLOT_STRUCT * StartProcedure(UE_INDEX ueIndex);
+	/**
+	 * Releasing the procedure slot of a finished use-case
+	 * @param ueIndex The index of the UE
+	 * @param slot The slot obtained from StartProcedure()
+	 */
+	void FinishProcedure(UE_INDEX ueIndex, PROCEDURE_SLOT_STRUCT *slot);
+	/**
+	 * Obtain the active procedure of a UE whose next step is due first
+	 * @param ueIndex The index of the UE
+	 * @return Pointer to the slot, NULL if the UE has no active procedure
+	 */
+	PROCEDURE_SLOT_STRUCT * GetDueProcedure(UE_INDEX ueIndex);
+	/**
+	 * Obtain a UE which is due at or before the given time and remove it from its calendar queue
+	 * @param horizon All UEs due at or before this time are returned
+	 * @param ueIndex Pointer into which the index of the due UE is written
+	 * @param arrival Pointer into which is written whether the activation (true) or a step (false) of the UE is due
+	 * @return true if a due UE was found, false if no further UE is due before the horizon
+	 */
+	bool PopDue(TIME horizon, UE_INDEX *ueIndex, bool *arrival);
+	/**
+	 * Obtain the time at which the next UE is due
+	 * @return The earliest activation time of all queued UEs. If no UE is queued, TIME() is returned
+	 */
+	TIME GetNextActivationTime();
+	/**
+	 * Access the state of a particular UE
+	 * @param ueIndex The index of the UE
+	 * @return Pointer to the UE_STATE_STRUCT of this UE
+	 */
+	UE_STATE_STRUCT * GetUeState(UE_INDEX ueIndex);
+	/**
+	 * Translate the UE index into the BS and UE identifier used for the EventIDs
+	 * @param ueIndex The index of the UE
+	 * @return The BS and UE identifier
+	 */
+	BS_UE_PAIR GetBsUe(UE_INDEX ueIndex);
+	/**
+	 * Obtain the number of UEs in the population
+	 * @return The total number of UEs
+	 */
+	UE_INDEX GetNumOfUes();
+	/**
+	 * Obtain the number of BSs in the population
+	 * @return The number of BSs
+	 */
+	int GetNumOfBss();
+	/**
+	 * Obtain the number of UEs currently queued
+	 * @return The number of entries in both calendar queues, including outdated ones
+	 */
+	UE_INDEX GetNumOfQueuedUes();
+	/**
+	 * Obtain the number of use-cases a single UE can carry out at the same time
+	 * @return The number of procedure slots per UE
+	 */
+	unsigned int GetMaxConcurrentProcedures();
+	/**
+	 * Obtain the memory allocated by the population model
+	 * @return Number of bytes allocated for the UE state array, the procedure slots and the calendar queues
+	 */
+	size_t GetMemoryUsage();
+private:
+	UE_STATE_VECTOR ueStates;			/** State of every UE */
+	PROCEDURE_SLOT_VECTOR slots;		/** Procedure slots of every UE */
+	unsigned int maxConcurrentProcedures_;	/** Procedure slots per UE */
+	CalendarQueue stepQueue;			/** UEs queued for the next step of their procedures, in time */
+	CalendarQueue arrivalQueue;			/** UEs queued for their next activation, in activity time */
+	unsigned long long scaleOrigin;		/** Time [ns] at which the activity time took its current speed */
+	unsigned long long activityOrigin;	/** Activity time [ns] at scaleOrigin */
+	double activityScale_;				/** Speed of the activity time relative to the time */
+	unsigned long long horizon_;		/** Last horizon [ns] given to PopDue() */
+	int numOfUesPerBs_;					/** Number of UEs attached to each BS */
+	log4cxx::LoggerPtr logger;			/** Pointer to LoggerPtr class */
+};
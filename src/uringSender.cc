@@ -0,0 +1,266 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uringSender.hh"
+#ifdef HAVE_LIBURING
+#include <errno.h>
+#include <sys/socket.h>
+
+bool UringSender::Init(int fd, bool stream)
+{
+	vector <struct iovec> iovecs;
+	size_t bufferSize = stream ? URING_STAGE_SIZE : URING_SLOT_SIZE;
+	unsigned int numOfBuffers = stream ? 2 : URING_QUEUE_DEPTH;
+	void *memory;
+	int rc;
+
+	fd_ = fd;
+	stream_ = stream;
+	zeroCopy = false;
+	prepared = 0;
+	stage = 0;
+	submissions = 0;
+	errors = 0;
+
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		stageLength[i] = 0;
+		stageSent[i] = 0;
+		stagePending[i] = 0;
+	}
+
+	rc = io_uring_queue_init(URING_QUEUE_DEPTH, &ring, 0);
+
+	if (rc < 0)
+	{
+		LOG4CXX_ERROR(logger, "io_uring_queue_init() failed: " << strerror(-rc));
+		return false;
+	}
+
+	if (posix_memalign(&memory, 4096, bufferSize * numOfBuffers) != 0)
+	{
+		io_uring_queue_exit(&ring);
+		return false;
+	}
+
+	buffers = (char *)memory;
+
+	for (unsigned int i = 0; i < numOfBuffers; i++)
+	{
+		struct iovec iov;
+		iov.iov_base = buffers + i * bufferSize;
+		iov.iov_len = bufferSize;
+		iovecs.push_back(iov);
+
+		if (!stream)
+			freeSlots.push_back(i);
+	}
+	// Registered buffers save the kernel pinning the pages on every send. Failing is not fatal (e.g. RLIMIT_MEMLOCK)
+	rc = io_uring_register_buffers(&ring, &iovecs[0], iovecs.size());
+
+	if (rc < 0)
+		LOG4CXX_INFO(logger, "io_uring buffers could not be registered: " << strerror(-rc));
+#ifdef IORING_CQE_F_NOTIF
+	// Zero-copy only pays off for the large coalesced TCP sends, not for single datagrams
+	struct io_uring_probe *probe = io_uring_get_probe_ring(&ring);
+
+	if (stream && rc >= 0 && probe != NULL && io_uring_opcode_supported(probe, IORING_OP_SEND_ZC))
+		zeroCopy = true;
+
+	if (probe != NULL)
+		io_uring_free_probe(probe);
+#endif
+	LOG4CXX_INFO(logger, "io_uring " << (stream ? "TCP" : "UDP") << " sender initialised with " << URING_QUEUE_DEPTH
+			<< " entries" << (zeroCopy ? " and zero-copy send" : ""));
+	return true;
+}
+
+void UringSender::InitLog(log4cxx::LoggerPtr l)
+{
+	logger = l;
+}
+
+void UringSender::Send(const char *data, size_t length)
+{
+	if (stream_)
+	{
+		if (stageLength[stage] + length > URING_STAGE_SIZE)
+			Flush();
+
+		memcpy(buffers + stage * URING_STAGE_SIZE + stageLength[stage], data, length);
+		stageLength[stage] += length;
+		return;
+	}
+	// All slots in flight - hand them over and wait for the first to come back
+	if (freeSlots.empty())
+		Flush();
+
+	while (freeSlots.empty())
+		Reap(true);
+
+	unsigned int slot = freeSlots.back();
+	freeSlots.pop_back();
+
+	if (length > URING_SLOT_SIZE)
+		length = URING_SLOT_SIZE;
+
+	memcpy(buffers + slot * URING_SLOT_SIZE, data, length);
+	struct io_uring_sqe *sqe = GetSqe();
+	io_uring_prep_send(sqe, fd_, buffers + slot * URING_SLOT_SIZE, length, 0);
+	io_uring_sqe_set_data(sqe, (void *)(uintptr_t)slot);
+	prepared++;
+}
+
+void UringSender::Flush()
+{
+	char drain[4096];
+
+	if (stream_)
+	{
+		if (stageLength[stage] > 0)
+		{
+			// Keeping the byte stream in order: the previous buffer must have been handed to the socket completely
+			while (stageSent[stage ^ 1] < stageLength[stage ^ 1])
+				Reap(true);
+
+			PrepareStage(stage);
+			io_uring_submit(&ring);
+			submissions++;
+			// Filling the other buffer, once the kernel has released it (zero-copy notification)
+			stage ^= 1;
+
+			while (stagePending[stage] > 0)
+				Reap(true);
+
+			stageLength[stage] = 0;
+			stageSent[stage] = 0;
+		}
+		// Discarding what an echoing receiver sent back
+		while (recv(fd_, drain, sizeof(drain), MSG_DONTWAIT) > 0)
+			;
+	}
+	else if (prepared > 0)
+	{
+		io_uring_submit(&ring);
+		submissions++;
+		prepared = 0;
+	}
+
+	Reap(false);
+}
+
+unsigned long long UringSender::GetSubmissions()
+{
+	return submissions;
+}
+
+void UringSender::PrepareStage(unsigned int buffer)
+{
+	struct io_uring_sqe *sqe = GetSqe();
+	char *data = buffers + buffer * URING_STAGE_SIZE + stageSent[buffer];
+	size_t length = stageLength[buffer] - stageSent[buffer];
+
+#ifdef IORING_CQE_F_NOTIF
+	if (zeroCopy)
+		io_uring_prep_send_zc_fixed(sqe, fd_, data, length, MSG_NOSIGNAL, 0, buffer);
+	else
+#endif
+		io_uring_prep_send(sqe, fd_, data, length, MSG_NOSIGNAL);
+
+	io_uring_sqe_set_data(sqe, (void *)(uintptr_t)buffer);
+	stagePending[buffer]++;
+}
+
+void UringSender::Reap(bool wait)
+{
+	struct io_uring_cqe *cqe;
+
+	if (wait)
+	{
+		if (io_uring_wait_cqe(&ring, &cqe) < 0)
+			return;
+	}
+	else if (io_uring_peek_cqe(&ring, &cqe) != 0)
+		return;
+
+	do
+	{
+		unsigned int index = (unsigned int)(uintptr_t)io_uring_cqe_get_data(cqe);
+		int res = cqe->res;
+		unsigned int flags = cqe->flags;
+		io_uring_cqe_seen(&ring, cqe);
+
+		if (!stream_)
+		{
+			if (res < 0 && errors++ == 0)
+				LOG4CXX_ERROR(logger, "io_uring UDP send failed: " << strerror(-res));
+			freeSlots.push_back(index);
+			continue;
+		}
+
+		stagePending[index]--;
+#ifdef IORING_CQE_F_NOTIF
+		// The buffer of a zero-copy send is only released with its notification
+		if (flags & IORING_CQE_F_NOTIF)
+			continue;
+
+		if (flags & IORING_CQE_F_MORE)
+			stagePending[index]++;
+#endif
+		if (res == -EAGAIN || res == -EINTR)
+			res = 0;
+		else if (res < 0)
+		{
+			if (errors++ == 0)
+				LOG4CXX_ERROR(logger, "io_uring TCP send failed: " << strerror(-res));
+			// Giving up on this buffer, the connection is broken
+			res = stageLength[index] - stageSent[index];
+		}
+
+		stageSent[index] += res;
+		// Short send - sending the rest before anything of the other buffer
+		if (stageSent[index] < stageLength[index])
+		{
+			PrepareStage(index);
+			io_uring_submit(&ring);
+			submissions++;
+		}
+	}
+	while (io_uring_peek_cqe(&ring, &cqe) == 0);
+}
+
+struct io_uring_sqe * UringSender::GetSqe()
+{
+	struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+
+	while (sqe == NULL)
+	{
+		io_uring_submit(&ring);
+		submissions++;
+		prepared = 0;
+		Reap(false);
+		sqe = io_uring_get_sqe(&ring);
+	}
+
+	return sqe;
+}
+#endif
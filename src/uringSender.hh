@@ -0,0 +1,102 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "loadRamp.hh"
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+
+#define URING_QUEUE_DEPTH 256			/** Submission queue entries, i.e. UDP datagrams in flight */
+#define URING_SLOT_SIZE 1088			/** Buffer per UDP datagram (wire header + maximal EventID, rounded up to cache lines) */
+#define URING_STAGE_SIZE 262144			/** Bytes coalesced into a single TCP send */
+
+/**
+ * \class UringSender
+ * This class sends the EventIDs of a sender thread through io_uring instead of one blocking syscall per EventID.
+ *
+ * UDP: every EventID is copied into a buffer slot and prepared as a send, all sends prepared until Flush() are handed
+ * to the kernel with a single io_uring_enter(). TCP: the EventIDs are coalesced into one of two registered staging
+ * buffers, which is sent as a whole on Flush() - with zero-copy send (IORING_OP_SEND_ZC) if the kernel supports it -
+ * while the other buffer is filled. Completions are reaped without syscall from the completion queue.
+ *
+ * The TCP path does not wait for the echo of the receiver. Echoed data is drained and discarded on Flush().
+ */
+class UringSender {
+public:
+	/**
+	 * Initialising the io_uring instance and its buffers
+	 * @param fd The connected socket
+	 * @param stream true for a TCP socket, false for a connected UDP socket
+	 * @return false if io_uring is not available, in which case the caller keeps sending with boost::asio
+	 */
+	bool Init(int fd, bool stream);
+	/**
+	 * Initialising logging in UringSender class
+	 * @param l Pointer to LoggerPtr class
+	 */
+	void InitLog(log4cxx::LoggerPtr l);
+	/**
+	 * Queueing an EventID. The data is copied, so the caller can reuse its buffer immediately.
+	 * @param data The (stamped) EventID
+	 * @param length The length of the EventID
+	 */
+	void Send(const char *data, size_t length);
+	/**
+	 * Submitting all queued EventIDs to the kernel and reaping the completions which are available
+	 */
+	void Flush();
+	/**
+	 * Obtain the number of io_uring_enter() calls for the EventIDs sent so far
+	 * @return The number of submissions
+	 */
+	unsigned long long GetSubmissions();
+private:
+	/**
+	 * Preparing the send of the unsent part of a TCP staging buffer
+	 * @param buffer Index of the staging buffer
+	 */
+	void PrepareStage(unsigned int buffer);
+	/**
+	 * Handling completions
+	 * @param wait Block until at least one completion has arrived
+	 */
+	void Reap(bool wait);
+	/**
+	 * Obtain a free submission queue entry, submitting and reaping if the queue is full
+	 * @return The submission queue entry
+	 */
+	struct io_uring_sqe * GetSqe();
+	struct io_uring ring;						/** The io_uring instance */
+	int fd_;									/** The connected socket */
+	bool stream_;								/** TCP (true) or UDP (false) */
+	bool zeroCopy;								/** Kernel supports IORING_OP_SEND_ZC */
+	char *buffers;								/** UDP slots or the two TCP staging buffers */
+	vector <unsigned int> freeSlots;			/** UDP slots not in flight */
+	unsigned int prepared;						/** Sends prepared but not submitted yet */
+	unsigned int stage;							/** TCP staging buffer currently filled */
+	size_t stageLength[2];						/** Bytes in the TCP staging buffers */
+	size_t stageSent[2];						/** Bytes of the TCP staging buffers sent so far */
+	unsigned int stagePending[2];				/** Completions (incl. zero-copy notifications) outstanding per staging buffer */
+	unsigned long long submissions;				/** Number of io_uring_enter() calls */
+	unsigned long long errors;					/** Failed sends */
+	log4cxx::LoggerPtr logger;					/** Pointer to LoggerPtr class */
+};
+#endif
@@ -23,13 +23,68 @@
  */
 
 #include "visualiser.hh"
+#include <algorithm>
 #include <sstream>
 #include <math.h>
+bool VisualiserEventEarlier(const VISUALISER_EVENT_STRUCT &a, const VISUALISER_EVENT_STRUCT &b)
+{
+	return a.time < b.time;
+}
+void EventRing::Init(unsigned int capacity)
+{
+	unsigned long n = 1;
+
+	while (n < capacity)
+		n <<= 1;
+
+	slots.assign(n, TIME_EVENT_PAIR());
+	mask = n - 1;
+	head.store(0);
+	tail.store(0);
+	dropped.store(0);
+}
+bool EventRing::Push(const TIME_EVENT_PAIR &event)
+{
+	unsigned long h = head.load(boost::memory_order_relaxed);
+
+	if (h - tail.load(boost::memory_order_acquire) > mask)
+	{
+		dropped.fetch_add(1, boost::memory_order_relaxed);
+		return false;
+	}
+
+	slots[h & mask] = event;
+	head.store(h + 1, boost::memory_order_release);
+	return true;
+}
+bool EventRing::Pop(TIME_EVENT_PAIR *event)
+{
+	unsigned long t = tail.load(boost::memory_order_relaxed);
+
+	if (t == head.load(boost::memory_order_acquire))
+		return false;
+
+	*event = slots[t & mask];
+	tail.store(t + 1, boost::memory_order_release);
+	return true;
+}
+bool EventRing::IsFull()
+{
+	return head.load(boost::memory_order_relaxed) - tail.load(boost::memory_order_acquire) > mask;
+}
+unsigned long EventRing::GetDropped()
+{
+	return dropped.load(boost::memory_order_relaxed);
+}
 void Visualiser::Initialise(log4cxx::LoggerPtr l, int x)
 {
 	logger = l;
 	xrangeMin = x;
 	yrangeMax = 0;
+	levelOfDetail = false;
+	heatmap = false;
+	binsChanged = false;
+	newestBin = -1;
 	gnuplot << "set object 1 rectangle from screen 0,0 to screen 1,1 fillcolor rgb '#f5f5f5' behind\n";
 	gnuplot << "unset ytics\n";
 	gnuplot << "set ylabel 'ID'\n";
@@ -37,73 +92,84 @@ void Visualiser::Initialise(log4cxx::LoggerPtr l, int x)
 	gnuplot << "set key horizontal\n";
 	gnuplot << "unset border\n";
 }
-void Visualiser::UpdateEventIdMap(EVENT_MAP *map, TIME t)
+void Visualiser::UpdateEventIdWindow(EventRing *ring, TIME t)
 {
-	EVENT_MAP_IT it;
-	int idsErased = 0;
-	// Deleting EventIDs which are older than 5s compared to current time 't'
-	for (it = map->begin(); it != map->end(); it++)
+	TIME_EVENT_PAIR event;
+	VISUALISER_EVENT_STRUCT visualiserEvent;
+	std::map<EVENT_ID, int>::iterator hashMapIt;
+	int idsAdded = 0, idsErased = 0;
+	double windowStart = t.sec() - xrangeMin;
+	size_t oldSize = eventIds.size();
+	// Hashing the new EventIDs down to int - only once per EventID
+	while (ring->Pop(&event))
 	{
-		if (it->first.sec() < (t.sec() - xrangeMin))
+		hashMapIt = hashMap.find(event.second.eventId);
+
+		if (hashMapIt == hashMap.end())
 		{
-			map->erase(it);
-			idsErased++;
+			LOG4CXX_DEBUG (logger, "New hashed number for Event ID "
+					<< event.second.eventId << " = " << hashMap.size()+1 );
+			hashMapIt = hashMap.insert(std::pair<EVENT_ID, int>(event.second.eventId, hashMap.size()+1)).first;
 		}
+		// Getting max yrange
+		if (hashMapIt->second > yrangeMax)
+		{
+			LOG4CXX_DEBUG (logger, "yrangeMax for visualiser has increased from "
+					<< yrangeMax << " to " << hashMapIt->second);
+			yrangeMax = hashMapIt->second;
+		}
+
+		visualiserEvent.time = event.first.sec();
+		visualiserEvent.hashedId = hashMapIt->second;
+		visualiserEvent.noise = event.second.noiseSource >= 0;
+
+		if (levelOfDetail)
+			AddToBins(visualiserEvent);
 		else
-			it == map->end();
+			eventIds.push_back(visualiserEvent);
+		idsAdded++;
+	}
+	// The window holds the EventIDs of all destinations, so the new ones have to be merged in by time for the expiry
+	// below to only look at the front
+	if (eventIds.size() > oldSize)
+	{
+		VISUALISER_EVENT_DEQUE::iterator newIds = eventIds.begin() + oldSize;
+
+		std::stable_sort(newIds, eventIds.end(), VisualiserEventEarlier);
+		std::inplace_merge(std::upper_bound(eventIds.begin(), newIds, *newIds, VisualiserEventEarlier), newIds,
+				eventIds.end(), VisualiserEventEarlier);
 	}
-	eventIds = (*map);
-	LOG4CXX_DEBUG(logger, "Erased " << idsErased << " IDs from visualiser map with new size of " << eventIds.size() << "IDs");
+	// Deleting EventIDs which are older than the window size compared to current time 't'
+	while (!eventIds.empty() && eventIds.front().time < windowStart)
+	{
+		eventIds.pop_front();
+		idsErased++;
+	}
+	LOG4CXX_DEBUG(logger, "Added " << idsAdded << " and erased " << idsErased << " IDs from visualiser window with new size of "
+			<< eventIds.size() << " IDs (" << ring->GetDropped() << " IDs dropped by the sender)");
 }
 void Visualiser::UpdatePlot(TIME t)
 {
-	EVENT_MAP_IT it;
+	if (levelOfDetail)
+	{
+		UpdateBinnedPlot(t);
+		return;
+	}
+
+	VISUALISER_EVENT_DEQUE::iterator it;
 	typedef pair <double,int> TIME_INT_PAIR;
 	vector <TIME_INT_PAIR> eventIdVector, noiseVector;
 	vector <TIME_INT_PAIR>::iterator eventIdVectorIterator, noiseVectorIt;
 
-	std::map<EVENT_ID, int>::iterator hashMapIt;
-	// Hashing the EventIDs down to int
 	for (it = eventIds.begin(); it != eventIds.end(); it++)
 	{
-		// Only get EventIDs from map which are not queued for sending
-		if (!(it->first.sec() > t.sec()))
+		// Only get EventIDs from the window which are not in the future
+		if (!(it->time > t.sec()))
 		{
-			// Hash them to int
-			if (hashMap.find(it->second) != hashMap.end())
-			{
-				hashMapIt = hashMap.find(it->second);
-			}
+			if (it->noise)
+				noiseVector.push_back(TIME_INT_PAIR (it->time, it->hashedId));
 			else
-			{
-				LOG4CXX_DEBUG (logger, "New hashed number for Event ID "
-						<< it->second << " = " << hashMap.size()+1 );
-				hashMap.insert(std::pair<EVENT_ID, int>(it->second, hashMap.size()+1));
-				hashMapIt = hashMap.find(it->second);
-			}
-			// Getting max yrange
-			if (hashMapIt->second > yrangeMax)
-			{
-				LOG4CXX_DEBUG (logger, "yrangeMax for visualiser has increased from "
-						<< yrangeMax << " to " << hashMapIt->second);
-				yrangeMax = hashMapIt->second;
-			}
-			// Check if EventID is noise or "real" event
-			int eId;
-			istringstream convert(it->second);
-
-			if (!(convert >> eId))
-			{
-			//	cout << setprecision(20) << it->second << " is an EventID\n";
-				eId = 0;
-			}
-			//else
-			//	cout << eId << " is a NoiseID\n";
-
-			if (eId != 0)
-				noiseVector.push_back(TIME_INT_PAIR (it->first.sec(),hashMapIt->second));
-			else
-				eventIdVector.push_back(TIME_INT_PAIR (it->first.sec(),hashMapIt->second));
+				eventIdVector.push_back(TIME_INT_PAIR (it->time, it->hashedId));
 		}
 	}
 
@@ -179,3 +245,140 @@ void Visualiser::UpdatePlot(TIME t)
 
 	gnuplot.flush();
 }
+void Visualiser::EnableLevelOfDetail(int numOfTimeBins, int numOfIdBins, bool h)
+{
+	levelOfDetail = true;
+	heatmap = h;
+	timeBins = numOfTimeBins > 0 ? numOfTimeBins : 1;
+	idBins = numOfIdBins > 0 ? numOfIdBins : 1;
+	binWidth = (double)xrangeMin / timeBins;
+	patternBins.assign(timeBins, vector <unsigned int>());
+	noiseBins.assign(timeBins, vector <unsigned int>());
+	LOG4CXX_INFO(logger, "Level-of-detail visualiser with " << timeBins << " time bins of " << binWidth
+			<< "s and up to " << idBins << " ID bins");
+}
+void Visualiser::AdvanceBins(long long bin)
+{
+	if (bin <= newestBin)
+		return;
+	// Clearing the bins which are reused for the new time bins
+	if (newestBin < 0 || bin - newestBin >= timeBins)
+	{
+		for (int i = 0; i < timeBins; i++)
+		{
+			patternBins[i].assign(patternBins[i].size(), 0);
+			noiseBins[i].assign(noiseBins[i].size(), 0);
+		}
+	}
+	else
+	{
+		for (long long b = newestBin + 1; b <= bin; b++)
+		{
+			patternBins[b % timeBins].assign(patternBins[b % timeBins].size(), 0);
+			noiseBins[b % timeBins].assign(noiseBins[b % timeBins].size(), 0);
+		}
+	}
+
+	newestBin = bin;
+	binsChanged = true;
+}
+void Visualiser::AddToBins(const VISUALISER_EVENT_STRUCT &event)
+{
+	long long bin = (long long)floor(event.time / binWidth);
+
+	// EventID has already left the window
+	if (newestBin >= 0 && bin <= newestBin - timeBins)
+		return;
+
+	AdvanceBins(bin);
+	vector <unsigned int> &counts = event.noise ? noiseBins[bin % timeBins] : patternBins[bin % timeBins];
+
+	if (counts.size() <= (size_t)event.hashedId)
+		counts.resize(event.hashedId + 1, 0);
+
+	counts[event.hashedId]++;
+	binsChanged = true;
+}
+void Visualiser::UpdateBinnedPlot(TIME t)
+{
+	typedef boost::tuple <double,double,double> BIN_TUPLE;
+	vector <BIN_TUPLE> patternVector, noiseVector;
+	vector <unsigned int> patternRows, noiseRows;
+	unsigned int patternTotal = 0, noiseTotal = 0;
+
+	AdvanceBins((long long)floor(t.sec() / binWidth));
+
+	if (!binsChanged || yrangeMax == 0)
+		return;
+
+	binsChanged = false;
+	// Grouping the hashed IDs into at most idBins rows
+	int rows = yrangeMax < idBins ? yrangeMax : idBins;
+	double rowHeight = (double)yrangeMax / rows;
+
+	for (long long b = newestBin - timeBins + 1; b <= newestBin; b++)
+	{
+		if (b < 0)
+			continue;
+
+		double x = (b + 0.5) * binWidth - t.sec();
+		vector <unsigned int> &pattern = patternBins[b % timeBins];
+		vector <unsigned int> &noise = noiseBins[b % timeBins];
+		patternRows.assign(rows, 0);
+		noiseRows.assign(rows, 0);
+
+		for (size_t id = 1; id < pattern.size(); id++)
+			patternRows[(id - 1) * rows / yrangeMax] += pattern[id];
+		for (size_t id = 1; id < noise.size(); id++)
+			noiseRows[(id - 1) * rows / yrangeMax] += noise[id];
+
+		for (int r = 0; r < rows; r++)
+		{
+			double y = (r + 0.5) * rowHeight;
+			patternTotal += patternRows[r];
+			noiseTotal += noiseRows[r];
+			// The heatmap needs the complete grid, the points only the bins which are not empty
+			if (heatmap)
+				patternVector.push_back(BIN_TUPLE (x, y, patternRows[r] + noiseRows[r]));
+			else
+			{
+				if (patternRows[r] > 0)
+					patternVector.push_back(BIN_TUPLE (x, y, 0.5 + log10((double)patternRows[r])));
+				if (noiseRows[r] > 0)
+					noiseVector.push_back(BIN_TUPLE (x, y, 0.5 + log10((double)noiseRows[r])));
+			}
+		}
+	}
+
+	gnuplot << "set yrange [0:" << yrangeMax << "]\n";
+	gnuplot << "set ytics ('0' 0, '" << yrangeMax << "' " << yrangeMax << ")\n";
+	gnuplot << "set xtics ('-" << xrangeMin << "s' -" << xrangeMin << ",'Now' 0) nomirror\n";
+	gnuplot << "set xrange [-" << xrangeMin << ":0]\n";
+	gnuplot << "set title 'Pattern IDs: " << patternTotal << " | Noise IDs: " << noiseTotal << " | "
+			<< timeBins << "x" << rows << " bins' tc rgb '#c74f10'\n";
+
+	if (heatmap)
+	{
+		gnuplot << "plot '-' binary" << gnuplot.binFmt1d(patternVector, "record") << "with image title 'EventIDs per bin'\n";
+		gnuplot.sendBinary1d(patternVector);
+	}
+	else if (patternVector.size() != 0 && noiseVector.size() != 0)
+	{
+		gnuplot << "plot '-' binary" << gnuplot.binFmt1d(patternVector, "record") << "with points pt 7 ps variable linecolor rgb '#c74f10' title 'Pattern ID',"
+				<< "'-' binary" << gnuplot.binFmt1d(noiseVector, "record") << "with points pt 15 ps variable linecolor rgb '#002b5c' title 'Noise ID'\n";
+		gnuplot.sendBinary1d(patternVector);
+		gnuplot.sendBinary1d(noiseVector);
+	}
+	else if (patternVector.size() != 0)
+	{
+		gnuplot << "plot '-' binary" << gnuplot.binFmt1d(patternVector, "record") << "with points pt 7 ps variable linecolor rgb '#c74f10' title 'Pattern ID'\n";
+		gnuplot.sendBinary1d(patternVector);
+	}
+	else if (noiseVector.size() != 0)
+	{
+		gnuplot << "plot '-' binary" << gnuplot.binFmt1d(noiseVector, "record") << "with points pt 15 ps variable linecolor rgb '#002b5c' title 'Noise ID'\n";
+		gnuplot.sendBinary1d(noiseVector);
+	}
+
+	gnuplot.flush();
+}
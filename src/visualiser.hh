@@ -21,9 +21,54 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <boost/atomic.hpp>
 #include "gnuplot-iostream.hh"
 #include "dictionary.hh"
 
+/**
+ * \class EventRing
+ * Lock-free single-producer/single-consumer ring buffer handing the sent EventIDs to the visualiser.
+ *
+ * The sender appends every EventID it has sent, so the ring is sorted by time. Neither side ever blocks: if the
+ * visualiser does not keep up, the sender drops the EventID for the visualiser and counts it.
+ */
+class EventRing {
+public:
+	/**
+	 * Allocating the ring buffer
+	 * @param capacity The number of slots (rounded up to a power of two)
+	 */
+	void Init(unsigned int capacity);
+	/**
+	 * Appending an EventID (producer side)
+	 * @param event The EventID and the time it was scheduled for
+	 * @return false if the ring was full and the EventID has been dropped
+	 */
+	bool Push(const TIME_EVENT_PAIR &event);
+	/**
+	 * Taking out the oldest EventID (consumer side)
+	 * @param event Pointer into which the EventID is written
+	 * @return false if the ring is empty
+	 */
+	bool Pop(TIME_EVENT_PAIR *event);
+	/**
+	 * Checking whether the next Push() would drop the EventID (producer side)
+	 * @return true if all slots are in use
+	 */
+	bool IsFull();
+	/**
+	 * Obtain the number of EventIDs dropped because the ring was full
+	 * @return The number of dropped EventIDs
+	 */
+	unsigned long GetDropped();
+private:
+	TIME_EVENT_VECTOR slots;			/** The slots of the ring */
+	unsigned long mask;					/** Number of slots - 1 */
+	boost::atomic<unsigned long> head;	/** Next slot written by the producer */
+	boost::atomic<unsigned long> tail;	/** Next slot read by the consumer */
+	boost::atomic<unsigned long> dropped;	/** EventIDs dropped by the producer */
+};
+
 /**
  * Class to visualise EventID stream using C++ Gnuplot interface (https://code.google.com/p/gnuplot-cpp/)
  */
@@ -37,11 +82,13 @@ public:
 	 */
 	void Initialise(log4cxx::LoggerPtr l, int x);
 	/**
-	 * Add the current map of EventIDs and their future starting times to the Gnuplot map
+	 * Merge the EventIDs sent since the last call from the ring into the sliding window, which stays ordered by time
+	 * across the rings of all destinations, and remove the EventIDs which have left the window
 	 *
-	 * @param map The map of EventIDs which will be sent in the future
+	 * @param ring The ring buffer the sender appends the sent EventIDs to
+	 * @param t Current time
 	 */
-	void UpdateEventIdMap(EVENT_MAP *map, TIME t);
+	void UpdateEventIdWindow(EventRing *ring, TIME t);
 
 	/**
 	 * Update the Gnuplot plot
@@ -49,12 +96,48 @@ public:
 	 * @param currentTime Current time as a reference point to the past EventIDs and the upcoming ones
 	 */
 	void UpdatePlot(TIME t);
+	/**
+	 * Switch to level-of-detail rendering: the window is aggregated into time x ID bins and only the bins are sent to
+	 * Gnuplot, so the cost of a frame depends on the number of bins instead of the EventID rate
+	 *
+	 * @param numOfTimeBins Number of bins the window is divided into along the time axis
+	 * @param numOfIdBins Maximal number of bins along the ID axis (IDs are grouped if there are more)
+	 * @param heatmap Plot the density as heatmap instead of one point per non-empty bin scaled by its count
+	 */
+	void EnableLevelOfDetail(int numOfTimeBins, int numOfIdBins, bool heatmap);
 
 private:
+	/**
+	 * Add a single EventID to the time x ID bins
+	 *
+	 * @param event The EventID
+	 */
+	void AddToBins(const VISUALISER_EVENT_STRUCT &event);
+	/**
+	 * Move the newest time bin forward and clear the bins which have left the window
+	 *
+	 * @param bin The absolute number of the new newest time bin (time / binWidth)
+	 */
+	void AdvanceBins(long long bin);
+	/**
+	 * Update the Gnuplot plot from the time x ID bins. Frames in which no bin has changed are skipped.
+	 *
+	 * @param t Current time
+	 */
+	void UpdateBinnedPlot(TIME t);
 	Gnuplot gnuplot;
-	EVENT_MAP eventIds;
+	VISUALISER_EVENT_DEQUE eventIds;	/** Sliding window of the EventIDs sent within the last xrangeMin seconds */
 	log4cxx::LoggerPtr logger;	/** Pointer to LoggerPtr class */
 	int yrangeMax;				/** Storing the maximal number of IDs getting displayed - used for 'set yrange[0:yrangeMax]' */
 	int xrangeMin;				/** The window size for xrange settings in Gnuplot */
 	map<EVENT_ID, int> hashMap; /** integer mapping of long long EventIDs*/
+	bool levelOfDetail;			/** Aggregate the window into bins instead of plotting every EventID */
+	bool heatmap;				/** Plot the bins as heatmap */
+	bool binsChanged;			/** At least one bin has changed since the last frame */
+	int timeBins;				/** Number of time bins covering the window */
+	int idBins;					/** Maximal number of ID bins */
+	double binWidth;			/** Time [s] covered by a single time bin */
+	long long newestBin;		/** Absolute number of the newest time bin (-1 = no EventID yet) */
+	vector < vector <unsigned int> > patternBins;	/** Pattern EventID counts per time bin (ring) and hashed ID */
+	vector < vector <unsigned int> > noiseBins;		/** Noise EventID counts per time bin (ring) and hashed ID */
 };
@@ -0,0 +1,118 @@
+/**
+ * @author Sebastian Robitzsch <srobitzsch@gmail.com>
+ *
+ * @section LICENSE
+ *
+ * OpenMSC - MSCgen-Based Control-Plane Traffic Emulator
+ *
+ * Copyright (C) 2014 Sebastian Robitzsch
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+/**
+ * Wire format of a stamped EventID
+ *
+ * In stamped mode (openmsc -x) every EventID is prefixed with a fixed size header, all fields in network byte order:
+ *
+ *  0      2      3      4      6      8                16               24               32
+ * +------+------+------+------+------+----------------+----------------+----------------+-----------------+
+ * | magic| ver. | flags|length| rsv. |    sequence    | scheduledTime  |    sendTime    | EventID (length)|
+ * +------+------+------+------+------+----------------+----------------+----------------+-----------------+
+ *
+ * The sequence number counts the EventIDs of a single sender (destination), starting at 0. scheduledTime is the time
+ * the EventID was scheduled for by the generators, sendTime the time the sender handed it to the socket, both
+ * CLOCK_REALTIME in ns. A receiver gets the one-way latency from sendTime and the lateness of the sender from
+ * sendTime - scheduledTime. Without -x the EventIDs are sent as plain strings.
+ */
+#define WIRE_MAGIC 0x4d53		/** 'MS' */
+#define WIRE_VERSION 2
+#define WIRE_HEADER_SIZE 32
+#define WIRE_MAX_EVENT_ID_LENGTH 1024
+
+/**
+ * \typedef WIRE_HEADER_STRUCT
+ * \brief Decoded header of a stamped EventID
+ */
+typedef struct wireHeader {
+	uint16_t magic;			/** WIRE_MAGIC */
+	uint8_t version;		/** WIRE_VERSION */
+	uint8_t flags;			/** Reserved for future use */
+	uint16_t length;		/** Length of the EventID following the header */
+	uint64_t sequence;		/** Sequence number of the EventID */
+	uint64_t scheduledTime;	/** Time [ns] the EventID was scheduled for */
+	uint64_t sendTime;		/** Time [ns] at which the EventID was sent */
+} WIRE_HEADER_STRUCT;
+
+/**
+ * Encoding the wire header in front of an EventID
+ *
+ * @param buffer Buffer of at least WIRE_HEADER_SIZE bytes
+ * @param length Length of the EventID
+ * @param sequence Sequence number of the EventID
+ * @param scheduledTime Time [ns] the EventID was scheduled for
+ * @param sendTime Time [ns] at which the EventID is sent
+ */
+static inline void EncodeWireHeader(char *buffer, uint16_t length, uint64_t sequence, uint64_t scheduledTime,
+		uint64_t sendTime)
+{
+	uint16_t u16;
+	uint64_t u64;
+
+	u16 = htobe16(WIRE_MAGIC);
+	memcpy(buffer, &u16, 2);
+	buffer[2] = WIRE_VERSION;
+	buffer[3] = 0;
+	u16 = htobe16(length);
+	memcpy(buffer + 4, &u16, 2);
+	memset(buffer + 6, 0, 2);
+	u64 = htobe64(sequence);
+	memcpy(buffer + 8, &u64, 8);
+	u64 = htobe64(scheduledTime);
+	memcpy(buffer + 16, &u64, 8);
+	u64 = htobe64(sendTime);
+	memcpy(buffer + 24, &u64, 8);
+}
+
+/**
+ * Decoding the wire header of a stamped EventID
+ *
+ * @param buffer Buffer holding at least WIRE_HEADER_SIZE bytes
+ * @param header Pointer into which the header is decoded
+ * @return false if the buffer does not start with a valid header
+ */
+static inline bool DecodeWireHeader(const char *buffer, WIRE_HEADER_STRUCT *header)
+{
+	uint16_t u16;
+	uint64_t u64;
+
+	memcpy(&u16, buffer, 2);
+	header->magic = be16toh(u16);
+	header->version = buffer[2];
+	header->flags = buffer[3];
+	memcpy(&u16, buffer + 4, 2);
+	header->length = be16toh(u16);
+	memcpy(&u64, buffer + 8, 8);
+	header->sequence = be64toh(u64);
+	memcpy(&u64, buffer + 16, 8);
+	header->scheduledTime = be64toh(u64);
+	memcpy(&u64, buffer + 24, 8);
+	header->sendTime = be64toh(u64);
+
+	return header->magic == WIRE_MAGIC && header->version == WIRE_VERSION && header->length <= WIRE_MAX_EVENT_ID_LENGTH;
+}